@@ -61,4 +61,8 @@ enum lib_type {
 #define GET_LIB_TYPE(a)         (a & CODEC_LIB_MASK)
 #define GET_CODEC_TYPE(a)       ((a >> 2) & 0x1F)
 
+/* code section is already relocated, by another instance or from image cache */
+#define CODEC_LIB_SHARED_CODE   (1 << 7)
+#define IS_LIB_CODE_SHARED(a)   ((a >> 7) & 0x1)
+
 #endif
@@ -85,6 +85,9 @@ typedef enum
     UNIA_LOAD_LIB,
     UNIA_UNLOAD_LIB,
     UNIA_RESET_BUF,
+    /* dedicate for DSP wrapper */
+    UNIA_ZERO_COPY_OUTPUT,  /* return DSP output buffer, release with ACODEC_API_RELEASE_OUTPUT */
+    UNIA_FRAME_INDEX_FILE,  /* index frames of this file in background, set after UNIA_STREAM_TYPE */
 
 /* dedicate for wma */
     UNIA_WMA_BlOCKALIGN= 0x100,
@@ -124,6 +127,8 @@ typedef enum
     UNIA_OUTPUT_PCM_FORMAT,
     UNIA_CONSUMED_LENGTH,
     UNIA_OUTBUF_ALLOC_SIZE,  /* used for allocate output buffer outside */
+    UNIA_SEEK_POSITION,      /* frame boundary for seek.time_us, needs UNIA_FRAME_INDEX_FILE */
+    UNIA_IPC_MSG_COUNT,      /* messages sent to DSP so far, for profiling */
     
     UA_TYPE_MAX
 } UA_ParaType;
@@ -259,6 +264,13 @@ typedef struct
     UWORD32* channel_table[10]; //assume the max channel is less than 10
 }CHAN_TABLE;
 
+typedef struct
+{
+    unsigned long long time_us;         /* in: seek target */
+    unsigned long long offset;          /* out: file offset of the frame to feed from */
+    unsigned long long frame_time_us;   /* out: start time of that frame */
+}UniACodecSeekPos;
+
 typedef struct
 {
 #if !defined(RVDS)
@@ -284,6 +296,10 @@ typedef struct
         UniAcodecOutputPCMFormat outputFormat;
         UWORD32 consumed_length;
         UWORD32 outbuf_alloc_size;
+        bool zero_copy;
+        char *index_file;
+        UniACodecSeekPos seek;
+        unsigned long long ipc_msg_count;
 
 /* defined for dsp */
         UWORD32 chanmap;
@@ -407,6 +423,10 @@ typedef WORD32 (*UniACodec_encode_frame) (UniACodec_Handle pua_handle,
 
 typedef char * (*UniACodec_get_last_error) (UniACodec_Handle pua_handle);
 
+/* hand an output buffer returned in UNIA_ZERO_COPY_OUTPUT mode back to the codec */
+typedef WORD32 (*UniACodec_release_output) (UniACodec_Handle pua_handle,
+                                             UWORD8 *OutputBuf);
+
 /*******************************************************************
  *
 API function ID
@@ -429,6 +449,7 @@ enum /* API function ID */
     /* process frame */
     ACODEC_API_DEC_FRAME    = 0x20,
     ACODEC_API_ENC_FRAME    = 0x21,
+    ACODEC_API_RELEASE_OUTPUT = 0x22,
 
     ACODEC_API_GET_LAST_ERROR = 0x1000,
 
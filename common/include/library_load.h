@@ -35,6 +35,8 @@
 #define xt_ulong    unsigned long
 
 struct xtlib_packaged_library;
+struct lib_code_cache;
+struct lib_image;
 
 enum {
 	XTLIB_NO_ERR = 0,
@@ -108,6 +110,12 @@ struct lib_info {
 
 	const char   *filename;
 	unsigned int lib_type;
+
+	/* shared code section, NULL if code is private to this instance */
+	struct lib_code_cache *code_cache;
+
+	/* image to store in the on-disk cache once the DSP has relocated it */
+	struct lib_image *image;
 };
 
 long xf_load_lib(xaf_comp_t *handle, struct lib_info *lib_info);
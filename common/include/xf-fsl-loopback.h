@@ -0,0 +1,18 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Emulated DSP behind the proxy IPC, built with XF_IPC_LOOPBACK. It
+ * answers the proxy protocol in a thread of the calling process, so the
+ * wrapper and the tests built on it run on a host without DSP.
+ */
+
+#ifndef __XF_FSL_LOOPBACK_H
+#define __XF_FSL_LOOPBACK_H
+
+struct xf_proxy_ipc_data;
+
+int xf_loopback_open(struct xf_proxy_ipc_data *ipc);
+void xf_loopback_close(struct xf_proxy_ipc_data *ipc);
+
+#endif
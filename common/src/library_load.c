@@ -28,8 +28,101 @@
 #include <elf.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "library_load.h"
 #include "fsl_unia.h"
+#include "dsp_codec_interface.h"
+
+/* ...xtensa relocation types, not provided by host elf.h */
+#define XTLIB_R_XTENSA_NONE         0
+#define XTLIB_R_XTENSA_RELATIVE     5
+#define XTLIB_R_XTENSA_SLOT0_OP     20
+#define XTLIB_R_XTENSA_SLOT14_ALT   49
+
+/* memory all library sections are placed in */
+#define LIB_SECTION_MEM_ID      XAF_MEM_ID_COMP
+
+/*
+ * Code section of a library shared by all instances on the same proxy. It is
+ * keyed by the library path and the placement of the code: memory, buffer
+ * size and alignment. Data and scratch sections are always per instance; a
+ * library whose code refers to them is never shared.
+ */
+struct lib_code_cache {
+	struct lib_code_cache *next;
+	struct xf_proxy *proxy;
+	char *filename;
+	int mem_id;
+	unsigned int align;
+
+	struct xf_pool *code_section_pool;
+	void *code_buf_virt;
+	unsigned int code_buf_phys;
+	unsigned int code_buf_size;
+
+	/* ...set once the DSP has relocated the sections */
+	bool ready;
+	unsigned int refcount;
+};
+
+/*
+ * Process-wide list of loaded libraries. The lock only covers the list and
+ * the refcounts; an instance finding an entry that is not ready yet waits
+ * on the condition until its loader is done with the DSP.
+ */
+static struct lib_code_cache *lib_code_cache_head;
+static pthread_mutex_t lib_code_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lib_code_cache_cond = PTHREAD_COND_INITIALIZER;
+
+/*
+ * Pre-relocated image cache, enabled by pointing this at a writable
+ * directory. Images are not relocated again on reuse: one is only used when
+ * the new instance gets its sections at exactly the DSP addresses the image
+ * was relocated for, otherwise the library is loaded from the ELF file.
+ */
+#define LIB_IMAGE_CACHE_ENV     "XAF_LIB_CACHE_DIR"
+#define LIB_IMAGE_MAGIC         0x474d494c	/* "LIMG" */
+#define LIB_IMAGE_VERSION       5
+
+/* on-disk image header, followed by the code, data and scratch images */
+struct lib_image_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+
+	/* ...aligned DSP addresses the image was relocated for */
+	uint32_t code_addr;
+	uint32_t data_addr;
+	uint32_t s_data_addr;
+
+	/* ...section buffer sizes and alignment */
+	uint32_t code_buf_size;
+	uint32_t data_buf_size;
+	uint32_t s_data_buf_size;
+	uint32_t align;
+
+	/* ...image lengths following the header */
+	uint32_t code_len;
+	uint32_t data_len;
+	uint32_t s_data_len;
+
+	int32_t byteswap;
+	uint32_t shareable;
+	struct xtlib_pil_info pil_info;
+};
+
+/* image waiting for the DSP to relocate its code section */
+struct lib_image {
+	char *path;
+	struct lib_image_header header;
+	void *data;
+	void *s_data;
+};
 
 static Elf32_Half xtlib_host_half(Elf32_Half v, int byteswap)
 {
@@ -434,6 +527,87 @@ static int get_dyn_info(Elf32_Ehdr *eheader,
 	return XTLIB_NO_ERR;
 }
 
+/*
+ * Code section can be shared between instances when every relocation
+ * applied to it is understood and resolves into the code section itself.
+ * Literals pointing into the data or scratch section bind the code to the
+ * sections of the instance that relocated it, such a library is loaded
+ * privately by every instance.
+ */
+static bool xtlib_code_shareable(Elf32_Ehdr *eheader,
+				 struct lib_info *lib_info)
+{
+	struct xtlib_loader_globals *xtlib_globals =
+					&lib_info->xtlib_globals;
+	int byteswap = xtlib_globals->byteswap;
+	Elf32_Phdr *pheader = (Elf32_Phdr *)((char *)eheader +
+			xtlib_host_word(eheader->e_phoff, byteswap));
+	Elf32_Phdr *dyn_segment = find_dynamic_segment(eheader, lib_info);
+	Elf32_Dyn *dyn_entry = find_dynamic_info(eheader, lib_info);
+	Elf32_Word code_offs = xtlib_host_word(pheader[0].p_paddr, byteswap);
+	Elf32_Word code_size = xtlib_host_word(pheader[0].p_memsz, byteswap);
+	Elf32_Word code_file_offs = xtlib_host_word(pheader[0].p_offset, byteswap);
+	Elf32_Word code_file_size = xtlib_host_word(pheader[0].p_filesz, byteswap);
+	Elf32_Rela *rela = NULL;
+	int rela_count = 0;
+	int i;
+
+	if (dyn_entry == 0)
+		return false;
+
+	while (dyn_entry->d_tag != DT_NULL) {
+		switch ((Elf32_Sword) xtlib_host_word(
+			(Elf32_Word)dyn_entry->d_tag, byteswap)) {
+		case DT_RELA:
+			rela = (Elf32_Rela *)((char *)eheader +
+				xtlib_host_word(dyn_segment->p_offset, byteswap) +
+				xtlib_host_word(dyn_entry->d_un.d_ptr, byteswap) -
+				xtlib_host_word(dyn_segment->p_vaddr, byteswap));
+			break;
+		case DT_RELASZ:
+			rela_count = xtlib_host_word(dyn_entry->d_un.d_val,
+						     byteswap) / sizeof(Elf32_Rela);
+			break;
+		default:
+			break;
+		}
+		dyn_entry++;
+	}
+
+	for (i = 0; rela && i < rela_count; i++) {
+		Elf32_Word r_offset = xtlib_host_word(rela[i].r_offset, byteswap);
+		Elf32_Word r_type = ELF32_R_TYPE(xtlib_host_word(rela[i].r_info,
+								 byteswap));
+		Elf32_Word r_addend = xtlib_host_word(rela[i].r_addend, byteswap);
+		Elf32_Word target;
+
+		/* ...data and scratch relocations are applied per instance */
+		if (r_offset < code_offs || r_offset - code_offs >= code_size ||
+		    r_type == XTLIB_R_XTENSA_NONE)
+			continue;
+
+		if (r_type == XTLIB_R_XTENSA_RELATIVE) {
+			Elf32_Word value;
+
+			if (r_offset - code_offs + sizeof(value) > code_file_size)
+				return false;
+			memcpy(&value, (char *)eheader + code_file_offs +
+			       r_offset - code_offs, sizeof(value));
+			target = xtlib_host_word(value, byteswap) + r_addend;
+		} else if (r_type >= XTLIB_R_XTENSA_SLOT0_OP &&
+			   r_type <= XTLIB_R_XTENSA_SLOT14_ALT) {
+			target = r_addend;
+		} else {
+			return false;
+		}
+
+		if (target < code_offs || target - code_offs >= code_size)
+			return false;
+	}
+
+	return true;
+}
+
 static xt_ptr xtlib_load_split_pi_library_common(
 				struct xtlib_packaged_library *library,
 				xt_ptr destination_code_address,
@@ -495,24 +669,24 @@ static xt_ptr xtlib_load_split_pi_library_common(
 		return 0;
 	}
 
-	/* loading code */
-	xtlib_load_seg(&pheader[0],
-		       (char *)library + xtlib_host_word(pheader[0].p_offset,
-			xtlib_globals->byteswap),
-			(xt_ptr)lib_info->code_buf_virt,
-			lib_info);
+	/* loading code, unless another instance already did */
+	if (!(lib_info->lib_type & CODEC_LIB_SHARED_CODE))
+		xtlib_load_seg(&pheader[0],
+			       (char *)library + xtlib_host_word(pheader[0].p_offset,
+				xtlib_globals->byteswap),
+				(xt_ptr)lib_info->code_buf_virt,
+				lib_info);
 
 	if (info->text_addr == 0)
 		info->text_addr =
 		(xt_ptr)xtlib_xt_word((Elf32_Word)destination_code_address,
 						xtlib_globals->byteswap);
 
-	/* loading data */
 	xtlib_load_seg(&pheader[1],
 		       (char *)library + xtlib_host_word(pheader[1].p_offset,
-						xtlib_globals->byteswap),
-		  (xt_ptr)lib_info->data_buf_virt,
-		  lib_info);
+			xtlib_globals->byteswap),
+			(xt_ptr)lib_info->data_buf_virt,
+			lib_info);
 
 	xtlib_load_seg(&pheader[2],
 		       (char *)library + xtlib_host_word(pheader[2].p_offset,
@@ -545,23 +719,506 @@ static xt_ptr xtlib_host_load_split_pi_library(
 					      lib_info);
 }
 
+/* must be called with lib_code_cache_lock held */
+static struct lib_code_cache *lib_code_cache_find(struct xf_proxy *proxy,
+						  struct lib_info *lib_info,
+						  unsigned int align)
+{
+	struct lib_code_cache *entry;
+
+	for (entry = lib_code_cache_head; entry; entry = entry->next) {
+		if (entry->proxy == proxy &&
+		    entry->mem_id == LIB_SECTION_MEM_ID &&
+		    entry->align == align &&
+		    entry->code_buf_size == lib_info->code_buf_size &&
+		    !strcmp(entry->filename, lib_info->filename))
+			return entry;
+	}
+
+	return NULL;
+}
+
+/* must be called with lib_code_cache_lock held */
+static struct lib_code_cache *lib_code_cache_add(struct xf_proxy *proxy,
+						 struct lib_info *lib_info,
+						 unsigned int align)
+{
+	int byteswap = lib_info->xtlib_globals.byteswap;
+	struct lib_code_cache *entry;
+
+	entry = calloc(1, sizeof(*entry));
+	if (!entry)
+		return NULL;
+
+	entry->filename = strdup(lib_info->filename);
+	if (!entry->filename) {
+		free(entry);
+		return NULL;
+	}
+
+	entry->proxy = proxy;
+	entry->mem_id = LIB_SECTION_MEM_ID;
+	entry->align = align;
+	entry->code_section_pool = lib_info->code_section_pool;
+	/* ...keep the aligned addresses as the shared bases */
+	entry->code_buf_virt = lib_info->code_buf_virt;
+	entry->code_buf_phys = xtlib_host_word(lib_info->pil_info.dst_addr,
+					       byteswap);
+	entry->code_buf_size = lib_info->code_buf_size;
+	entry->refcount = 1;
+
+	entry->next = lib_code_cache_head;
+	lib_code_cache_head = entry;
+
+	return entry;
+}
+
+/* must be called with lib_code_cache_lock held */
+static void lib_code_cache_put(struct lib_code_cache *entry)
+{
+	struct lib_code_cache **pp;
+
+	if (--entry->refcount)
+		return;
+
+	for (pp = &lib_code_cache_head; *pp; pp = &(*pp)->next) {
+		if (*pp == entry) {
+			*pp = entry->next;
+			break;
+		}
+	}
+
+	/* ...a loader that failed before the entry got ready wakes its waiters */
+	if (!entry->ready)
+		pthread_cond_broadcast(&lib_code_cache_cond);
+
+	xf_pool_free(entry->code_section_pool, LIB_SECTION_MEM_ID);
+	free(entry->filename);
+	free(entry);
+}
+
+/*
+ * lib_code_cache_publish - offer the code section of a loaded library to
+ * later instances
+ *
+ * The entry is not ready until the DSP has relocated the library, see
+ * lib_code_cache_ready(). If another instance published the library in the
+ * meantime, this one keeps its code private.
+ */
+static void lib_code_cache_publish(struct xf_proxy *proxy,
+				   struct lib_info *lib_info,
+				   unsigned int align)
+{
+	pthread_mutex_lock(&lib_code_cache_lock);
+
+	if (!lib_code_cache_find(proxy, lib_info, align))
+		lib_info->code_cache = lib_code_cache_add(proxy, lib_info, align);
+
+	pthread_mutex_unlock(&lib_code_cache_lock);
+}
+
+/* the DSP has relocated the library, let waiting instances share it */
+static void lib_code_cache_ready(struct lib_info *lib_info)
+{
+	pthread_mutex_lock(&lib_code_cache_lock);
+
+	if (lib_info->code_cache && !lib_info->code_cache->ready) {
+		lib_info->code_cache->ready = true;
+		pthread_cond_broadcast(&lib_code_cache_cond);
+	}
+
+	pthread_mutex_unlock(&lib_code_cache_lock);
+}
+
+static void free_dpu_sections(struct lib_info *lib_info)
+{
+	if (lib_info->code_cache) {
+		pthread_mutex_lock(&lib_code_cache_lock);
+		lib_code_cache_put(lib_info->code_cache);
+		pthread_mutex_unlock(&lib_code_cache_lock);
+		lib_info->code_cache = NULL;
+	} else if (lib_info->code_section_pool) {
+		xf_pool_free(lib_info->code_section_pool, LIB_SECTION_MEM_ID);
+	}
+	lib_info->code_section_pool = NULL;
+	lib_info->lib_type &= ~CODEC_LIB_SHARED_CODE;
+
+	if (lib_info->data_section_pool)
+		xf_pool_free(lib_info->data_section_pool, LIB_SECTION_MEM_ID);
+	lib_info->data_section_pool = NULL;
+
+	if (lib_info->s_data_section_pool)
+		xf_pool_free(lib_info->s_data_section_pool, LIB_SECTION_MEM_ID);
+	lib_info->s_data_section_pool = NULL;
+}
+
+/*
+ * alloc_dpu_sections - allocate code, data and scratch buffers
+ *
+ * @proxy: proxy the library is loaded through
+ * @lib_info: library, with section sizes set
+ * @align: section alignment of the library
+ *
+ * The code buffer is taken from the code cache when another instance
+ * already holds this library at the same placement. An entry still being
+ * relocated is waited for. Data and scratch buffers are always allocated.
+ */
+static long alloc_dpu_sections(struct xf_proxy *proxy,
+			       struct lib_info *lib_info,
+			       unsigned int align)
+{
+	struct lib_code_cache *code_cache;
+	struct xf_buffer *buf;
+	long ret_val;
+
+	/* ...reuse code if this library is already loaded */
+	pthread_mutex_lock(&lib_code_cache_lock);
+	while ((code_cache = lib_code_cache_find(proxy, lib_info, align)) &&
+	       !code_cache->ready)
+		pthread_cond_wait(&lib_code_cache_cond, &lib_code_cache_lock);
+	if (code_cache)
+		code_cache->refcount++;
+	pthread_mutex_unlock(&lib_code_cache_lock);
+
+	if (code_cache) {
+		lib_info->code_cache = code_cache;
+		lib_info->lib_type |= CODEC_LIB_SHARED_CODE;
+		lib_info->code_section_pool = code_cache->code_section_pool;
+		lib_info->code_buf_virt = code_cache->code_buf_virt;
+		lib_info->code_buf_phys = code_cache->code_buf_phys;
+	} else {
+		ret_val = xf_pool_alloc(proxy,
+					1,
+					lib_info->code_buf_size + align,
+					XF_POOL_AUX,
+					&lib_info->code_section_pool,
+					LIB_SECTION_MEM_ID);
+		if (ret_val) {
+			printf("not enough buffer when loading code section\n");
+			return -ENOMEM;
+		}
+
+		buf = xf_buffer_get(lib_info->code_section_pool);
+		lib_info->code_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
+		lib_info->code_buf_virt = xf_buffer_data(buf);
+	}
+
+	ret_val = xf_pool_alloc(proxy,
+				1,
+				lib_info->data_buf_size + align,
+				XF_POOL_AUX,
+				&lib_info->data_section_pool,
+				LIB_SECTION_MEM_ID);
+	if (ret_val) {
+		free_dpu_sections(lib_info);
+		printf("not enough buffer when loading data section\n");
+		return -ENOMEM;
+	}
+
+	buf = xf_buffer_get(lib_info->data_section_pool);
+	lib_info->data_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
+	lib_info->data_buf_virt = xf_buffer_data(buf);
+
+	ret_val = xf_pool_alloc(proxy,
+				1,
+				lib_info->s_data_buf_size + align,
+				XF_POOL_AUX,
+				&lib_info->s_data_section_pool,
+				LIB_SECTION_MEM_ID);
+	if (ret_val) {
+		free_dpu_sections(lib_info);
+		printf("not enough buffer when loading data section\n");
+		return -ENOMEM;
+	}
+
+	buf = xf_buffer_get(lib_info->s_data_section_pool);
+	lib_info->s_data_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
+	lib_info->s_data_buf_virt = xf_buffer_data(buf);
+
+	xf_buffer_put(buf);
+
+	return 0;
+}
+
+/*
+ * lib_image_path - locate the cached image of a library
+ *
+ * @filename: library file
+ * @key: returns the library key
+ *
+ * The key hashes the identity of the library file: device, inode, size and
+ * modification time. Looking an image up costs a stat() and never reads
+ * the library; any change to the file, or a copy of it, makes a new key.
+ * Returns NULL when the cache is disabled or the library can not be stat'ed.
+ */
+static char *lib_image_path(const char *filename, uint64_t *key)
+{
+	const char *dir = getenv(LIB_IMAGE_CACHE_ENV);
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint64_t id[5];
+	const unsigned char *p = (const unsigned char *)id;
+	struct stat st;
+	char *path;
+	size_t i;
+
+	if (!dir || !dir[0] || stat(filename, &st))
+		return NULL;
+
+	id[0] = st.st_dev;
+	id[1] = st.st_ino;
+	id[2] = st.st_size;
+	id[3] = st.st_mtim.tv_sec;
+	id[4] = st.st_mtim.tv_nsec;
+
+	/* ...FNV-1a over the file identity */
+	for (i = 0; i < sizeof(id); i++)
+		hash = (hash ^ p[i]) * 0x100000001b3ULL;
+
+	path = malloc(strlen(dir) + 22);
+	if (!path)
+		return NULL;
+	sprintf(path, "%s/%016llx.img", dir, (unsigned long long)hash);
+	*key = hash;
+
+	return path;
+}
+
+/*
+ * lib_image_load - load a library from its pre-relocated image
+ *
+ * @proxy: proxy the library is loaded through
+ * @lib_info: library to load
+ * @path: image file
+ * @key: library key the image must match
+ *
+ * The image is mapped and copied straight into freshly allocated sections.
+ * Its code and data carry absolute DSP addresses, so it is only usable when
+ * the code, data and scratch sections all land on the aligned addresses
+ * recorded in the header. That holds when instances are created in the same
+ * order on a fresh device, or one at a time; with other components alive
+ * the allocator usually places the sections elsewhere, and then they are
+ * released again and the caller falls back to loading the ELF file.
+ */
+static long lib_image_load(struct xf_proxy *proxy, struct lib_info *lib_info,
+			   const char *path, uint64_t key)
+{
+	struct lib_image_header *hdr;
+	unsigned int align;
+	unsigned int code_addr, data_addr, s_data_addr;
+	struct stat st;
+	char *image;
+	void *map;
+	long ret_val = 0;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -ENOENT;
+
+	if (fstat(fd, &st) || st.st_size < (off_t)sizeof(*hdr)) {
+		close(fd);
+		return -EINVAL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -ENOMEM;
+
+	hdr = (struct lib_image_header *)map;
+	if (hdr->magic != LIB_IMAGE_MAGIC || hdr->version != LIB_IMAGE_VERSION ||
+	    hdr->key != key || !hdr->align || hdr->shareable > 1 ||
+	    st.st_size != (off_t)(sizeof(*hdr) + hdr->code_len +
+				  hdr->data_len + hdr->s_data_len) ||
+	    hdr->code_len > hdr->code_buf_size ||
+	    hdr->data_len > hdr->data_buf_size ||
+	    hdr->s_data_len > hdr->s_data_buf_size) {
+		ret_val = -EINVAL;
+		goto out;
+	}
+
+	align = hdr->align;
+	lib_info->xtlib_globals.byteswap = hdr->byteswap;
+	lib_info->code_buf_size = hdr->code_buf_size;
+	lib_info->data_buf_size = hdr->data_buf_size;
+	lib_info->s_data_buf_size = hdr->s_data_buf_size;
+
+	ret_val = alloc_dpu_sections(proxy, lib_info, align);
+	if (ret_val)
+		goto out;
+
+	code_addr = align_ptr(lib_info->code_buf_phys, align);
+	data_addr = align_ptr(lib_info->data_buf_phys, align);
+	s_data_addr = align_ptr(lib_info->s_data_buf_phys, align);
+	if (code_addr != hdr->code_addr || data_addr != hdr->data_addr ||
+	    s_data_addr != hdr->s_data_addr) {
+		free_dpu_sections(lib_info);
+		ret_val = -EAGAIN;
+		goto out;
+	}
+
+	lib_info->code_buf_virt += code_addr - lib_info->code_buf_phys;
+	lib_info->data_buf_virt += data_addr - lib_info->data_buf_phys;
+	lib_info->s_data_buf_virt += s_data_addr - lib_info->s_data_buf_phys;
+
+	image = (char *)map + sizeof(*hdr);
+	if (!(lib_info->lib_type & CODEC_LIB_SHARED_CODE))
+		memcpy(lib_info->code_buf_virt, image, hdr->code_len);
+	image += hdr->code_len;
+	memcpy(lib_info->data_buf_virt, image, hdr->data_len);
+	image += hdr->data_len;
+	memcpy(lib_info->s_data_buf_virt, image, hdr->s_data_len);
+
+	memcpy(&lib_info->pil_info, &hdr->pil_info, sizeof(struct xtlib_pil_info));
+
+	/* ...code arrives relocated, the DSP only relocates data */
+	lib_info->lib_type |= CODEC_LIB_SHARED_CODE;
+
+	if (!lib_info->code_cache && hdr->shareable)
+		lib_code_cache_publish(proxy, lib_info, align);
+
+out:
+	munmap(map, st.st_size);
+	return ret_val;
+}
+
+static void lib_image_free(struct lib_info *lib_info)
+{
+	struct lib_image *image = lib_info->image;
+
+	if (!image)
+		return;
+
+	free(image->path);
+	free(image->data);
+	free(image->s_data);
+	free(image);
+	lib_info->image = NULL;
+}
+
+/*
+ * lib_image_prepare - keep the loaded data images for the image cache
+ *
+ * Data and scratch sections are modified by the DSP during relocation and
+ * init, so they are saved as loaded. The code section is read back after
+ * the DSP has relocated it, see lib_image_store().
+ */
+static void lib_image_prepare(struct lib_info *lib_info, char *path,
+			      uint64_t key, Elf32_Phdr *pheader,
+			      unsigned int align, bool shareable)
+{
+	int byteswap = lib_info->xtlib_globals.byteswap;
+	struct lib_image *image;
+	struct lib_image_header *hdr;
+
+	image = calloc(1, sizeof(*image));
+	if (!image) {
+		free(path);
+		return;
+	}
+
+	image->path = path;
+	hdr = &image->header;
+	hdr->magic = LIB_IMAGE_MAGIC;
+	hdr->version = LIB_IMAGE_VERSION;
+	hdr->key = key;
+	hdr->code_addr = xtlib_host_word(lib_info->pil_info.dst_addr, byteswap);
+	hdr->data_addr = xtlib_host_word(lib_info->pil_info.dst_data_addr, byteswap);
+	hdr->s_data_addr = align_ptr(lib_info->s_data_buf_phys, align);
+	hdr->code_buf_size = lib_info->code_buf_size;
+	hdr->data_buf_size = lib_info->data_buf_size;
+	hdr->s_data_buf_size = lib_info->s_data_buf_size;
+	hdr->align = align;
+	hdr->code_len = xtlib_host_word(pheader[0].p_memsz, byteswap);
+	hdr->data_len = xtlib_host_word(pheader[1].p_memsz, byteswap);
+	hdr->s_data_len = xtlib_host_word(pheader[2].p_memsz, byteswap);
+	hdr->byteswap = byteswap;
+	hdr->shareable = shareable;
+	memcpy(&hdr->pil_info, &lib_info->pil_info, sizeof(struct xtlib_pil_info));
+
+	image->data = malloc(hdr->data_len);
+	image->s_data = malloc(hdr->s_data_len);
+	if ((hdr->data_len && !image->data) || (hdr->s_data_len && !image->s_data)) {
+		lib_info->image = image;
+		lib_image_free(lib_info);
+		return;
+	}
+	memcpy(image->data, lib_info->data_buf_virt, hdr->data_len);
+	memcpy(image->s_data, lib_info->s_data_buf_virt, hdr->s_data_len);
+
+	lib_info->image = image;
+}
+
+/*
+ * lib_image_store - write the pre-relocated image of a library
+ *
+ * Called once the DSP has relocated the code section. The image is written
+ * to a temporary file and renamed, so concurrent readers never map a
+ * partial image.
+ */
+static void lib_image_store(struct lib_info *lib_info)
+{
+	struct lib_image *image = lib_info->image;
+	struct lib_image_header *hdr = &image->header;
+	char *tmp_path;
+	FILE *fp;
+	int err = 0;
+
+	tmp_path = malloc(strlen(image->path) + 16);
+	if (!tmp_path)
+		goto out;
+	sprintf(tmp_path, "%s.%d", image->path, getpid());
+
+	fp = fopen(tmp_path, "wb");
+	if (!fp)
+		goto out;
+
+	if (fwrite(hdr, sizeof(*hdr), 1, fp) != 1 ||
+	    fwrite(lib_info->code_buf_virt, 1, hdr->code_len, fp) != hdr->code_len ||
+	    fwrite(image->data, 1, hdr->data_len, fp) != hdr->data_len ||
+	    fwrite(image->s_data, 1, hdr->s_data_len, fp) != hdr->s_data_len)
+		err = -EIO;
+
+	if (fclose(fp))
+		err = -EIO;
+
+	if (err || rename(tmp_path, image->path)) {
+		TRACE(ERROR, _b("failed to store library image %s\n"), image->path);
+		unlink(tmp_path);
+	}
+
+out:
+	free(tmp_path);
+	lib_image_free(lib_info);
+}
+
 static long load_dpu_with_library(struct xf_proxy *proxy,
 				  struct lib_info *lib_info)
 {
 	FILE *fpInfile = NULL;
 	unsigned char *srambuf = NULL;
 	struct lib_dnld_info_t dpulib;
-	struct xf_buffer *buf;
 	Elf32_Phdr *pheader;
 	Elf32_Ehdr *header;
 	unsigned int align;
+	bool shareable;
+	char *image_path;
+	uint64_t image_key = 0;
 	int filesize = 0;
 	long ret_val = 0;
 
+	/* ...try the pre-relocated image first, without reading the library */
+	image_path = lib_image_path(lib_info->filename, &image_key);
+	if (image_path && !lib_image_load(proxy, lib_info, image_path, image_key)) {
+		free(image_path);
+		return 0;
+	}
+
 	/* Load DPU's main program to System memory */
 	fpInfile = fopen(lib_info->filename, "r");
 	if (!fpInfile) {
 		TRACE(ERROR, _b("Error: %s not exist\n"), lib_info->filename);
+		free(image_path);
 		return -ENOENT;
 	}
 
@@ -580,8 +1237,11 @@ static long load_dpu_with_library(struct xf_proxy *proxy,
 			(unsigned int *)&dpulib.size_data,
 			(unsigned int *)&dpulib.size_scratch_data,
 			lib_info);
-	if (ret_val != XTLIB_NO_ERR)
+	if (ret_val != XTLIB_NO_ERR) {
+		free(srambuf);
+		free(image_path);
 		return -EINVAL;
+	}
 
 	lib_info->code_buf_size = dpulib.size_code;
 	lib_info->data_buf_size = dpulib.size_data;
@@ -594,56 +1254,13 @@ static long load_dpu_with_library(struct xf_proxy *proxy,
 
 	align = find_align(header, lib_info);
 
-	ret_val = xf_pool_alloc(proxy,
-				1,
-				dpulib.size_code + align,
-				XF_POOL_AUX,
-				&lib_info->code_section_pool,
-				XAF_MEM_ID_COMP);
+	ret_val = alloc_dpu_sections(proxy, lib_info, align);
 	if (ret_val) {
 		free(srambuf);
-		printf("not enough buffer when loading code section\n");
-		return -ENOMEM;
-	}
-
-	ret_val = xf_pool_alloc(proxy,
-				1,
-				dpulib.size_data + align,
-				XF_POOL_AUX,
-				&lib_info->data_section_pool,
-				XAF_MEM_ID_COMP);
-	if (ret_val) {
-		free(srambuf);
-		printf("not enough buffer when loading data section\n");
-		return -ENOMEM;
-	}
-
-	ret_val = xf_pool_alloc(proxy,
-				1,
-				dpulib.size_scratch_data + align,
-				XF_POOL_AUX,
-				&lib_info->s_data_section_pool,
-				XAF_MEM_ID_COMP);
-	if (ret_val) {
-		free(srambuf);
-		printf("not enough buffer when loading data section\n");
-		return -ENOMEM;
+		free(image_path);
+		return ret_val;
 	}
 
-	buf = xf_buffer_get(lib_info->code_section_pool);
-	lib_info->code_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
-	lib_info->code_buf_virt = xf_buffer_data(buf);
-
-	buf = xf_buffer_get(lib_info->data_section_pool);
-	lib_info->data_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
-	lib_info->data_buf_virt = xf_buffer_data(buf);
-
-	buf = xf_buffer_get(lib_info->s_data_section_pool);
-	lib_info->s_data_buf_phys = xf_proxy_b2a(proxy, xf_buffer_data(buf));
-	lib_info->s_data_buf_virt = xf_buffer_data(buf);
-
-	xf_buffer_put(buf);
-
 	dpulib.pbuf_code = (unsigned long)lib_info->code_buf_phys;
 	dpulib.pbuf_data = (unsigned long)lib_info->data_buf_phys;
 	dpulib.pbuf_scratch_data = (unsigned long)lib_info->s_data_buf_phys;
@@ -657,9 +1274,19 @@ static long load_dpu_with_library(struct xf_proxy *proxy,
 			(struct xtlib_pil_info *)dpulib.ppil_inf,
 			(void *)lib_info);
 
+	shareable = xtlib_code_shareable(header, lib_info);
+
+	/* ...publish the relocated code to later instances */
+	if (!lib_info->code_cache && shareable)
+		lib_code_cache_publish(proxy, lib_info, align);
+
+	if (image_path)
+		lib_image_prepare(lib_info, image_path, image_key, pheader,
+				  align, shareable);
+
 	free(srambuf);
 
-	return ret_val;
+	return 0;
 }
 
 static long unload_dpu_with_library(struct xf_proxy *proxy,
@@ -668,9 +1295,8 @@ static long unload_dpu_with_library(struct xf_proxy *proxy,
 	if (!lib_info->code_section_pool || !lib_info->data_section_pool ||
 			!lib_info->s_data_section_pool)
 		return XAF_INVALIDPTR_ERR;
-	xf_pool_free(lib_info->code_section_pool, XAF_MEM_ID_COMP);
-	xf_pool_free(lib_info->data_section_pool, XAF_MEM_ID_COMP);
-	xf_pool_free(lib_info->s_data_section_pool, XAF_MEM_ID_COMP);
+
+	free_dpu_sections(lib_info);
 
 	return 0;
 }
@@ -711,10 +1337,17 @@ long xf_load_lib(xaf_comp_t *p_comp, struct lib_info *lib_info)
 		goto unload;
 	}
 
+	/* ...code section is relocated now, save it for the next load */
+	if (lib_info->image)
+		lib_image_store(lib_info);
+
+	lib_code_cache_ready(lib_info);
+
 	TRACE(INFO, _b("load loabable lib ok, lib_type = %d\n"), lib_info->lib_type);
 
 	return 0;
 unload:
+	lib_image_free(lib_info);
 	unload_dpu_with_library(proxy, lib_info);
 	return ret_val;
 }
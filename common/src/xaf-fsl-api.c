@@ -1054,6 +1054,11 @@ XAF_ERR_CODE xaf_load_library(xaf_adev_t *p_adev, xaf_comp_t *p_comp, xf_id_t co
 
 	p_handle = &p_comp->handle;
 
+#ifdef XF_IPC_LOOPBACK
+	/* ...emulated DSP runs no codec code, nothing to load */
+	return XAF_NO_ERR;
+#endif
+
 	/* ...init codec lib and codec wrap lib */
 	strcpy(lib_path, CORE_LIB_PATH);
 	strcpy(lib_wrap_path, CORE_LIB_PATH);
@@ -1177,7 +1182,7 @@ XAF_ERR_CODE xaf_comp_create(pVOID adev_ptr, pVOID *pp_comp, xaf_comp_config_t *
     if (ninbuf) XAF_CHK_PTR(pp_inbuf);
 
     XAF_CHK_RANGE(ninbuf, 0, XAF_MAX_INBUFS);
-    XAF_CHK_RANGE(noutbuf, 0, 1);
+    XAF_CHK_RANGE(noutbuf, 0, XAF_MAX_OUTBUFS);
     XAF_CHK_RANGE(comp_type, XAF_DECODER, XAF_MAX_COMPTYPE-1); 
 
 #ifndef XA_DISABLE_EVENT
@@ -1235,6 +1240,7 @@ XAF_ERR_CODE xaf_comp_create(pVOID adev_ptr, pVOID *pp_comp, xaf_comp_config_t *
     {
         p_comp->cmap[i].ptr  = NULL;
         p_comp->cmap[i].port = PORT_NOT_CONNECTED;
+        p_comp->cmap[i].fanout = 0;
     }
 
     switch (comp_type)
@@ -1246,7 +1252,7 @@ XAF_ERR_CODE xaf_comp_create(pVOID adev_ptr, pVOID *pp_comp, xaf_comp_config_t *
         p_comp->inp_ports = 1; p_comp->out_ports = 1;
         break;
     case XAF_MIXER:
-        p_comp->inp_ports = 4; p_comp->out_ports = 1;
+        p_comp->inp_ports = XA_MIXER_MAX_TRACK_NUMBER; p_comp->out_ports = 1;
         break;
 #if 0 /* by S.J*/
     case XAF_MIMO_PROC_12 ... (XAF_MAX_COMPTYPE-1):
@@ -1310,7 +1316,7 @@ XAF_ERR_CODE xaf_comp_create_deprecated(pVOID adev_ptr, pVOID *pp_comp, xf_id_t
     if (ninbuf) XAF_CHK_PTR(pp_inbuf);
 
     XAF_CHK_RANGE(ninbuf, 0, XAF_MAX_INBUFS);
-    XAF_CHK_RANGE(noutbuf, 0, 1);
+    XAF_CHK_RANGE(noutbuf, 0, XAF_MAX_OUTBUFS);
     XAF_CHK_RANGE(comp_type, XAF_DECODER, XAF_MAX_COMPTYPE-1); 
 
     XAF_ADEV_STATE_CHK(p_adev, XAF_ADEV_RESET);
@@ -1363,6 +1369,7 @@ XAF_ERR_CODE xaf_comp_create_deprecated(pVOID adev_ptr, pVOID *pp_comp, xf_id_t
     {
         p_comp->cmap[i].ptr  = NULL;
         p_comp->cmap[i].port = PORT_NOT_CONNECTED;
+        p_comp->cmap[i].fanout = 0;
     }
 
     switch (comp_type)
@@ -1374,7 +1381,7 @@ XAF_ERR_CODE xaf_comp_create_deprecated(pVOID adev_ptr, pVOID *pp_comp, xf_id_t
         p_comp->inp_ports = 1; p_comp->out_ports = 1;
         break;
     case XAF_MIXER:
-        p_comp->inp_ports = 4; p_comp->out_ports = 1;
+        p_comp->inp_ports = XA_MIXER_MAX_TRACK_NUMBER; p_comp->out_ports = 1;
         break;
     case XAF_MIMO_PROC_12 ... (XAF_MAX_COMPTYPE-1):
         p_comp->inp_ports  = xf_io_ports[comp_type][0];
@@ -1655,6 +1662,10 @@ XAF_ERR_CODE xaf_comp_get_status(pVOID adev_ptr, pVOID comp_ptr, xaf_comp_status
                         	p_comp->pending_resp--;
 
                         	TRACE(INFO, _b("FTB R[%08x]:(%08x,%u,%p)"), rmsg.id, rmsg.opcode, rmsg.length, rmsg.buffer);
+
+                        	/* ...drained output buffers are handed back to the application */
+                        	if (rmsg.opcode == XF_FILL_THIS_BUFFER && XF_MSG_SRC_PORT(rmsg.id) == p_comp->inp_ports)
+                        	    p_comp->expect_out_cmd++;
                         }
 
                         p_comp->comp_status = XAF_EXEC_DONE;
@@ -1708,6 +1719,10 @@ XAF_ERR_CODE xaf_comp_get_status(pVOID adev_ptr, pVOID comp_ptr, xaf_comp_status
                 	p_comp->pending_resp--;
 
                 	TRACE(INFO, _b("ETB R[%08x]:(%08x,%u,%p)"), rmsg.id, rmsg.opcode, rmsg.length, rmsg.buffer);
+
+                	/* ...drained output buffers are handed back to the application */
+                	if (rmsg.opcode == XF_FILL_THIS_BUFFER && XF_MSG_SRC_PORT(rmsg.id) == p_comp->inp_ports)
+                	    p_comp->expect_out_cmd++;
                 }
 
             	p_comp->comp_status = XAF_EXEC_DONE;
@@ -1878,17 +1893,18 @@ XAF_ERR_CODE xaf_comp_process(pVOID adev_ptr, pVOID comp_ptr, pVOID p_buf, UWORD
     return XAF_NO_ERR;
 }
 
-XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 num_buf)
+/* ...route ports; "num_buf" may carry adaptive route flag */
+static XAF_ERR_CODE xaf_connect_route(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, UWORD32 num_buf)
 {
     xaf_comp_t *src_comp;
     xaf_comp_t *dest_comp;
+    UWORD32     fanout;
 
     src_comp  = (xaf_comp_t *) p_src;
     dest_comp = (xaf_comp_t *) p_dest;
     
     XAF_CHK_PTR(src_comp);
     XAF_CHK_PTR(dest_comp);
-    XAF_CHK_RANGE(num_buf, 1, 1024);    
 
     XAF_COMP_STATE_CHK(src_comp);
     XAF_COMP_STATE_CHK(dest_comp);
@@ -1904,9 +1920,8 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     if (dest_in_port < 0 || dest_in_port >= (WORD32)dest_comp->inp_ports)
         return XAF_ROUTING_ERR;
 
-    /* ...src component connection validity check */
-    if (src_comp->cmap[src_out_port].ptr != NULL || src_comp->cmap[src_out_port].port != PORT_NOT_CONNECTED)
-        return XAF_ROUTING_ERR;
+    /* ...connected src port fans out; its buffers are shared with the new sink (num_buf is ignored) */
+    fanout = (src_comp->cmap[src_out_port].ptr != NULL || src_comp->cmap[src_out_port].port != PORT_NOT_CONNECTED);
 
     /* ...dest component connection validity check */
     if (dest_comp->cmap[dest_in_port].ptr != NULL || dest_comp->cmap[dest_in_port].port != PORT_NOT_CONNECTED)
@@ -1916,8 +1931,15 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     XF_CHK_API(xf_route(&src_comp->handle, src_out_port, &dest_comp->handle, dest_in_port, num_buf, src_comp->out_format.output_length[src_out_port - src_comp->inp_ports], 8));
     
     /* ...update src component map */
-    src_comp->cmap[src_out_port].ptr  = dest_comp;
-    src_comp->cmap[src_out_port].port = dest_in_port;
+    if (fanout)
+    {
+        src_comp->cmap[src_out_port].fanout++;
+    }
+    else
+    {
+        src_comp->cmap[src_out_port].ptr  = dest_comp;
+        src_comp->cmap[src_out_port].port = dest_in_port;
+    }
 
     /* ...update dest component map */
     dest_comp->cmap[dest_in_port].ptr  = src_comp;
@@ -1926,6 +1948,21 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     return XAF_NO_ERR;
 }
 
+XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 num_buf)
+{
+    XAF_CHK_RANGE(num_buf, 1, 1024);    
+
+    return xaf_connect_route(p_src, src_out_port, p_dest, dest_in_port, num_buf);
+}
+
+/* ...route starts with few buffers and grows up to "max_buf" on stalls; see XAF_PORT_DEPTH */
+XAF_ERR_CODE xaf_connect_adaptive(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 max_buf)
+{
+    XAF_CHK_RANGE(max_buf, 1, 1024);    
+
+    return xaf_connect_route(p_src, src_out_port, p_dest, dest_in_port, (UWORD32)max_buf | XF_ROUTE_ADAPTIVE);
+}
+
 XAF_ERR_CODE xaf_disconnect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port)
 {
     xaf_comp_t *src_comp; 
@@ -1950,19 +1987,51 @@ XAF_ERR_CODE xaf_disconnect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD
     if (dest_in_port < 0 || dest_in_port >= (WORD32)dest_comp->inp_ports)
         return XAF_ROUTING_ERR;
 
-    /* ...src component connection validity check */
-    if (src_comp->cmap[src_out_port].ptr != dest_comp || (WORD32)src_comp->cmap[src_out_port].port != dest_in_port)
-        return XAF_ROUTING_ERR;
-
     /* ...dest component connection validity check */
     if (dest_comp->cmap[dest_in_port].ptr != src_comp || (WORD32)dest_comp->cmap[dest_in_port].port != src_out_port)
         return XAF_ROUTING_ERR;
 
-    XF_CHK_API(xf_unroute(&src_comp->handle, src_out_port));
+    /* ...src component connection validity check; any sink of fanned-out port may go */
+    if (!src_comp->cmap[src_out_port].fanout && (src_comp->cmap[src_out_port].ptr != dest_comp || (WORD32)src_comp->cmap[src_out_port].port != dest_in_port))
+        return XAF_ROUTING_ERR;
 
-    /* ...update src component map */
-    src_comp->cmap[src_out_port].ptr  = NULL;
-    src_comp->cmap[src_out_port].port = PORT_NOT_CONNECTED;
+    if (src_comp->cmap[src_out_port].fanout)
+    {
+        /* ...unroute this sink only; the others keep running */
+        XF_CHK_API(xf_unroute_sink(&src_comp->handle, src_out_port, &dest_comp->handle, dest_in_port));
+
+        src_comp->cmap[src_out_port].fanout--;
+
+        /* ...src component map names one of the remaining sinks */
+        if (src_comp->cmap[src_out_port].ptr == dest_comp && (WORD32)src_comp->cmap[src_out_port].port == dest_in_port)
+        {
+            xaf_adev_t *p_adev = (xaf_adev_t *) src_comp->p_adev;
+            xaf_comp_t *p_comp;
+            UWORD32     i;
+
+            __xf_lock(&p_adev->comp_chain.lock);
+            for (p_comp = (xaf_comp_t *) p_adev->comp_chain.head; p_comp != NULL; p_comp = p_comp->next)
+            {
+                for (i = 0; i < p_comp->inp_ports; i++)
+                {
+                    if (p_comp->cmap[i].ptr == src_comp && p_comp->cmap[i].port == (UWORD32)src_out_port && !(p_comp == dest_comp && i == (UWORD32)dest_in_port))
+                    {
+                        src_comp->cmap[src_out_port].ptr  = p_comp;
+                        src_comp->cmap[src_out_port].port = i;
+                    }
+                }
+            }
+            __xf_unlock(&p_adev->comp_chain.lock);
+        }
+    }
+    else
+    {
+        XF_CHK_API(xf_unroute(&src_comp->handle, src_out_port));
+
+        /* ...update src component map */
+        src_comp->cmap[src_out_port].ptr  = NULL;
+        src_comp->cmap[src_out_port].port = PORT_NOT_CONNECTED;
+    }
 
     /* ...update dest component map */
     dest_comp->cmap[dest_in_port].ptr  = NULL;
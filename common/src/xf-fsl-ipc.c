@@ -43,6 +43,10 @@
 #include "xaf-structs.h"
 #include "osal-msgq.h"
 
+#ifdef XF_IPC_LOOPBACK
+#include "xf-fsl-loopback.h"
+#endif
+
 /*******************************************************************************
  * Global Definitions
  ******************************************************************************/
@@ -93,6 +97,7 @@ int xf_ipc_send(xf_proxy_ipc_data_t *ipc, xf_proxy_msg_t *msg, void *b)
 	ret = write(fd, msg, sizeof(*msg));
 	if (ret < 0)
 		return -errno;
+	ipc->msg_sent++;
 	/* ...communication mutex is still locked! */
 	return 0;
 }
@@ -420,6 +425,12 @@ int xf_ipc_open(struct xf_proxy_ipc_data *ipc, UWORD32 core)
 	/* set the handle function of SIGUSR1 */
 	sigaction(SIGUSR1, &actions, NULL);
 
+#ifdef XF_IPC_LOOPBACK
+	/* ...DSP emulated in process, no remoteproc or DSP heap */
+	ret = xf_loopback_open(ipc);
+	if (ret < 0)
+		return ret;
+#else
 	/* ...open file handle */
 	ret = xf_rproc_open(ipc);
 	if (ret < 0)
@@ -430,6 +441,7 @@ int xf_ipc_open(struct xf_proxy_ipc_data *ipc, UWORD32 core)
 		xf_rproc_close(ipc);
 		return ret;
 	}
+#endif
 
 	/* ...create pipe for asynchronous response delivery */
 	XF_CHK_ERR(pipe(ipc->pipe) == 0, -errno);
@@ -445,9 +457,13 @@ void xf_ipc_close(struct xf_proxy_ipc_data *ipc, UWORD32 core)
 	/* ...close asynchronous response delivery pipe */
 	close(ipc->pipe[0]), close(ipc->pipe[1]);
 
+#ifdef XF_IPC_LOOPBACK
+	xf_loopback_close(ipc);
+#else
 	xf_dma_buf_close(ipc);
 	/* ...close proxy file handle */
 	xf_rproc_close(ipc);
+#endif
 
 	TRACE(INFO, _b("proxy interface closed\n"));
 }
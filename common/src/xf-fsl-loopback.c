@@ -0,0 +1,471 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Loopback DSP: stands in for remoteproc, rpmsg and the DSP heap when the
+ * AP side is built with XF_IPC_LOOPBACK.
+ *
+ * Proxy messages go through a socket pair to a thread that plays the DSP:
+ * it hands out shared memory from an anonymous mapping, registers clients
+ * and runs every component as a decoder that turns each input buffer into
+ * one frame of silence. No codec code runs, so the numbers it gives are
+ * the AP side cost of the wrapper, proxy and IPC path only.
+ */
+
+#define MODULE_TAG                      IPC
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include "xf.h"
+#include "fsl_unia.h"
+#include "xf-fsl-loopback.h"
+
+/* ...same size as the DSP heap of the real device */
+#define XF_LOOPBACK_SHMEM_SIZE          0xEF0000
+#define XF_LOOPBACK_MAX_CLIENTS         64
+#define XF_LOOPBACK_MAX_OUTBUFS         8
+/* ...samples per channel in every emulated frame */
+#define XF_LOOPBACK_FRAME_SAMPLES       1024
+
+/* shared memory block handed out by XF_ALLOC */
+struct xf_loopback_block {
+	struct xf_loopback_block *next;
+	UWORD32 offset;
+	UWORD32 size;
+};
+
+/* emulated component */
+struct xf_loopback_comp {
+	bool used;
+	bool started;
+
+	UWORD32 samplerate;
+	UWORD32 channels;
+	UWORD32 depth;
+	UWORD32 consumed;
+
+	/* ...frames decoded but not delivered yet */
+	UWORD32 frames;
+
+	/* ...output buffers waiting for a frame */
+	xf_proxy_msg_t out[XF_LOOPBACK_MAX_OUTBUFS];
+	UWORD32 out_num;
+
+	/* ...input is over, output buffers come back empty once drained */
+	bool input_over;
+
+	/* ...end of stream command, answered once all output is out */
+	xf_proxy_msg_t eos;
+	bool eos_pending;
+};
+
+struct xf_loopback {
+	int fd;
+	pthread_t thread;
+	void *shmem;
+	UWORD32 shmem_size;
+	struct xf_loopback_block *blocks;
+	struct xf_loopback_comp comp[XF_LOOPBACK_MAX_CLIENTS];
+};
+
+/* ...shared address to local pointer, the same mapping as the proxy sees */
+static inline void *xf_loopback_ptr(struct xf_loopback *lb, UWORD32 address)
+{
+	return (unsigned char *)lb->shmem + address;
+}
+
+static void xf_loopback_reply(struct xf_loopback *lb, xf_proxy_msg_t *m)
+{
+	/* ...response goes back to the sender */
+	m->id = __XF_MSG_ID(XF_MSG_DST(m->id), XF_MSG_SRC(m->id));
+
+	if (write(lb->fd, m, sizeof(*m)) != sizeof(*m))
+		TRACE(ERROR, _x("loopback response lost: %d"), errno);
+}
+
+/* first fit in the shared memory, offset 0 stays unused as it means NULL */
+static UWORD32 xf_loopback_alloc(struct xf_loopback *lb, UWORD32 size)
+{
+	struct xf_loopback_block **pp, *b;
+	UWORD32 start = XF_PROXY_ALIGNMENT;
+
+	size = (size + XF_PROXY_ALIGNMENT - 1) & ~(XF_PROXY_ALIGNMENT - 1);
+
+	for (pp = &lb->blocks; *pp; pp = &(*pp)->next) {
+		if ((*pp)->offset - start >= size)
+			break;
+		start = (*pp)->offset + (*pp)->size;
+	}
+
+	if (!size || start + size > lb->shmem_size)
+		return 0;
+
+	b = malloc(sizeof(*b));
+	if (!b)
+		return 0;
+
+	b->offset = start;
+	b->size = size;
+	b->next = *pp;
+	*pp = b;
+
+	return start;
+}
+
+static void xf_loopback_free(struct xf_loopback *lb, UWORD32 offset)
+{
+	struct xf_loopback_block **pp, *b;
+
+	for (pp = &lb->blocks; *pp; pp = &(*pp)->next) {
+		if ((*pp)->offset == offset) {
+			b = *pp;
+			*pp = b->next;
+			free(b);
+			return;
+		}
+	}
+}
+
+static struct xf_loopback_comp *xf_loopback_comp(struct xf_loopback *lb,
+						 UWORD32 id)
+{
+	UWORD32 client = XF_PORT_CLIENT(XF_MSG_DST(id));
+
+	if (!client || client >= XF_LOOPBACK_MAX_CLIENTS ||
+	    !lb->comp[client].used)
+		return NULL;
+
+	return &lb->comp[client];
+}
+
+static void xf_loopback_register(struct xf_loopback *lb, xf_proxy_msg_t *m)
+{
+	struct xf_loopback_comp *comp;
+	UWORD32 client;
+
+	for (client = 1; client < XF_LOOPBACK_MAX_CLIENTS; client++) {
+		if (!lb->comp[client].used)
+			break;
+	}
+
+	if (client == XF_LOOPBACK_MAX_CLIENTS) {
+		/* ...any other opcode tells the proxy registering failed */
+		m->opcode = XF_UNREGISTER;
+		xf_loopback_reply(lb, m);
+		return;
+	}
+
+	comp = &lb->comp[client];
+	memset(comp, 0, sizeof(*comp));
+	comp->used = true;
+	comp->samplerate = 44100;
+	comp->channels = 2;
+	comp->depth = 16;
+
+	/* ...the new component is the source of the response */
+	m->id = __XF_MSG_ID(XF_MSG_SRC(m->id), __XF_PORT_SPEC(0, client, 0));
+	xf_loopback_reply(lb, m);
+}
+
+static UWORD32 xf_loopback_frame_bytes(struct xf_loopback_comp *comp)
+{
+	return XF_LOOPBACK_FRAME_SAMPLES * comp->channels *
+		(comp->depth > 16 ? 4 : 2);
+}
+
+/* deliver decoded frames, then end the stream once input is over */
+static void xf_loopback_output(struct xf_loopback *lb,
+			       struct xf_loopback_comp *comp)
+{
+	xf_proxy_msg_t *m;
+	UWORD32 i, size;
+
+	for (i = 0; i < comp->out_num && comp->frames; i++, comp->frames--) {
+		m = &comp->out[i];
+		size = xf_loopback_frame_bytes(comp);
+		if (size > m->length)
+			size = m->length;
+		memset(xf_loopback_ptr(lb, m->address), 0, size);
+		m->length = size;
+		xf_loopback_reply(lb, m);
+	}
+	comp->out_num -= i;
+	memmove(&comp->out[0], &comp->out[i], comp->out_num * sizeof(comp->out[0]));
+
+	if (!comp->input_over || comp->frames)
+		return;
+
+	/* ...empty output buffers mark the end of stream */
+	for (i = 0; i < comp->out_num; i++) {
+		comp->out[i].length = 0;
+		xf_loopback_reply(lb, &comp->out[i]);
+	}
+	comp->out_num = 0;
+
+	if (comp->eos_pending) {
+		comp->eos_pending = false;
+		xf_loopback_reply(lb, &comp->eos);
+	}
+}
+
+static void xf_loopback_fill(struct xf_loopback *lb,
+			     struct xf_loopback_comp *comp, xf_proxy_msg_t *m)
+{
+	xf_start_msg_t *smsg;
+
+	if (!comp->started) {
+		/* ...first request carries the output format back */
+		smsg = xf_loopback_ptr(lb, m->address);
+		memset(smsg, 0, sizeof(*smsg));
+		smsg->sample_rate = comp->samplerate;
+		smsg->channels = comp->channels;
+		smsg->pcm_width = comp->depth;
+		smsg->input_length[0] = 4096;
+		smsg->output_length[0] = xf_loopback_frame_bytes(comp);
+		m->length = sizeof(*smsg);
+		comp->started = true;
+		xf_loopback_reply(lb, m);
+		return;
+	}
+
+	if (comp->out_num == XF_LOOPBACK_MAX_OUTBUFS) {
+		m->length = 0;
+		xf_loopback_reply(lb, m);
+		return;
+	}
+
+	comp->out[comp->out_num++] = *m;
+	xf_loopback_output(lb, comp);
+}
+
+static void xf_loopback_empty(struct xf_loopback *lb,
+			      struct xf_loopback_comp *comp, xf_proxy_msg_t *m)
+{
+	if (!m->address) {
+		/* ...input over, answered after the last frame */
+		comp->eos = *m;
+		comp->eos_pending = true;
+		comp->input_over = true;
+	} else {
+		comp->input_over = false;
+		comp->consumed += m->length;
+		if (m->length)
+			comp->frames++;
+		xf_loopback_reply(lb, m);
+	}
+
+	xf_loopback_output(lb, comp);
+}
+
+static void xf_loopback_set_param(struct xf_loopback_comp *comp,
+				  xf_set_param_msg_t *smsg, UWORD32 length)
+{
+	UWORD32 i, n = length / sizeof(xf_set_param_item_t);
+
+	for (i = 0; i < n; i++) {
+		if (!smsg->item[i].value)
+			continue;
+		if (smsg->item[i].id == UNIA_SAMPLERATE)
+			comp->samplerate = smsg->item[i].value;
+		else if (smsg->item[i].id == UNIA_CHANNEL)
+			comp->channels = smsg->item[i].value;
+		else if (smsg->item[i].id == UNIA_DEPTH)
+			comp->depth = smsg->item[i].value;
+	}
+}
+
+static void xf_loopback_get_param(struct xf_loopback_comp *comp,
+				  xf_get_param_msg_t *gmsg, UWORD32 length)
+{
+	UWORD32 i, n = length / sizeof(UWORD32);
+
+	/* ...values are written over the ids in place */
+	for (i = 0; i < n; i++) {
+		switch (gmsg->c.id[i]) {
+		case UNIA_SAMPLERATE:
+			gmsg->r.value[i] = comp->samplerate;
+			break;
+		case UNIA_CHANNEL:
+			gmsg->r.value[i] = comp->channels;
+			break;
+		case UNIA_DEPTH:
+			gmsg->r.value[i] = comp->depth;
+			break;
+		case UNIA_CONSUMED_LENGTH:
+			gmsg->r.value[i] = comp->consumed;
+			break;
+		default:
+			gmsg->r.value[i] = 0;
+			break;
+		}
+	}
+}
+
+/* drop pending input and hand every output buffer back empty */
+static void xf_loopback_flush(struct xf_loopback *lb,
+			      struct xf_loopback_comp *comp)
+{
+	UWORD32 i;
+
+	comp->frames = 0;
+	comp->input_over = false;
+
+	for (i = 0; i < comp->out_num; i++) {
+		comp->out[i].length = 0;
+		xf_loopback_reply(lb, &comp->out[i]);
+	}
+	comp->out_num = 0;
+
+	if (comp->eos_pending) {
+		comp->eos_pending = false;
+		xf_loopback_reply(lb, &comp->eos);
+	}
+}
+
+static void xf_loopback_command(struct xf_loopback *lb, xf_proxy_msg_t *m)
+{
+	struct xf_loopback_comp *comp = xf_loopback_comp(lb, m->id);
+
+	switch (m->opcode) {
+	case XF_REGISTER:
+		xf_loopback_register(lb, m);
+		return;
+	case XF_ALLOC:
+		m->address = xf_loopback_alloc(lb, m->length);
+		break;
+	case XF_FREE:
+		xf_loopback_free(lb, m->address);
+		break;
+	case XF_UNREGISTER:
+		if (comp)
+			comp->used = false;
+		break;
+	case XF_EVENT:
+		/* ...no errors to report, the buffer stays with the DSP */
+		return;
+	case XF_FILL_THIS_BUFFER:
+		if (comp) {
+			xf_loopback_fill(lb, comp, m);
+			return;
+		}
+		break;
+	case XF_EMPTY_THIS_BUFFER:
+		if (comp) {
+			xf_loopback_empty(lb, comp, m);
+			return;
+		}
+		break;
+	case XF_SET_PARAM:
+		if (comp)
+			xf_loopback_set_param(comp, xf_loopback_ptr(lb, m->address),
+					      m->length);
+		break;
+	case XF_GET_PARAM:
+		if (comp)
+			xf_loopback_get_param(comp, xf_loopback_ptr(lb, m->address),
+					      m->length);
+		break;
+	case XF_FLUSH:
+		if (comp)
+			xf_loopback_flush(lb, comp);
+		break;
+	default:
+		/* ...routing, events, pause and resume have nothing to emulate */
+		break;
+	}
+
+	xf_loopback_reply(lb, m);
+}
+
+static void *xf_loopback_thread(void *arg)
+{
+	struct xf_loopback *lb = arg;
+	xf_proxy_msg_t m;
+	ssize_t r;
+
+	/* ...runs until the proxy side of the socket is closed */
+	while ((r = read(lb->fd, &m, sizeof(m))) != 0) {
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (r == sizeof(m))
+			xf_loopback_command(lb, &m);
+	}
+
+	return NULL;
+}
+
+int xf_loopback_open(struct xf_proxy_ipc_data *ipc)
+{
+	struct xf_loopback *lb;
+	int sv[2];
+
+	lb = calloc(1, sizeof(*lb));
+	if (!lb)
+		return -ENOMEM;
+
+	lb->shmem_size = XF_LOOPBACK_SHMEM_SIZE;
+	lb->shmem = mmap(NULL, lb->shmem_size, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (lb->shmem == MAP_FAILED)
+		goto err_free;
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv))
+		goto err_unmap;
+
+	/* ...proxy end reads without blocking, like the rpmsg endpoint */
+	fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+	lb->fd = sv[1];
+
+	if (pthread_create(&lb->thread, NULL, xf_loopback_thread, lb)) {
+		close(sv[0]);
+		close(sv[1]);
+		goto err_unmap;
+	}
+
+	ipc->fd = sv[0];
+	ipc->fd_mem = -1;
+	ipc->shmem = lb->shmem;
+	ipc->shmem_size = lb->shmem_size;
+	ipc->loopback = lb;
+
+	TRACE(INFO, _b("loopback DSP opened"));
+
+	return 0;
+
+err_unmap:
+	munmap(lb->shmem, lb->shmem_size);
+err_free:
+	free(lb);
+	return -ENODEV;
+}
+
+void xf_loopback_close(struct xf_proxy_ipc_data *ipc)
+{
+	struct xf_loopback *lb = ipc->loopback;
+	struct xf_loopback_block *b;
+
+	/* ...end of file stops the DSP thread */
+	close(ipc->fd);
+	pthread_join(lb->thread, NULL);
+	close(lb->fd);
+
+	while ((b = lb->blocks) != NULL) {
+		lb->blocks = b->next;
+		free(b);
+	}
+
+	munmap(lb->shmem, lb->shmem_size);
+	free(lb);
+	ipc->loopback = NULL;
+}
@@ -57,7 +57,8 @@ struct dpu_lib_stat_t {
 
 void *dpu_process_init_pi_lib(xtlib_pil_info *pil_info,
 			      struct dpu_lib_stat_t *lib_stat,
-			      UWORD32 byteswap);
+			      UWORD32 byteswap,
+			      UWORD32 code_shared);
 void dpu_process_unload_pi_lib(struct dpu_lib_stat_t *lib_stat);
 
 #endif
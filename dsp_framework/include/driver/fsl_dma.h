@@ -10,9 +10,13 @@
 
 #include "mydefs.h"
 
+/* ...longest descriptor chain a cyclic audio channel may use */
+#define DMA_MAX_PERIOD_COUNT  8
+
 typedef enum {
 	DMATYPE_SDMA = 0,
 	DMATYPE_EDMA,
+	DMATYPE_SIM,
 } dma_type_t;
 
 typedef enum {
@@ -90,6 +94,7 @@ typedef struct dma_device {
 	int              (*chan_config)(dmac_t *dma_chan, dmac_cfg_t *dma_trans_config);
 	int              (*chan_start)(dmac_t *dma_chan);
 	int              (*chan_stop)(dmac_t *dma_chan);
+	int              (*chan_set_period_addr)(dmac_t *dma_chan, int period, void *addr);
 } dma_t;
 
 void dma_probe(struct dsp_main_struct *dsp);
@@ -105,6 +110,7 @@ dmac_t *request_dma_chan(void *p_dma, int dev_type);
 void release_dma_chan(dmac_t *p_dma_ch);
 int dma_chan_start(dmac_t *p_dma_ch);
 int dma_chan_stop(dmac_t *p_dma_ch);
+int dma_chan_set_period_addr(dmac_t *p_dma_ch, int period, void *addr);
 int dma_chan_config(dmac_t *p_dma_ch, dmac_cfg_t *p_config);
 
 #endif
@@ -0,0 +1,66 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * sim_audio.h - simulated audio device and DMA
+ *
+ * Runs the FSL renderer and capturer without an audio board (build with
+ * SIM_DEVICE=1).
+ *
+ * A host timer stands in for the device clock and fires once per DMA
+ * period. On every tick the DMA moves a whole period between memory and
+ * the device, which plays it into a file or a memory ring, or records it
+ * from one. The clock can run off its nominal rate by a given ppm.
+ */
+
+#ifndef _SIM_AUDIO_H
+#define _SIM_AUDIO_H
+
+#include <stdio.h>
+
+#include "fsl_dma.h"
+
+/* ...device FIFO register first, so the device address is its FIFO address */
+struct sim_audio_dev {
+	volatile u32     fifo;
+
+	int              tx;
+	int              started;
+	int              channels;
+	int              rate;
+	int              width;
+
+	/* ...clock error in parts per million, positive runs fast */
+	int              drift_ppm;
+
+	/* ...file sink or source, a source loops at its end */
+	FILE             *file;
+
+	/* ...memory ring sink or source, used when there is no file */
+	unsigned char    *mem;
+	unsigned int     mem_len;
+	unsigned int     mem_pos;
+
+	/* ...frames played out or recorded */
+	unsigned long long frames;
+};
+
+/* ...device 1 is the playback one, device 0 the capture one */
+struct sim_audio_dev *sim_audio_get(int tx);
+
+int sim_audio_set_file(struct sim_audio_dev *dev, const char *path);
+void sim_audio_set_mem(struct sim_audio_dev *dev, void *buf, unsigned int len);
+void sim_audio_set_drift(struct sim_audio_dev *dev, int ppm);
+
+/* ...device hooks, same shape as the SAI ones; a NULL device does nothing */
+void sim_audio_init(volatile void *dev_addr, int mode, int channel, int rate, int width, int mclk_rate);
+void sim_audio_start(volatile void *dev_addr, int tx);
+void sim_audio_stop(volatile void *dev_addr, int tx);
+void sim_audio_irq_handler(volatile void *dev_addr);
+void sim_audio_suspend(volatile void *dev_addr, u32 *cache_addr);
+void sim_audio_resume(volatile void *dev_addr, u32 *cache_addr);
+int sim_audio_hw_params(volatile void *dev_addr, int channels, int rate, int format, volatile void *context);
+
+dma_t *sim_dma_probe();
+
+#endif
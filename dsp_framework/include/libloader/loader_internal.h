@@ -73,6 +73,9 @@ xtlib_user_memset (xt_ptr s, int c, unsigned int n, void *user);
 int
 xtlib_relocate_pi_lib (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals);
 
+int
+xtlib_relocate_pi_lib_data (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals);
+
 #endif
 
 #endif
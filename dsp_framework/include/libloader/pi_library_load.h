@@ -72,6 +72,10 @@ void *
 xtlib_target_init_pi_library_s(xtlib_pil_info *lib_info,
 			       xtlib_loader_globals *xtlib_globals);
 
+void *
+xtlib_target_init_shared_pi_library_s(xtlib_pil_info *lib_info,
+				      xtlib_loader_globals *xtlib_globals);
+
 void
 xtlib_unload_pi_library(xtlib_pil_info *lib_info);
 
@@ -77,7 +77,7 @@
 #define EDMA_TCD_CSR_ACTIVE             BIT(6)
 #define EDMA_TCD_CSR_DONE               BIT(7)
 
-#define MAX_PERIOD_COUNT  8
+#define MAX_PERIOD_COUNT  DMA_MAX_PERIOD_COUNT
 
 #define MAX_EDMA_CHANNELS 32
 
@@ -458,6 +458,8 @@ int edma_chan_config(dmac_t *dma_chan, dmac_cfg_t *dmac_cfg)
 	edmac_t *edmac = NULL;
 	if (!dma_chan)
 		return -EINVAL;
+	if (dmac_cfg->period_count < 1 || dmac_cfg->period_count > MAX_PERIOD_COUNT)
+		return -EINVAL;
 
 	dma_chan->direction = dmac_cfg->direction;
 	dma_chan->src_addr = dmac_cfg->src_addr;
@@ -548,6 +550,31 @@ int edma_chan_stop(dmac_t *dma_chan)
 	return 0;
 }
 
+int edma_chan_set_period_addr(dmac_t *dma_chan, int period, void *addr)
+{
+	edmac_t *edmac = NULL;
+	tcd_t *tcd;
+	if (!dma_chan)
+		return -EINVAL;
+	edmac = (edmac_t *)dma_chan;
+	if (!edmac->tcd_align32)
+		return -EINVAL;
+
+	tcd = &((tcd_t *)edmac->tcd_align32)[period];
+	if (dma_chan->direction == DMA_DEV_TO_MEM)
+		tcd->daddr = (u32)addr;
+	else if (dma_chan->direction == DMA_MEM_TO_DEV)
+		tcd->saddr = (u32)addr;
+	else
+		return -EINVAL;
+
+	/* ...the first tcd is already loaded into an idle channel, reload it */
+	if (period == 0 && !(read32(edmac->membase + EDMA_CH_CSR) & EDMA_CH_CSR_ERQ))
+		edma_set_tcd(edmac->membase, edmac->tcd_align32);
+
+	return 0;
+}
+
 int edma_chan_probe(edma_t *edma)
 {
 	int idx;
@@ -589,6 +616,7 @@ dma_t *edma_probe()
 	fsl_edma->dma.chan_config  = edma_chan_config;
 	fsl_edma->dma.chan_start   = edma_chan_start;
 	fsl_edma->dma.chan_stop    = edma_chan_stop;
+	fsl_edma->dma.chan_set_period_addr = edma_chan_set_period_addr;
 
 	edma_chan_probe(fsl_edma);
 
@@ -8,6 +8,8 @@
 #include "fsl_dma.h"
 
 #include "sdma.h"
+#include "edma.h"
+#include "sim_audio.h"
 
 void dma_probe(struct dsp_main_struct *dsp)
 {
@@ -17,10 +19,14 @@ void dma_probe(struct dsp_main_struct *dsp)
 	if (dsp->dma_device)
 		return;
 
+#ifdef SIM_DEVICE
+	dma = (void *)sim_dma_probe();
+#else
 	if (board_type == DSP_IMX8MP_TYPE)
 		dma = (void *)sdma_probe();
 	else
 		dma = (void *)edma_probe();
+#endif
 
 	dsp->dma_device = dma;
 }
@@ -113,6 +119,20 @@ int dma_chan_stop(dmac_t *p_dma_ch)
 	return dma->chan_stop(p_dma_ch);
 }
 
+/* ...point the memory end of one period of a cyclic channel at a new buffer;
+ * only safe for a period the channel is not transferring */
+int dma_chan_set_period_addr(dmac_t *p_dma_ch, int period, void *addr)
+{
+	if (!p_dma_ch || !addr)
+		return -EINVAL;
+	if (period < 0 || period >= p_dma_ch->period_count)
+		return -EINVAL;
+	dma_t *dma = (dma_t *)p_dma_ch->dma_device;
+	if (!dma || !dma->chan_set_period_addr)
+		return -EINVAL;
+	return dma->chan_set_period_addr(p_dma_ch, period, addr);
+}
+
 int dma_chan_config(dmac_t *p_dma_ch, dmac_cfg_t *p_config)
 {
 	if (!p_dma_ch || !p_config)
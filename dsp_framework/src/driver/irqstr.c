@@ -8,6 +8,10 @@
 #include "debug.h"
 
 void irqstr_init(volatile void *irqstr_addr, int dev_Int, int dma_Int) {
+	/* ...simulated devices have no steer */
+	if (!irqstr_addr)
+		return;
+
 #ifndef PLATF_8M
 	write32_bit(irqstr_addr + IRQSTEER_CHnMASK(IRQ_TO_MASK_OFFSET(dev_Int + 32)),
 			1 << IRQ_TO_MASK_SHIFT(dev_Int + 32),
@@ -19,6 +23,9 @@ void irqstr_init(volatile void *irqstr_addr, int dev_Int, int dma_Int) {
 }
 
 void irqstr_start(volatile void *irqstr_addr, int dev_Int, int dma_Int) {
+	if (!irqstr_addr)
+		return;
+
 #ifndef PLATF_8M
 	write32(irqstr_addr + IRQSTEER_CHnCTL, 0x1);
 #else
@@ -32,6 +39,9 @@ void irqstr_start(volatile void *irqstr_addr, int dev_Int, int dma_Int) {
 }
 
 void irqstr_stop(volatile void *irqstr_addr, int dev_Int, int dma_Int) {
+	if (!irqstr_addr)
+		return;
+
 #ifndef PLATF_8M
 	write32(irqstr_addr + IRQSTEER_CHnCTL, 0x0);
 #else
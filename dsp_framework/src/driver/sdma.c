@@ -622,6 +622,8 @@ static int load_channel(dmac_t *dmac)
 	int type = dmac->direction;
 	void *src_addr = dmac->src_addr, *dest_addr = dmac->dest_addr;
 	int period_len = dmac->period_len;
+	int period_count = dmac->period_count;
+	int i;
 
 	int channel = sdmac->channel_id;
 	int ch_watermark = sdmac_cfg->watermark;
@@ -701,19 +703,17 @@ static int load_channel(dmac_t *dmac)
 	sdma_event_enable(sdma, event2, channel, done_cfg);
 
 	if (type == DMA_MEM_TO_DEV) {
-		sdma_channel_attach_bd(sdma, channel, 2);
-		/* set 2 bds for transmite data */
-		bd1 = sdmac->bd;
-		bd1->mode.command = 2;
-		bd1->mode.status = BD_DONE | BD_INTR | BD_CONT;
-		bd1->mode.count = period_len;
-		bd1->buffer_addr = (unsigned int)src_addr;
-
-		bd1 = &bd1[1];
-		bd1->mode.command = 2;
-		bd1->mode.status = BD_DONE | BD_WRAP | BD_CONT + BD_INTR;
-		bd1->mode.count = period_len;
-		bd1->buffer_addr = (unsigned int)(src_addr + period_len);
+		sdma_channel_attach_bd(sdma, channel, period_count);
+		/* set one bd per period for transmite data, the last one wraps */
+		for (i = 0; i < period_count; i++) {
+			bd1 = &sdmac->bd[i];
+			bd1->mode.command = 2;
+			bd1->mode.status = BD_DONE | BD_INTR | BD_CONT;
+			if (i == period_count - 1)
+				bd1->mode.status |= BD_WRAP;
+			bd1->mode.count = period_len;
+			bd1->buffer_addr = (unsigned int)(src_addr + i * period_len);
+		}
 	} else if (type == DMA_DEV_TO_DEV) {
 		sdma_channel_attach_bd(sdma, channel, 1);
 		bd1 = sdmac->bd;
@@ -722,19 +722,17 @@ static int load_channel(dmac_t *dmac)
 		bd1->mode.status = BD_DONE | BD_WRAP | BD_CONT;
 		bd1->mode.count = 64;
 	} else if (type == DMA_DEV_TO_MEM) {
-		sdma_channel_attach_bd(sdma, channel, 2);
-		/* set 2 bds for transmite data */
-		bd1 = sdmac->bd;
-		bd1->mode.command = 0;
-		bd1->mode.status = BD_DONE | BD_INTR | BD_CONT | BD_EXTD;
-		bd1->mode.count = period_len;
-		bd1->buffer_addr = (unsigned int)dest_addr;
-
-		bd1 = &bd1[1];
-		bd1->mode.command = 0;
-		bd1->mode.status = BD_DONE | BD_INTR | BD_CONT | BD_EXTD | BD_WRAP;
-		bd1->mode.count = period_len;
-		bd1->buffer_addr = (unsigned int)(dest_addr + period_len);
+		sdma_channel_attach_bd(sdma, channel, period_count);
+		/* set one bd per period for receive data, the last one wraps */
+		for (i = 0; i < period_count; i++) {
+			bd1 = &sdmac->bd[i];
+			bd1->mode.command = 0;
+			bd1->mode.status = BD_DONE | BD_INTR | BD_CONT | BD_EXTD;
+			if (i == period_count - 1)
+				bd1->mode.status |= BD_WRAP;
+			bd1->mode.count = period_len;
+			bd1->buffer_addr = (unsigned int)(dest_addr + i * period_len);
+		}
 	}
 
 	sdma_disable_channel(sdma, channel);
@@ -771,6 +769,9 @@ int sdma_chan_config(dmac_t *dma_chan, dmac_cfg_t *dmac_cfg)
 	struct sdma_chan *sdmac = (struct sdma_chan *)dma_chan;
 	sdmac_cfg_t *sdmac_cfg;
 
+	if (dmac_cfg->period_count < 1 || dmac_cfg->period_count > DMA_MAX_PERIOD_COUNT)
+		return -1;
+
 	dma_chan->direction = dmac_cfg->direction;
 	dma_chan->src_addr = dmac_cfg->src_addr;
 	dma_chan->dest_addr = dmac_cfg->dest_addr;
@@ -779,6 +780,7 @@ int sdma_chan_config(dmac_t *dma_chan, dmac_cfg_t *dmac_cfg)
 	dma_chan->src_width = dmac_cfg->src_width;
 	dma_chan->dest_width = dmac_cfg->dest_width;
 	dma_chan->period_len = dmac_cfg->period_len;
+	dma_chan->period_count = dmac_cfg->period_count;
 	dma_chan->callback = dmac_cfg->callback;
 	dma_chan->comp = dmac_cfg->comp;
 
@@ -790,6 +792,19 @@ int sdma_chan_config(dmac_t *dma_chan, dmac_cfg_t *dmac_cfg)
 	return 0;
 }
 
+int sdma_chan_set_period_addr(dmac_t *dma_chan, int period, void *addr)
+{
+	struct sdma_chan *sdmac = (struct sdma_chan *)dma_chan;
+
+	/* ...dev to dev channels have no memory end to move */
+	if (!sdmac->bd || period >= sdmac->bdnum || dma_chan->direction == DMA_DEV_TO_DEV)
+		return -1;
+
+	/* ...the bd keeps its ownership and count, only the buffer moves */
+	sdmac->bd[period].buffer_addr = (unsigned int)addr;
+	return 0;
+}
+
 int sdma_chan_start(dmac_t *dma_chan)
 {
 	struct sdma_chan *sdmac = (struct sdma_chan *)dma_chan;
@@ -1083,6 +1098,7 @@ dma_t *sdma_probe()
 	fsl_sdma->dma.chan_config  = sdma_chan_config;
 	fsl_sdma->dma.chan_start   = sdma_chan_start;
 	fsl_sdma->dma.chan_stop    = sdma_chan_stop;
+	fsl_sdma->dma.chan_set_period_addr = sdma_chan_set_period_addr;
 	return (dma_t *)fsl_sdma;
 }
 
@@ -0,0 +1,448 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * sim_audio.c - simulated audio device and DMA
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include "osal-timer.h"
+
+#include "sim_audio.h"
+#include "mydefs.h"
+
+#include "debug.h"
+
+#ifndef SIM_DEVICE_DRIFT_PPM
+#define SIM_DEVICE_DRIFT_PPM    0
+#endif
+
+#define MAX_SIM_DMA_CHANNELS    4
+
+typedef struct {
+	dmac_t                  dmac;
+	int                     busy;
+	int                     running;
+	int                     period;
+	struct sim_audio_dev    *dev;
+	void                    *period_addr[DMA_MAX_PERIOD_COUNT];
+	xf_timer_t              timer;
+} sim_dmac_t;
+
+typedef struct {
+	dma_t                   dma;
+	sim_dmac_t              chan[MAX_SIM_DMA_CHANNELS];
+	int                     init_done;
+} sim_dma_t;
+
+static struct sim_audio_dev sim_audio_devs[2] = {
+	{ .tx = 0, .drift_ppm = SIM_DEVICE_DRIFT_PPM },
+	{ .tx = 1, .drift_ppm = SIM_DEVICE_DRIFT_PPM },
+};
+
+static sim_dma_t sim_dma;
+
+/*******************************************************************************
+ * Device
+ ******************************************************************************/
+
+struct sim_audio_dev *sim_audio_get(int tx)
+{
+	return &sim_audio_devs[tx ? 1 : 0];
+}
+
+int sim_audio_set_file(struct sim_audio_dev *dev, const char *path)
+{
+	if (dev->file)
+		fclose(dev->file);
+	dev->file = NULL;
+
+	if (!path)
+		return 0;
+
+	dev->file = fopen(path, dev->tx ? "wb" : "rb");
+	if (!dev->file) {
+		LOG1("sim audio: cannot open %s\n", path);
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+void sim_audio_set_mem(struct sim_audio_dev *dev, void *buf, unsigned int len)
+{
+	dev->mem = buf;
+	dev->mem_len = buf ? len : 0;
+	dev->mem_pos = 0;
+}
+
+void sim_audio_set_drift(struct sim_audio_dev *dev, int ppm)
+{
+	/* ...picked up by the next DMA start */
+	dev->drift_ppm = ppm;
+}
+
+void sim_audio_init(volatile void *dev_addr, int mode, int channel, int rate, int width, int mclk_rate)
+{
+	struct sim_audio_dev *dev = (struct sim_audio_dev *)dev_addr;
+
+	if (!dev)
+		return;
+
+	dev->channels = channel;
+	dev->rate = rate;
+	dev->width = width;
+	dev->started = 0;
+	dev->frames = 0;
+	dev->mem_pos = 0;
+
+#ifdef SIM_DEVICE_TX_FILE
+	if (dev->tx && !dev->file)
+		sim_audio_set_file(dev, SIM_DEVICE_TX_FILE);
+#endif
+#ifdef SIM_DEVICE_RX_FILE
+	if (!dev->tx && !dev->file)
+		sim_audio_set_file(dev, SIM_DEVICE_RX_FILE);
+#endif
+}
+
+void sim_audio_start(volatile void *dev_addr, int tx)
+{
+	struct sim_audio_dev *dev = (struct sim_audio_dev *)dev_addr;
+
+	if (dev)
+		dev->started = 1;
+}
+
+void sim_audio_stop(volatile void *dev_addr, int tx)
+{
+	struct sim_audio_dev *dev = (struct sim_audio_dev *)dev_addr;
+
+	if (!dev)
+		return;
+
+	dev->started = 0;
+	if (dev->file && dev->tx)
+		fflush(dev->file);
+}
+
+void sim_audio_irq_handler(volatile void *dev_addr)
+{
+}
+
+void sim_audio_suspend(volatile void *dev_addr, u32 *cache_addr)
+{
+	sim_audio_stop(dev_addr, 0);
+}
+
+void sim_audio_resume(volatile void *dev_addr, u32 *cache_addr)
+{
+	sim_audio_start(dev_addr, 0);
+}
+
+int sim_audio_hw_params(volatile void *dev_addr, int channels, int rate, int format, volatile void *context)
+{
+	return 0;
+}
+
+/* ...play one period out of buf */
+static void sim_audio_write(struct sim_audio_dev *dev, void *buf, unsigned int len)
+{
+	unsigned int n;
+
+	if (dev->file) {
+		fwrite(buf, 1, len, dev->file);
+	} else if (dev->mem) {
+		while (len) {
+			n = dev->mem_len - dev->mem_pos;
+			if (n > len)
+				n = len;
+			memcpy(dev->mem + dev->mem_pos, buf, n);
+			buf = (unsigned char *)buf + n;
+			len -= n;
+			dev->mem_pos = (dev->mem_pos + n) % dev->mem_len;
+		}
+	}
+}
+
+/* ...record one period into buf; silence when there is no source */
+static void sim_audio_read(struct sim_audio_dev *dev, void *buf, unsigned int len)
+{
+	unsigned int n;
+
+	if (dev->file) {
+		while (len) {
+			n = fread(buf, 1, len, dev->file);
+			if (n == 0) {
+				/* ...loop the source; give up on an empty file */
+				rewind(dev->file);
+				if (fread(buf, 1, 1, dev->file) != 1)
+					break;
+				n = 1;
+			}
+			buf = (unsigned char *)buf + n;
+			len -= n;
+		}
+	} else if (dev->mem) {
+		while (len) {
+			n = dev->mem_len - dev->mem_pos;
+			if (n > len)
+				n = len;
+			memcpy(buf, dev->mem + dev->mem_pos, n);
+			buf = (unsigned char *)buf + n;
+			len -= n;
+			dev->mem_pos = (dev->mem_pos + n) % dev->mem_len;
+		}
+	}
+
+	if (len)
+		memset(buf, 0, len);
+}
+
+/*******************************************************************************
+ * DMA
+ ******************************************************************************/
+
+/* ...one period of the device clock has passed */
+static void sim_dma_period(void *arg)
+{
+	sim_dmac_t *sdmac = arg;
+	dmac_t *dmac = &sdmac->dmac;
+	struct sim_audio_dev *dev = sdmac->dev;
+	void *buf = sdmac->period_addr[sdmac->period];
+
+	/* ...a stopped device does not pull or push data */
+	if (!sdmac->running || !dev->started)
+		return;
+
+	if (dmac->direction == DMA_MEM_TO_DEV)
+		sim_audio_write(dev, buf, dmac->period_len);
+	else
+		sim_audio_read(dev, buf, dmac->period_len);
+
+	dev->frames += dmac->period_len / (dev->channels * (dev->width >> 3));
+	sdmac->period = (sdmac->period + 1) % dmac->period_count;
+
+	if (dmac->callback)
+		dmac->callback(dmac->comp);
+}
+
+/* ...period length in cycles of the drifting device clock */
+static unsigned long sim_dma_period_cycles(sim_dmac_t *sdmac)
+{
+	struct sim_audio_dev *dev = sdmac->dev;
+	unsigned long long frames;
+
+	frames = sdmac->dmac.period_len / (dev->channels * (dev->width >> 3));
+
+	return (unsigned long)(frames * xos_get_clock_freq() * 1000000ULL /
+			       ((unsigned long long)dev->rate * (1000000 + dev->drift_ppm)));
+}
+
+static int sim_dma_get_para(struct dma_device *dev, dmac_t *dmac, int para, void *value)
+{
+	if (!dev || !dmac)
+		return -EINVAL;
+
+	/* ...no interrupt lines, periods are signalled by the timer */
+	*(int *)value = 0;
+
+	return 0;
+}
+
+static int sim_dma_init(struct dma_device *dev)
+{
+	sim_dma_t *sdma = (sim_dma_t *)dev;
+
+	if (!dev)
+		return -EINVAL;
+
+	sdma->init_done = 1;
+
+	return 0;
+}
+
+static void sim_dma_release(struct dma_device *dev)
+{
+	sim_dma_t *sdma = (sim_dma_t *)dev;
+	int idx;
+
+	if (!dev)
+		return;
+
+	for (idx = 0; idx < MAX_SIM_DMA_CHANNELS; idx++)
+		if (sdma->chan[idx].busy)
+			return;
+
+	sdma->init_done = 0;
+}
+
+static int sim_dma_irq_handler(struct dma_device *dev)
+{
+	return 0;
+}
+
+static int sim_dma_suspend(struct dma_device *dev)
+{
+	sim_dma_t *sdma = (sim_dma_t *)dev;
+	int idx;
+
+	if (!dev)
+		return -EINVAL;
+
+	for (idx = 0; idx < MAX_SIM_DMA_CHANNELS; idx++)
+		if (sdma->chan[idx].running)
+			xos_timer_stop(&sdma->chan[idx].timer.timer);
+
+	return 0;
+}
+
+static int sim_dma_resume(struct dma_device *dev)
+{
+	sim_dma_t *sdma = (sim_dma_t *)dev;
+	int idx;
+
+	if (!dev)
+		return -EINVAL;
+
+	for (idx = 0; idx < MAX_SIM_DMA_CHANNELS; idx++) {
+		sim_dmac_t *sdmac = &sdma->chan[idx];
+		if (sdmac->running)
+			__xf_timer_start(&sdmac->timer, sim_dma_period_cycles(sdmac));
+	}
+
+	return 0;
+}
+
+static dmac_t *request_sim_dma_chan(struct dma_device *dev, int dev_type)
+{
+	sim_dma_t *sdma = (sim_dma_t *)dev;
+	int idx;
+
+	if (!dev)
+		return NULL;
+
+	for (idx = 0; idx < MAX_SIM_DMA_CHANNELS; idx++) {
+		sim_dmac_t *sdmac = &sdma->chan[idx];
+		if (!sdmac->busy) {
+			memset(sdmac, 0, sizeof(*sdmac));
+			sdmac->busy = 1;
+			sdmac->dmac.dma_device = dev;
+			__xf_timer_init(&sdmac->timer, sim_dma_period, sdmac, 1);
+			return &sdmac->dmac;
+		}
+	}
+
+	return NULL;
+}
+
+static void release_sim_dma_chan(dmac_t *dmac)
+{
+	sim_dmac_t *sdmac = (sim_dmac_t *)dmac;
+
+	/* ...always unlink, a stopped timer may still be listed */
+	__xf_timer_stop(&sdmac->timer);
+	__xf_timer_destroy(&sdmac->timer);
+	sdmac->running = 0;
+	sdmac->busy = 0;
+}
+
+static int sim_dma_chan_config(dmac_t *dmac, dmac_cfg_t *cfg)
+{
+	sim_dmac_t *sdmac = (sim_dmac_t *)dmac;
+	unsigned char *mem;
+	int i;
+
+	/* ...only memory to device and back, there is no front end to chain */
+	if (cfg->direction != DMA_MEM_TO_DEV && cfg->direction != DMA_DEV_TO_MEM)
+		return -EINVAL;
+	if (cfg->period_count < 1 || cfg->period_count > DMA_MAX_PERIOD_COUNT)
+		return -EINVAL;
+
+	dmac->direction    = cfg->direction;
+	dmac->src_addr     = cfg->src_addr;
+	dmac->dest_addr    = cfg->dest_addr;
+	dmac->period_len   = cfg->period_len;
+	dmac->period_count = cfg->period_count;
+	dmac->callback     = cfg->callback;
+	dmac->comp         = cfg->comp;
+
+	if (cfg->direction == DMA_MEM_TO_DEV) {
+		sdmac->dev = (struct sim_audio_dev *)cfg->dest_addr;
+		mem = cfg->src_addr;
+	} else {
+		sdmac->dev = (struct sim_audio_dev *)cfg->src_addr;
+		mem = cfg->dest_addr;
+	}
+	if (!sdmac->dev)
+		return -EINVAL;
+
+	for (i = 0; i < cfg->period_count; i++)
+		sdmac->period_addr[i] = mem + i * cfg->period_len;
+	sdmac->period = 0;
+
+	return 0;
+}
+
+static int sim_dma_chan_start(dmac_t *dmac)
+{
+	sim_dmac_t *sdmac = (sim_dmac_t *)dmac;
+	struct sim_audio_dev *dev = sdmac->dev;
+
+	if (!dev || !dev->rate || !dev->channels || !dev->width)
+		return -EINVAL;
+
+	sdmac->running = 1;
+
+	return __xf_timer_start(&sdmac->timer, sim_dma_period_cycles(sdmac));
+}
+
+static int sim_dma_chan_stop(dmac_t *dmac)
+{
+	sim_dmac_t *sdmac = (sim_dmac_t *)dmac;
+
+	if (!sdmac->running)
+		return 0;
+
+	sdmac->running = 0;
+
+	/* ...the renderer stops on underrun from inside the period callback,
+	 * where the timer list is locked; leave the timer listed, a restart
+	 * or the channel release takes care of it */
+	return xos_timer_stop(&sdmac->timer.timer);
+}
+
+static int sim_dma_chan_set_period_addr(dmac_t *dmac, int period, void *addr)
+{
+	sim_dmac_t *sdmac = (sim_dmac_t *)dmac;
+
+	sdmac->period_addr[period] = addr;
+
+	return 0;
+}
+
+dma_t *sim_dma_probe()
+{
+	sim_dma_t *sdma = &sim_dma;
+
+	memset(sdma, 0, sizeof(sim_dma_t));
+
+	sdma->dma.dma_type     = DMATYPE_SIM;
+	sdma->dma.get_para     = sim_dma_get_para;
+	sdma->dma.init         = sim_dma_init;
+	sdma->dma.release      = sim_dma_release;
+	sdma->dma.irq_handler  = sim_dma_irq_handler;
+	sdma->dma.suspend      = sim_dma_suspend;
+	sdma->dma.resume       = sim_dma_resume;
+
+	sdma->dma.request_dma_chan = request_sim_dma_chan;
+	sdma->dma.release_dma_chan = release_sim_dma_chan;
+	sdma->dma.chan_config  = sim_dma_chan_config;
+	sdma->dma.chan_start   = sim_dma_chan_start;
+	sdma->dma.chan_stop    = sim_dma_chan_stop;
+	sdma->dma.chan_set_period_addr = sim_dma_chan_set_period_addr;
+
+	return (dma_t *)sdma;
+}
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include "dpu_lib_load.h"
+#include "pi_library_load.h"
 
 enum sram_data_type_t {
 	DTYP_DPUSW = 0,
@@ -45,7 +46,8 @@ struct dpu_data_t {
 
 void *dpu_process_init_pi_lib(xtlib_pil_info *pil_info,
 			      struct dpu_lib_stat_t *lib_stat,
-			      UWORD32 byteswap)
+			      UWORD32 byteswap,
+			      UWORD32 code_shared)
 {
 	xtlib_loader_globals xtlib_globals = {0, 0};
 	UWORD32 (*plib_entry_func)() = 0;
@@ -56,9 +58,15 @@ void *dpu_process_init_pi_lib(xtlib_pil_info *pil_info,
 	memcpy((char *)&lib_stat->pil_inf_dspLib_dpu,
 	       (char *)pil_info,
 	       sizeof(xtlib_pil_info));
-	plib_entry_func =
-	(void *)xtlib_target_init_pi_library_s(&lib_stat->pil_inf_dspLib_dpu,
-				&xtlib_globals);
+	/* shared code is already relocated by the instance which loaded it */
+	if (code_shared)
+		plib_entry_func =
+		(void *)xtlib_target_init_shared_pi_library_s(&lib_stat->pil_inf_dspLib_dpu,
+					&xtlib_globals);
+	else
+		plib_entry_func =
+		(void *)xtlib_target_init_pi_library_s(&lib_stat->pil_inf_dspLib_dpu,
+					&xtlib_globals);
 	LOG1("xtlib_target_init_pi_library, %x\n", plib_entry_func);
 
 	//get the codec_api_function
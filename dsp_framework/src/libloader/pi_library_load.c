@@ -489,6 +489,22 @@ xtlib_target_init_pi_library_s (xtlib_pil_info * lib_info, xtlib_loader_globals
   return lib_info->start_sym;
 }
 
+void *
+xtlib_target_init_shared_pi_library_s (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals)
+{
+  int err = xtlib_relocate_pi_lib_data (lib_info, xtlib_globals);
+  if (err != XTLIB_NO_ERR) {
+    xtlib_globals->err = err;
+    return 0;
+  }
+
+  xtlib_sync ();
+
+  ((void (*)(void))(lib_info->init))();
+
+  return lib_info->start_sym;
+}
+
 void
 xtlib_unload_pi_library(xtlib_pil_info * lib_info)
 {
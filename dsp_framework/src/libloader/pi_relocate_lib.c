@@ -230,8 +230,9 @@ reloc_addr (const xtlib_pil_info * lib_info, Elf32_Addr addr)
     + addr;
 }
 
-int
-xtlib_relocate_pi_lib (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals)
+static int
+xtlib_relocate_pi_lib_common (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals,
+			      int data_only)
 {
   int i;
   Elf32_Rela * relocations = (Elf32_Rela *) lib_info->rel;
@@ -240,6 +241,10 @@ xtlib_relocate_pi_lib (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_gl
     Elf32_Rela * rela = &relocations[i];
     Elf32_Word r_type;
 
+    /* code section is shared and already relocated */
+    if (data_only && rela->r_offset < (Elf32_Addr)lib_info->src_data_offs)
+      continue;
+
     if (ELF32_R_SYM(rela->r_info) != STN_UNDEF) {
       xtlib_globals->err = XTLIB_UNKNOWN_SYMBOL;
       return XTLIB_UNKNOWN_SYMBOL;
@@ -288,3 +293,15 @@ xtlib_relocate_pi_lib (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_gl
   }
   return XTLIB_NO_ERR;
 }
+
+int
+xtlib_relocate_pi_lib (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals)
+{
+  return xtlib_relocate_pi_lib_common (lib_info, xtlib_globals, 0);
+}
+
+int
+xtlib_relocate_pi_lib_data (xtlib_pil_info * lib_info, xtlib_loader_globals *xtlib_globals)
+{
+  return xtlib_relocate_pi_lib_common (lib_info, xtlib_globals, 1);
+}
@@ -52,6 +52,7 @@
  * Includes
  ******************************************************************************/
 #include "osal-timer.h"
+#include "osal-isr.h"
 #include <stdio.h>
 #include "audio/xa-capturer-api.h"
 #include "xf-debug.h"
@@ -66,6 +67,9 @@ extern clk_t capturer_cycles;
 #include "hardware.h"
 #include "fsl_dma.h"
 #include "dsp_irq_handler.h"
+#ifdef SIM_DEVICE
+#include "sim_audio.h"
+#endif
 
 #include "debug.h"
 
@@ -82,6 +86,13 @@ extern clk_t capturer_cycles;
 /* minimum allowed framesize in bytes per channel */
 #define MIN_FRAME_SIZE_IN_BYTES    ( 128 )
 
+/* default number of periods in the DMA ring */
+#define DEFAULT_PERIOD_COUNT       ( 2 )
+
+/* zero-copy rings; power of two, the pool holds every output buffer of the port */
+#define ZC_POOL_SIZE               ( 16 )
+#define ZC_DONE_SIZE               ( 2 * ZC_POOL_SIZE )
+
 
 /*******************************************************************************
  * Local data definition
@@ -157,6 +168,40 @@ typedef struct XACapturer
 
     u32                   dev_Int;
     void                  *micfil;
+
+    /* ...capture device hooks, the MICFIL unless simulated */
+    void                  *dev_addr;
+    void                  (*dev_start)(volatile void *dev_addr, int tx);
+    void                  (*dev_stop)(volatile void *dev_addr, int tx);
+    void                  (*dev_suspend)(volatile void *dev_addr, u32 *cache_addr);
+    void                  (*dev_resume)(volatile void *dev_addr, u32 *cache_addr);
+
+    /* ...zero-copy mode: the DMA writes straight into output buffers */
+    UWORD32               zero_copy;
+
+    /* ...number of periods in the DMA ring */
+    UWORD32               period_count;
+
+    /* ...DMA period that completes next */
+    UWORD32               dma_period;
+
+    /* ...what to drop when the ring fills up */
+    UWORD32               overrun_policy;
+
+    /* ...overruns since init, and how many of them exec has reported */
+    UWORD32               overrun_count;
+    UWORD32               overrun_reported;
+
+    /* ...memory each DMA period currently writes to */
+    void                  *zc_armed[DMA_MAX_PERIOD_COUNT];
+
+    /* ...empty output buffers waiting for a DMA period */
+    void                  *zc_pool[ZC_POOL_SIZE];
+    UWORD32               zc_pool_rd, zc_pool_wr;
+
+    /* ...completed periods waiting for delivery, oldest first */
+    void                  *zc_done[ZC_DONE_SIZE];
+    UWORD32               zc_done_rd, zc_done_wr;
 }   XACapturer;
 
 #define MAX_UWORD32 ((UWORD64)0xFFFFFFFF)
@@ -179,20 +224,118 @@ void xa_capturer_callback(xa_capturer_cb_t *cdata, WORD32 i_idx);
 
 #define UPDATE_FW_READ(fw) { \
 	    fw += d->frame_size_bytes * d->channels; \
-	    if (fw >= (d->dma_buffer + d->frame_size_bytes * d->channels *2)) \
+	    if (fw >= (d->dma_buffer + d->frame_size_bytes * d->channels * d->period_count)) \
 		    fw = d->dma_buffer; \
 }
 
+/* ...scratch period of the internal ring, used when no output buffer is armed */
+static inline void *xa_hw_capturer_scratch(XACapturer *d, UWORD32 period)
+{
+	return (UWORD8 *)d->dma_buffer + period * d->frame_size_bytes * d->channels;
+}
+
+static inline int xa_hw_capturer_is_scratch(XACapturer *d, void *p)
+{
+	return (p >= d->dma_buffer &&
+		p < xa_hw_capturer_scratch(d, d->period_count));
+}
+
+/* ...point a DMA period at the next pooled output buffer, or at its scratch */
+static void xa_hw_capturer_arm(XACapturer *d, UWORD32 period)
+{
+	void *p;
+
+	if (d->zc_pool_rd != d->zc_pool_wr)
+		p = d->zc_pool[d->zc_pool_rd++ & (ZC_POOL_SIZE - 1)];
+	else
+		p = xa_hw_capturer_scratch(d, period);
+
+	if (p != d->zc_armed[period]) {
+		d->zc_armed[period] = p;
+		dma_chan_set_period_addr(d->dmac[0], period, p);
+	}
+}
+
+/* ...check if an output buffer is pooled, armed or holds undelivered data */
+static int xa_hw_capturer_zc_busy(XACapturer *d, void *p)
+{
+	UWORD32 i;
+
+	for (i = 0; i < d->period_count; i++)
+		if (d->zc_armed[i] == p)
+			return 1;
+	for (i = d->zc_pool_rd; i != d->zc_pool_wr; i++)
+		if (d->zc_pool[i & (ZC_POOL_SIZE - 1)] == p)
+			return 1;
+	for (i = d->zc_done_rd; i != d->zc_done_wr; i++)
+		if (d->zc_done[i & (ZC_DONE_SIZE - 1)] == p)
+			return 1;
+
+	return 0;
+}
+
+/* ...drop every zero-copy buffer and send all periods back to scratch */
+static void xa_hw_capturer_zc_reset(XACapturer *d)
+{
+	UWORD32 i;
+
+	d->zc_pool_rd = d->zc_pool_wr = 0;
+	d->zc_done_rd = d->zc_done_wr = 0;
+	for (i = 0; i < d->period_count; i++)
+		xa_hw_capturer_arm(d, i);
+}
+
+/* ...zero-copy period completion; runs in interrupt context */
+static void xa_hw_capturer_zc_callback(XACapturer *d)
+{
+	UWORD32 period = d->dma_period;
+	void *p = d->zc_armed[period];
+
+	d->dma_period = (period + 1) % d->period_count;
+
+	/* ...output buffers are never dropped, so they stay in order; scratch
+	 * data is dropped when the consumer is that far behind */
+	if (!xa_hw_capturer_is_scratch(d, p) ||
+	    d->zc_done_wr - d->zc_done_rd < ZC_DONE_SIZE - ZC_POOL_SIZE)
+		d->zc_done[d->zc_done_wr++ & (ZC_DONE_SIZE - 1)] = p;
+	else
+		d->overrun_count++;
+
+	/* ...the period comes round again only after all the others */
+	xa_hw_capturer_arm(d, period);
+
+	d->cdata->cb(d->cdata, 0);
+}
+
 static void xa_hw_capturer_callback(void *arg)
 {
 	XACapturer *d = arg;
-	u32     status;
+	UWORD32 payload = d->frame_size_bytes * d->channels;
 
-	d->fifo_avail = d->fifo_avail + (d->frame_size_bytes*d->channels);
+	if (d->zero_copy) {
+		xa_hw_capturer_zc_callback(d);
+		return;
+	}
 
-	if((d->fifo_avail) > (2 * d->frame_size_bytes * d->channels)) {
-		/*over run case*/
-		d->fifo_avail = 0;
+	d->dma_period = (d->dma_period + 1) % d->period_count;
+	d->fifo_avail = d->fifo_avail + payload;
+
+	if (d->fifo_avail > d->period_count * payload) {
+		/* ...over run: the period just completed overwrote the oldest
+		 * unread one, and the DMA is now writing into the next */
+		d->overrun_count++;
+		LOG1("isr over run %d\n", d->overrun_count);
+
+		if (d->overrun_policy == XA_CAPTURER_OVERRUN_NEWEST) {
+			/* ...keep every period the DMA is not touching */
+			d->fw = xa_hw_capturer_scratch(d, (d->dma_period + 1) % d->period_count);
+			d->fifo_avail = (d->period_count - 1) * payload;
+			d->cdata->cb(d->cdata, 0);
+		} else {
+			/* ...drop everything, resume with the period in flight */
+			d->fw = xa_hw_capturer_scratch(d, d->dma_period);
+			d->fifo_avail = 0;
+		}
 	} else if(((int)d-> fifo_avail) < 0) {
 		/* under run */
 		d->fifo_avail = 0;
@@ -202,6 +345,29 @@ static void xa_hw_capturer_callback(void *arg)
 }
 
 
+#ifndef SIM_DEVICE
+/* ...MICFIL behind the device hooks */
+static void xa_hw_micfil_start(volatile void *dev_addr, int tx)
+{
+	micfil_start((void *)dev_addr);
+}
+
+static void xa_hw_micfil_stop(volatile void *dev_addr, int tx)
+{
+	micfil_stop((void *)dev_addr);
+}
+
+static void xa_hw_micfil_suspend(volatile void *dev_addr, u32 *cache_addr)
+{
+	micfil_suspend((void *)dev_addr);
+}
+
+static void xa_hw_micfil_resume(volatile void *dev_addr, u32 *cache_addr)
+{
+	micfil_resume((void *)dev_addr);
+}
+#endif
+
 /*******************************************************************************
  * Codec access functions
  ******************************************************************************/
@@ -211,7 +377,17 @@ static XA_ERRORCODE xa_hw_capturer_start(XACapturer *d)
 {
 	LOG(("HW-renderer started\n"));
 
-	micfil_start(d->micfil);
+	d->dev_start(d->dev_addr, 0);
+
+	/* ...hand pooled output buffers to the periods before the DMA runs */
+	if (d->zero_copy && d->dma_period == 0) {
+		UWORD32 i;
+
+		for (i = 0; i < d->period_count; i++)
+			if (xa_hw_capturer_is_scratch(d, d->zc_armed[i]))
+				xa_hw_capturer_arm(d, i);
+	}
+
 	dma_chan_start(d->dmac[0]);
 	irqstr_start(d->irqstr_addr, d->dev_Int, d->dma_Int);
 
@@ -224,7 +400,7 @@ static inline void xa_hw_capturer_stop(XACapturer *d)
 	LOG(("HW-renderer closed\n"));
 
 	dma_chan_stop(d->dmac[0]);
-	micfil_stop(d->micfil);
+	d->dev_stop(d->dev_addr, 0);
 }
 
 static inline void xa_hw_capturer_suspend(XACapturer *d)
@@ -232,19 +408,21 @@ static inline void xa_hw_capturer_suspend(XACapturer *d)
 	LOG(("HW-renderer suspend\n"));
 
 	dma_suspend(d->dma);
-	micfil_suspend(d->micfil);
+	d->dev_suspend(d->dev_addr, NULL);
 }
 
 static inline void xa_hw_capturer_resume(XACapturer *d)
 {
 	LOG(("HW-renderer resume\n"));
 
-	micfil_resume(d->micfil);
+	d->dev_resume(d->dev_addr, NULL);
 	dma_resume(d->dma);
 
 	irqstr_init(d->irqstr_addr, d->dev_Int, d->dma_Int);
-	xos_register_interrupt_handler(d->irq_2_dsp, (XosIntFunc *)xa_hw_comp_isr, 0);
-	xos_interrupt_enable(d->irq_2_dsp);
+	if (d->irqstr_addr) {
+		xos_register_interrupt_handler(d->irq_2_dsp, (XosIntFunc *)xa_hw_comp_isr, 0);
+		xos_interrupt_enable(d->irq_2_dsp);
+	}
 }
 
 static inline void xa_hw_capturer_deinit(XACapturer *d)
@@ -281,32 +459,62 @@ static XA_ERRORCODE xa_capturer_get_api_size(XACapturer *d, WORD32 i_idx, pVOID
     return XA_NO_ERROR;
 }
 
-/* init micfil and sdma */
-static XA_ERRORCODE xa_hw_capturer_init(XACapturer *d)
+#ifdef SIM_DEVICE
+/* ...simulated device recording straight into the ring */
+static XA_ERRORCODE xa_hw_capturer_dev_init(XACapturer *d, struct dsp_main_struct *dsp)
 {
-	struct dsp_main_struct *dsp;
-	dma_t                  *dma;
-	dmac_t                 *dmac;
-	void                   *micfil;
 	dmac_cfg_t             audio_cfg;
-	int                    i;
 
-	dsp = get_main_struct();
-	dma_probe(dsp);
-	micfil_probe(dsp);
+	d->dev_addr    = sim_audio_get(0);
+	d->dev_start   = sim_audio_start;
+	d->dev_stop    = sim_audio_stop;
+	d->dev_suspend = sim_audio_suspend;
+	d->dev_resume  = sim_audio_resume;
+	d->irqstr_addr = NULL;
 
-	xaf_malloc(&d->dma_buffer, d->frame_size_bytes * d->channels * 2, 0);
-	if (d->dma_buffer == NULL)
+	sim_audio_init(d->dev_addr, 0, d->channels, d->rate, d->pcm_width, 0);
+
+	d->dma = dsp->dma_device;
+	dma_init(d->dma);
+
+	memset(&audio_cfg, 0, sizeof(audio_cfg));
+	audio_cfg.period_len = d->frame_size_bytes * d->channels;
+	audio_cfg.period_count = d->period_count;
+	audio_cfg.direction = DMA_DEV_TO_MEM;
+	audio_cfg.src_addr = d->dev_addr;
+	audio_cfg.dest_addr = d->fw;
+	audio_cfg.callback = xa_hw_capturer_callback;
+	audio_cfg.comp = (void *)d;
+
+	d->dmac[0] = request_dma_chan(d->dma, 0);
+	if (!d->dmac[0] || dma_chan_config(d->dmac[0], &audio_cfg))
 		return XA_FATAL_ERROR;
-	memset(d->dma_buffer, 0, d->frame_size_bytes * d->channels * 2);
-	d->fw = d->dma_buffer;
+
+	LOG("hw_init finished, simulated device\n");
+
+	return XA_NO_ERROR;
+}
+#else
+/* init micfil and sdma */
+static XA_ERRORCODE xa_hw_capturer_dev_init(XACapturer *d, struct dsp_main_struct *dsp)
+{
+	dma_t                  *dma;
+	void                   *micfil;
+	dmac_cfg_t             audio_cfg;
 
 	/* config micfil */
+	micfil_probe(dsp);
 	d->micfil = micfil = dsp->micfil;
 	if (micfil == NULL)
 		return XA_FATAL_ERROR;
 	micfil_init(micfil);
 
+	d->dev_addr    = micfil;
+	d->dev_start   = xa_hw_micfil_start;
+	d->dev_stop    = xa_hw_micfil_stop;
+	d->dev_suspend = xa_hw_micfil_suspend;
+	d->dev_resume  = xa_hw_micfil_resume;
+
 	micfil_set_param(d->micfil, UNIA_CHANNEL, &d->channels);
 	micfil_set_param(d->micfil, UNIA_SAMPLERATE, &d->rate);
 
@@ -316,7 +524,7 @@ static XA_ERRORCODE xa_hw_capturer_init(XACapturer *d)
 	/* config dma channel */
 	sdmac_cfg_t sdmac_cfg;
 	audio_cfg.period_len = d->frame_size_bytes * d->channels;
-	audio_cfg.period_count = 2;
+	audio_cfg.period_count = d->period_count;
 	audio_cfg.direction = DMA_DEV_TO_MEM;
 	audio_cfg.src_addr = (void *)micfil_get_datach0_addr(micfil);
 	audio_cfg.dest_addr = d->fw;
@@ -336,7 +544,8 @@ static XA_ERRORCODE xa_hw_capturer_init(XACapturer *d)
 	audio_cfg.peripheral_size = sizeof(sdmac_cfg_t);
 
 	d->dmac[0] = request_dma_chan(d->dma, 0);
-	dma_chan_config(d->dmac[0], &audio_cfg);
+	if (!d->dmac[0] || dma_chan_config(d->dmac[0], &audio_cfg))
+		return XA_FATAL_ERROR;
 
 	/* config irqstr */
 	d->irqstr_addr =  (void *)IRQ_STR_ADDR;
@@ -353,6 +562,28 @@ static XA_ERRORCODE xa_hw_capturer_init(XACapturer *d)
 
 	return XA_NO_ERROR;
 }
+#endif
+
+/* ...initialize hardware capturer */
+static XA_ERRORCODE xa_hw_capturer_init(XACapturer *d)
+{
+	struct dsp_main_struct *dsp;
+	int                    i;
+
+	dsp = get_main_struct();
+	dma_probe(dsp);
+
+	xaf_malloc(&d->dma_buffer, d->frame_size_bytes * d->channels * d->period_count, 0);
+	if (d->dma_buffer == NULL)
+		return XA_FATAL_ERROR;
+	memset(d->dma_buffer, 0, d->frame_size_bytes * d->channels * d->period_count);
+	d->fw = d->dma_buffer;
+	d->dma_period = 0;
+	for (i = 0; i < d->period_count; i++)
+		d->zc_armed[i] = xa_hw_capturer_scratch(d, i);
+
+	return xa_hw_capturer_dev_init(d, dsp);
+}
 
 static XA_ERRORCODE xa_fw_capturer_init (XACapturer *d)
 {
@@ -391,6 +622,8 @@ static XA_ERRORCODE xa_capturer_init(XACapturer *d, WORD32 i_idx, pVOID pv_value
         d->sample_size = ( d->pcm_width >> 3 ); /* convert bits to bytes */ 
         d->frame_size_bytes = MAX_FRAME_SIZE_IN_BYTES_DEFAULT; 
         d->frame_size = MAX_FRAME_SIZE_IN_BYTES_DEFAULT/d->sample_size; 
+        d->period_count = DEFAULT_PERIOD_COUNT;
+        d->overrun_policy = XA_CAPTURER_OVERRUN_RESTART;
 
         /* ...and mark capturer has been created */
         d->state = XA_CAPTURER_FLAG_PREINIT_DONE;
@@ -654,6 +887,59 @@ static XA_ERRORCODE xa_capturer_set_config_param(XACapturer *d, WORD32 i_idx, pV
             
             return XA_NO_ERROR;
         }
+
+    case XA_CAPTURER_CONFIG_PARAM_ZERO_COPY:
+        /* ...command is valid only in configuration state */
+        XF_CHK_ERR((d->state & XA_CAPTURER_FLAG_POSTINIT_DONE) == 0, XA_CAPTURER_CONFIG_FATAL_STATE);
+
+        /* ...apply setting */
+        d->zero_copy = (*(WORD32 *)pv_value != 0);
+
+        return XA_NO_ERROR;
+
+    case XA_CAPTURER_CONFIG_PARAM_DMA_BUFFER:
+        {
+            unsigned long flags;
+
+            /* ...buffers are only taken in zero-copy mode once running */
+            XF_CHK_ERR(d->zero_copy && (d->state & XA_CAPTURER_FLAG_POSTINIT_DONE), XA_CAPTURER_CONFIG_NONFATAL_RANGE);
+
+            /* ...a buffer the pool has no room for is filled by copy instead */
+            flags = __xf_disable_interrupts();
+            i_value = (d->zc_pool_wr - d->zc_pool_rd < ZC_POOL_SIZE);
+            if (i_value)
+                d->zc_pool[d->zc_pool_wr++ & (ZC_POOL_SIZE - 1)] = pv_value;
+            __xf_restore_interrupts(flags);
+
+            return (i_value ? XA_NO_ERROR : XA_CAPTURER_CONFIG_NONFATAL_RANGE);
+        }
+
+    case XA_CAPTURER_CONFIG_PARAM_PERIOD_COUNT:
+        /* ...command is valid only in configuration state */
+        XF_CHK_ERR((d->state & XA_CAPTURER_FLAG_POSTINIT_DONE) == 0, XA_CAPTURER_CONFIG_FATAL_STATE);
+
+        /* ...get requested number of periods */
+        i_value = (UWORD32) *(WORD32 *)pv_value;
+
+        /* ...at least one period must be free while another is read */
+        XF_CHK_ERR((i_value >= 2) && (i_value <= DMA_MAX_PERIOD_COUNT), XA_CAPTURER_CONFIG_NONFATAL_RANGE);
+
+        /* ...apply setting */
+        d->period_count = i_value;
+
+        return XA_NO_ERROR;
+
+    case XA_CAPTURER_CONFIG_PARAM_OVERRUN_POLICY:
+        /* ...policy may change at any time, it is applied per period */
+        i_value = (UWORD32) *(WORD32 *)pv_value;
+
+        XF_CHK_ERR(i_value <= XA_CAPTURER_OVERRUN_NEWEST, XA_CAPTURER_CONFIG_NONFATAL_RANGE);
+
+        /* ...apply setting */
+        d->overrun_policy = i_value;
+
+        return XA_NO_ERROR;
+
     default:
         /* ...unrecognized parameter */
         return XF_CHK_ERR(0, XA_API_FATAL_INVALID_CMD_TYPE);
@@ -718,17 +1004,102 @@ static XA_ERRORCODE xa_capturer_get_config_param(XACapturer *d, WORD32 i_idx, pV
         *(WORD32 *)pv_value = d->frame_size;
         return XA_NO_ERROR;
 
+    case XA_CAPTURER_CONFIG_PARAM_ZERO_COPY:
+        /* ...return zero-copy mode */
+        *(WORD32 *)pv_value = d->zero_copy;
+        return XA_NO_ERROR;
+
+    case XA_CAPTURER_CONFIG_PARAM_PERIOD_COUNT:
+        /* ...return number of periods in the DMA ring */
+        *(WORD32 *)pv_value = d->period_count;
+        return XA_NO_ERROR;
+
+    case XA_CAPTURER_CONFIG_PARAM_OVERRUN_POLICY:
+        /* ...return current overrun policy */
+        *(WORD32 *)pv_value = d->overrun_policy;
+        return XA_NO_ERROR;
+
+    case XA_CAPTURER_CONFIG_PARAM_OVERRUN_COUNT:
+        /* ...return number of overruns since init */
+        *(UWORD32 *)pv_value = d->overrun_count;
+        return XA_NO_ERROR;
+
     default:
         /* ...unrecognized parameter */
         return XF_CHK_ERR(0, XA_API_FATAL_INVALID_CMD_TYPE);
     }
 }
 
+/* ...deliver the oldest completed period in zero-copy mode */
+static XA_ERRORCODE xa_capturer_zc_exec(XACapturer *d)
+{
+    UWORD32 payload = d->frame_size_bytes * d->channels;
+    unsigned long flags;
+    void *p;
+
+    d->produced = 0;
+
+    if (d->zc_done_rd == d->zc_done_wr)
+        return XA_NO_ERROR;
+
+    if (!d->output)
+        return XA_CAPTURER_EXEC_NONFATAL_NO_DATA;
+
+    flags = __xf_disable_interrupts();
+    p = d->zc_done[d->zc_done_rd++ & (ZC_DONE_SIZE - 1)];
+
+    if (p == d->output)
+    {
+        /* ...the DMA filled the buffer in place */
+        d->produced = payload;
+    }
+    else if (xa_hw_capturer_is_scratch(d, p))
+    {
+        /* ...no buffer was armed in time; the output may still be waiting
+         * in the pool, take it back so the DMA does not write it later */
+        if (d->zc_pool_rd != d->zc_pool_wr &&
+            d->zc_pool[d->zc_pool_rd & (ZC_POOL_SIZE - 1)] == d->output)
+        {
+            d->zc_pool_rd++;
+        }
+
+        if (!xa_hw_capturer_zc_busy(d, d->output))
+        {
+            memcpy(d->output, p, payload);
+            d->produced = payload;
+        }
+        else
+        {
+            TRACE(OUTPUT, _b("zero-copy: output %p busy, dropped period"), d->output);
+        }
+    }
+    else
+    {
+        /* ...stale buffer after a flush */
+        TRACE(OUTPUT, _b("zero-copy: dropped period %p, output %p"), p, d->output);
+    }
+    __xf_restore_interrupts(flags);
+
+    d->tot_bytes_produced += d->produced;
+    if (d->bytes_end != 0 && d->tot_bytes_produced >= d->bytes_end)
+    {
+        /* ...trim the last buffer and report completion */
+        d->produced -= (UWORD32)(d->tot_bytes_produced - d->bytes_end);
+        d->tot_bytes_produced = d->bytes_end;
+        d->capturer_eof = 1;
+    }
+
+    return XA_NO_ERROR;
+}
+
 static XA_ERRORCODE xa_capturer_do_exec(XACapturer *d)
 {
     WORD32 bytes_read = 0;
     static UWORD32 frame_cnt = 0;
 
+    if (d->zero_copy)
+        return xa_capturer_zc_exec(d);
+
     FIO_PRINTF(stdout,"%d\n",++frame_cnt);
     if(d->fifo_avail >= (d->frame_size_bytes * d->channels))
     {
@@ -797,14 +1168,23 @@ static XA_ERRORCODE xa_capturer_execute(XACapturer *d, WORD32 i_idx, pVOID pv_va
     {
     case XA_CMD_TYPE_DO_EXECUTE:
         ret = xa_capturer_do_exec(d);
+
+        /* ...report each new overrun once as a non-fatal error; the class
+         * forwards it to the error channel if the application opened one */
+        if (ret == XA_NO_ERROR && d->overrun_reported != d->overrun_count)
+        {
+            d->overrun_reported = d->overrun_count;
+            return XA_CAPTURER_EXEC_NONFATAL_OVERRUN;
+        }
         return XA_NO_ERROR;
 
     case XA_CMD_TYPE_DONE_QUERY:
         /* ...always report "no" - tbd - is that needed at all? */
         XF_CHK_ERR(pv_value, XA_API_FATAL_INVALID_CMD_TYPE);
 
-        if((d->produced == 0) 
-            && (d->output) /* TENA-2528 */
+        if(d->zero_copy ? d->capturer_eof :
+            ((d->produced == 0)
+            && (d->output)) /* TENA-2528 */
         )
         {
             //__xf_timer_stop(&cap_timer);
@@ -820,7 +1200,14 @@ static XA_ERRORCODE xa_capturer_execute(XACapturer *d, WORD32 i_idx, pVOID pv_va
         return XA_NO_ERROR;
 
     case XA_CMD_TYPE_DO_RUNTIME_INIT:
-        /* ...silently ignore */
+        /* ...flushed output buffers must not stay armed */
+        if (d->zero_copy && (d->state & XA_CAPTURER_FLAG_POSTINIT_DONE))
+        {
+            unsigned long flags = __xf_disable_interrupts();
+
+            xa_hw_capturer_zc_reset(d);
+            __xf_restore_interrupts(flags);
+        }
         return XA_NO_ERROR;
 
     default:
@@ -52,15 +52,20 @@
  * Includes
  ******************************************************************************/
 #include "osal-timer.h"
+#include "osal-isr.h"
 #include <stdio.h>
 #include "audio/xa-renderer-api.h"
 #include "xf-debug.h"
+#include "xf-pcm.h"
 #include <string.h>
 
 #include "mydefs.h"
 #include "hardware.h"
 #include "dsp_irq_handler.h"
 #include "debug.h"
+#ifdef SIM_DEVICE
+#include "sim_audio.h"
+#endif
 
 #ifdef XAF_PROFILE
 #include "xaf-clk-test.h"
@@ -82,6 +87,9 @@ extern clk_t renderer_cycles;
 
 #define HW_I2S_SF (44100)
 
+/* ...default number of periods in the DMA ring (ping and pong) */
+#define DEFAULT_PERIOD_COUNT    2
+
 #define READ_FIFO(payload) {\
         if(d->output)\
         {\
@@ -91,7 +99,7 @@ extern clk_t renderer_cycles;
         }\
         /* ...write to output file and increment read pointer */\
         d->pfifo_r += payload;\
-        if((UWORD32)d->pfifo_r >= (UWORD32)&d->g_fifo_renderer[2*payload])\
+        if((UWORD32)d->pfifo_r >= (UWORD32)&d->g_fifo_renderer[d->period_count*payload])\
         {\
             d->pfifo_r = (void*)d->g_fifo_renderer;\
         }\
@@ -99,7 +107,7 @@ extern clk_t renderer_cycles;
 
 #define UPDATE_WPTR(offset, payload) {\
         d->pfifo_w += offset;\
-        if((UWORD32)d->pfifo_w >= (UWORD32)&d->g_fifo_renderer[2*payload])\
+        if((UWORD32)d->pfifo_w >= (UWORD32)&d->g_fifo_renderer[d->period_count*payload])\
         {\
             d->pfifo_w = (void*)d->g_fifo_renderer;\
         }\
@@ -181,6 +189,35 @@ typedef struct XARenderer
     /* ...framesize in samples per channel */
     UWORD32     frame_size;
 
+    /* ...number of frame sized periods in the DMA ring */
+    UWORD32     period_count;
+
+    /* ...periods to queue before transmission starts (0 - whole ring) */
+    UWORD32     start_threshold;
+
+    /* ...underrun policy (enum xa_renderer_underrun_policy) */
+    UWORD32     underrun_policy;
+
+    /* ...set while the FIFO is dry and the DMA plays concealment data */
+    UWORD32     underrun;
+
+    /* ...number of underruns since initialization */
+    UWORD32     underrun_count;
+
+    /* ...set while the DMA plays a concealment period instead of data */
+    UWORD32     concealed;
+
+    /* ...frames of real data played out by completed DMA periods */
+    UWORD64     frames_played;
+
+    /* ...system cycles at the last period completion (or start) */
+    UWORD64     period_cycles;
+
+    /* ...position latched by XA_RENDERER_CONFIG_PARAM_POSITION */
+    UWORD64     pos_frames;
+    UWORD64     pos_time_us;
+    UWORD32     pos_delay;
+
 	void                  *dev_addr;
 	void                  *fe_dev_addr;
 
@@ -257,11 +294,36 @@ typedef struct XARenderer
 
 static inline int xa_hw_renderer_deinit(struct XARenderer *d);
 
+/* ...zero the periods not written yet, so that a (re)started DMA never plays
+ * stale data left in the ring from before it was stopped */
+static inline void xa_hw_renderer_clear(struct XARenderer *d)
+{
+	UWORD32 fifo_len = d->frame_size_bytes * d->channels * d->period_count;
+	UWORD32 avail = (d->fifo_avail < fifo_len ? d->fifo_avail : fifo_len);
+	UWORD32 tail;
+
+	if (!d->g_fifo_renderer)
+		return;
+
+	tail = d->g_fifo_renderer + fifo_len - (UWORD8 *)d->pfifo_w;
+	if (avail <= tail) {
+		memset(d->pfifo_w, 0, avail);
+	} else {
+		memset(d->pfifo_w, 0, tail);
+		memset(d->g_fifo_renderer, 0, avail - tail);
+	}
+}
+
 /* ...start HW-renderer operation */
 static inline int xa_hw_renderer_start(struct XARenderer *d)
 {
 	LOG(("HW-renderer started\n"));
 
+	xa_hw_renderer_clear(d);
+
+	/* ...the first period starts playing now */
+	d->period_cycles = xos_get_system_cycles();
+
 	irqstr_start(d->irqstr_addr, d->fe_dev_Int, d->fe_dma_Int);
 	dma_chan_start(d->dmac[0]);
 	dma_chan_start(d->dmac[1]);
@@ -274,32 +336,84 @@ static inline int xa_hw_renderer_start(struct XARenderer *d)
 static inline void xa_hw_renderer_close(struct XARenderer *d)
 {
 	LOG(("HW-renderer closed\n"));
-	if (!d->irqstr_addr)
+	if (!d->dmac[0])
 		return;
 	dma_chan_stop(d->dmac[0]);
 	dma_chan_stop(d->dmac[1]);
 	d->dev_stop(d->dev_addr, 1);
 	d->fe_dev_stop(d->fe_dev_addr, 1);
+
+	xa_hw_renderer_clear(d);
+}
+
+/* ...fill the period after the one now playing with concealment data, so
+ * that the DMA finds it there if no data comes in time; it derives from the
+ * period now playing, i.e. the latest data or concealment */
+static inline void xa_hw_renderer_conceal(XARenderer *d, UWORD32 payload, UWORD32 fifo_len)
+{
+	UWORD8 *last = d->pfifo_r;
+	UWORD8 *next = last + payload;
+
+	if (next >= d->g_fifo_renderer + fifo_len)
+		next = d->g_fifo_renderer;
+
+	switch (d->underrun_policy) {
+	case XA_RENDERER_UNDERRUN_SILENCE:
+		memset(next, 0, payload);
+		break;
+	case XA_RENDERER_UNDERRUN_FADE:
+		/* ...6dB down on every repeat, so a dry FIFO fades out to silence */
+		memcpy(next, last, payload);
+		xf_pcm_attenuate(next, d->pcm_width, payload / xf_pcm_sample_size(d->pcm_width), 1);
+		break;
+	case XA_RENDERER_UNDERRUN_REPEAT:
+		memcpy(next, last, payload);
+		break;
+	default:
+		break;
+	}
 }
 
 /* ...emulation of renderer interrupt service routine */
 static void xa_hw_renderer_callback(void *arg)
 {
 	XARenderer *d = (XARenderer *)arg;
-	s32     avail;
-	u32     status;
-	u32     num;
-
-	READ_FIFO(d->frame_size_bytes * d->channels);
-	d->fifo_avail = d->fifo_avail + (d->frame_size_bytes * d->channels);
+	UWORD32 payload = d->frame_size_bytes * d->channels;
+	UWORD32 fifo_len = payload * d->period_count;
+
+	/* ...account the period that just left the DAC, unless it was concealment */
+	d->period_cycles = xos_get_system_cycles();
+	if (d->concealed)
+		d->concealed = 0;
+	else
+		d->frames_played += d->frame_size_bytes / d->sample_size;
+
+	READ_FIFO(payload);
+	d->fifo_avail = d->fifo_avail + payload;
 	LOG2("fifo_avail %x, fifo_ptr_r %x\n", d->fifo_avail, d->pfifo_r);
+
 	/* ...notify user on input-buffer (idx = 0) consumption */
-	if((d->fifo_avail) >= d->frame_size_bytes * d->channels * 2)
+	if((d->fifo_avail) >= fifo_len && d->underrun_policy != XA_RENDERER_UNDERRUN_STOP)
 	{
+		/* ...the DMA is now playing the concealment period prepared on the
+		 * last completion; keep it running, skip the write pointer past that
+		 * period and refill behind it */
+		if (!d->underrun) {
+			d->underrun = 1;
+			d->underrun_count++;
+			LOG1("isr under run %d, concealing\n", d->underrun_count);
+		}
+		d->fifo_avail = fifo_len - payload;
+		d->concealed = 1;
+		UPDATE_WPTR(payload, payload);
+	}
+	else if((d->fifo_avail) >= fifo_len)
+	{
+		d->underrun_count++;
 		LOG("isr under run\n");
 		/*under run case*/
 		d->state ^= XA_RENDERER_FLAG_RUNNING | XA_RENDERER_FLAG_IDLE;
-		d->fifo_avail = d->frame_size_bytes * d->channels * 2;
+		d->fifo_avail = fifo_len;
 		xa_hw_renderer_close(d);
 	} else if(((int)d-> fifo_avail) <= 0) {
 		/* over run */
@@ -311,6 +425,11 @@ static void xa_hw_renderer_callback(void *arg)
 #endif
 	}
 
+	/* ...nothing is queued behind the period now playing; conceal the next
+	 * one, unless data arrives before the DMA gets there */
+	if (d->underrun_policy != XA_RENDERER_UNDERRUN_STOP && d->fifo_avail + payload >= fifo_len)
+		xa_hw_renderer_conceal(d, payload, fifo_len);
+
 	d->cdata->cb(d->cdata, 0);
 }
 
@@ -363,12 +482,14 @@ static inline UWORD32 xa_fw_renderer_submit(XARenderer *d, void *b, UWORD32 byte
         /* ...update the write pointer */
         UPDATE_WPTR(payload, payload);
 
+        /* ...real data is queued again after an underrun */
+        d->underrun = 0;
+
         /* ...process buffer start-up */
         if (d->state & XA_RENDERER_FLAG_IDLE)
         {
-            /* ...start-up transmission if FIFO gets at least 2 frames */
-            //if (avail <= (HW_FIFO_LENGTH - (2 * payload)))
-            if (avail == 0)
+            /* ...start-up transmission once start_threshold periods are queued */
+            if (avail <= (d->period_count - d->start_threshold) * payload)
             {
 		/* trigger start*/
 		xa_hw_renderer_start(d);
@@ -417,34 +538,62 @@ static XA_ERRORCODE xa_renderer_get_api_size(XARenderer *d, WORD32 i_idx, pVOID
     return XA_NO_ERROR;
 }
 
-/* ...initialize hardware renderer */
-static inline int xa_hw_renderer_init(struct XARenderer *d)
+#ifdef SIM_DEVICE
+/* ...simulated device fed straight from the ring, with no front end */
+static int xa_hw_renderer_dev_init(struct XARenderer *d)
+{
+	dmac_cfg_t      audio_cfg;
+
+	d->dev_addr     = sim_audio_get(1);
+	d->dev_fifo_off = 0;
+	d->fe_dev_addr  = NULL;
+	d->irqstr_addr  = NULL;
+
+	d->dev_init     = sim_audio_init;
+	d->dev_start    = sim_audio_start;
+	d->dev_stop     = sim_audio_stop;
+	d->dev_isr      = sim_audio_irq_handler;
+	d->dev_suspend  = sim_audio_suspend;
+	d->dev_resume   = sim_audio_resume;
+
+	/* ...the hooks do nothing on the NULL front end device */
+	d->fe_dev_init  = sim_audio_init;
+	d->fe_dev_start = sim_audio_start;
+	d->fe_dev_stop  = sim_audio_stop;
+	d->fe_dev_isr   = sim_audio_irq_handler;
+	d->fe_dev_suspend  = sim_audio_suspend;
+	d->fe_dev_resume   = sim_audio_resume;
+	d->fe_dev_hw_params = sim_audio_hw_params;
+
+	memset(&audio_cfg, 0, sizeof(audio_cfg));
+	audio_cfg.period_len = d->frame_size_bytes * d->channels;
+	audio_cfg.period_count = d->period_count;
+	audio_cfg.direction = DMA_MEM_TO_DEV;
+	audio_cfg.src_addr = d->g_fifo_renderer;
+	audio_cfg.dest_addr = (void *)((UWORD8 *)d->dev_addr + d->dev_fifo_off);
+	audio_cfg.callback = xa_hw_renderer_callback;
+	audio_cfg.comp = (void *)d;
+
+	d->dmac[0] = request_dma_chan(d->dma, 0);
+	if (!d->dmac[0] || dma_chan_config(d->dmac[0], &audio_cfg))
+		return XA_FATAL_ERROR;
+	d->dmac[1] = NULL;
+
+	d->dev_init(d->dev_addr, 1, d->channels, d->rate, d->pcm_width, 0);
+
+	LOG("hw_init finished, simulated device\n");
+	return 0;
+}
+#else
+/* ...board devices behind the ESAI/ASRC or SAI/EASRC front end */
+static int xa_hw_renderer_dev_init(struct XARenderer *d)
 {
-	struct dsp_main_struct *dsp;
-	int             r;
 	int             board_type;
 	dmac_cfg_t      audio_cfg;
 	int dev_type;
 
 	board_type = BOARD_TYPE;
 
-	dsp = get_main_struct();
-	dma_probe(dsp);
-
-	d->dma = dsp->dma_device;
-	dma_init(d->dma);
-
-	/*initially FIFO will be empty so fifo_avail is 2x framesize bytes for ping and pong */
-	d->fifo_avail = d->frame_size_bytes * d->channels * 2;
-	/* ...make sure that the frame_size_bytes is within the FIFO length */
-	XF_CHK_ERR(d->fifo_avail <= HW_FIFO_LENGTH, XA_RENDERER_CONFIG_NONFATAL_RANGE);
-
-	/* alloc internal buffer for DMA/SAI/ESAI*/
-	xaf_malloc((void **)&d->g_fifo_renderer, d->frame_size_bytes * d->channels * 2, 0);
-
-	/* ...initialize FIFO params, zero fill FIFO and init pointers to start of FIFO */
-	d->pfifo_w = d->pfifo_r = d->g_fifo_renderer;
-
 	/*It is better to send address through the set_param */
 	if (board_type == DSP_IMX8QXP_TYPE) {
 		d->dev_addr     = (void *)ESAI_ADDR;
@@ -479,7 +628,7 @@ static inline int xa_hw_renderer_init(struct XARenderer *d)
 
 		/* dma channel configuration */
 		audio_cfg.period_len = d->frame_size_bytes * d->channels;
-		audio_cfg.period_count = 2;
+		audio_cfg.period_count = d->period_count;
 		audio_cfg.direction = DMA_MEM_TO_DEV;
 		audio_cfg.src_addr = d->g_fifo_renderer;
 		audio_cfg.dest_addr = (void *)(ASRC_ADDR + REG_ASRDIA);
@@ -492,7 +641,8 @@ static inline int xa_hw_renderer_init(struct XARenderer *d)
 		d->dmac[0] = request_dma_chan(d->dma, dev_type);
 		if (!d->dmac[0])
 			return XA_FATAL_ERROR;
-		dma_chan_config(d->dmac[0], &audio_cfg);
+		if (dma_chan_config(d->dmac[0], &audio_cfg))
+			return XA_FATAL_ERROR;
 
 		audio_cfg.period_len = d->frame_size_bytes * d->channels;
 		audio_cfg.period_count = 2;
@@ -547,7 +697,7 @@ static inline int xa_hw_renderer_init(struct XARenderer *d)
 
 		/* dma channels configuration */
 		audio_cfg.period_len = d->frame_size_bytes * d->channels;
-		audio_cfg.period_count = 2;
+		audio_cfg.period_count = d->period_count;
 		audio_cfg.direction = DMA_MEM_TO_DEV;
 		audio_cfg.src_addr = d->g_fifo_renderer;
 		audio_cfg.dest_addr = (void *)(EASRC_ADDR + REG_EASRC_WRFIFO(0));
@@ -562,7 +712,8 @@ static inline int xa_hw_renderer_init(struct XARenderer *d)
 		audio_cfg.peripheral_size = sizeof(sdmac_cfg_t);
 
 		d->dmac[0] = request_dma_chan(d->dma, 0);
-		dma_chan_config(d->dmac[0], &audio_cfg);
+		if (!d->dmac[0] || dma_chan_config(d->dmac[0], &audio_cfg))
+			return XA_FATAL_ERROR;
 
 		audio_cfg.period_len = d->frame_size_bytes * d->channels;
 		audio_cfg.period_count = 2;
@@ -604,6 +755,42 @@ static inline int xa_hw_renderer_init(struct XARenderer *d)
 	LOG("hw_init finished\n");
 	return 0;
 }
+#endif
+
+/* ...initialize hardware renderer */
+static inline int xa_hw_renderer_init(struct XARenderer *d)
+{
+	struct dsp_main_struct *dsp;
+
+	dsp = get_main_struct();
+	dma_probe(dsp);
+
+	d->dma = dsp->dma_device;
+	dma_init(d->dma);
+
+	/* ...a zero threshold means start on a full ring, as with ping and pong */
+	if (d->start_threshold == 0)
+		d->start_threshold = d->period_count;
+	XF_CHK_ERR(d->start_threshold <= d->period_count, XA_RENDERER_CONFIG_NONFATAL_RANGE);
+
+	/*initially FIFO will be empty so fifo_avail is period_count x framesize bytes */
+	d->fifo_avail = d->frame_size_bytes * d->channels * d->period_count;
+	/* ...make sure that the whole ring of periods is within the FIFO length */
+	XF_CHK_ERR(d->fifo_avail <= HW_FIFO_LENGTH, XA_RENDERER_CONFIG_NONFATAL_RANGE);
+
+	/* alloc internal buffer for DMA/SAI/ESAI*/
+	xaf_malloc((void **)&d->g_fifo_renderer, d->fifo_avail, 0);
+	if (!d->g_fifo_renderer)
+		return XA_FATAL_ERROR;
+
+	/* ...periods not yet written when the DMA starts early play silence */
+	memset(d->g_fifo_renderer, 0, d->fifo_avail);
+
+	/* ...initialize FIFO params, zero fill FIFO and init pointers to start of FIFO */
+	d->pfifo_w = d->pfifo_r = d->g_fifo_renderer;
+
+	return xa_hw_renderer_dev_init(d);
+}
 
 static inline int xa_hw_renderer_deinit(struct XARenderer *d)
 {
@@ -658,6 +845,9 @@ static XA_ERRORCODE xa_renderer_init(XARenderer *d, WORD32 i_idx, pVOID pv_value
         d->sample_size = ( d->pcm_width >> 3 ); /* convert bits to bytes */ 
         d->frame_size_bytes = MAX_FRAME_SIZE_IN_BYTES_DEFAULT;
         d->frame_size = MAX_FRAME_SIZE_IN_BYTES_DEFAULT/d->sample_size; 
+        d->period_count = DEFAULT_PERIOD_COUNT;
+        d->start_threshold = 0;
+        d->underrun_policy = XA_RENDERER_UNDERRUN_STOP;
         
         /* ...and mark renderer has been created */
         d->state = XA_RENDERER_FLAG_PREINIT_DONE;
@@ -784,8 +974,10 @@ static inline XA_ERRORCODE xa_hw_renderer_control(XARenderer *d, UWORD32 state)
 	d->dev_resume(d->dev_addr, d->dev_cache);
 	d->fe_dev_resume(d->fe_dev_addr, d->fe_dev_cache);
 	dma_resume(d->dma);
-	xos_register_interrupt_handler(d->irq_2_dsp, (XosIntFunc *)xa_hw_comp_isr, 0);
-	xos_interrupt_enable(d->irq_2_dsp);
+	if (d->irqstr_addr) {
+		xos_register_interrupt_handler(d->irq_2_dsp, (XosIntFunc *)xa_hw_comp_isr, 0);
+		xos_interrupt_enable(d->irq_2_dsp);
+	}
 	return XA_NO_ERROR;
 
 
@@ -908,6 +1100,34 @@ static XA_ERRORCODE xa_renderer_set_config_param(XARenderer *d, WORD32 i_idx, pV
 
         return XA_NO_ERROR;
 
+    case XA_RENDERER_CONFIG_PARAM_PERIOD_COUNT:
+        /* ...command is valid only in configuration state */
+        XF_CHK_ERR((d->state & XA_RENDERER_FLAG_POSTINIT_DONE) == 0, XA_RENDERER_CONFIG_FATAL_STATE);
+        /* ...get requested number of periods */
+        i_value = (UWORD32) *(WORD32 *)pv_value;
+        /* ...need at least ping and pong, and no more than the DMA chain holds */
+        XF_CHK_ERR((i_value >= 2) && (i_value <= DMA_MAX_PERIOD_COUNT), XA_RENDERER_CONFIG_NONFATAL_RANGE);
+        /* ...apply setting */
+        d->period_count = i_value;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_START_THRESHOLD:
+        /* ...command is valid only in configuration state */
+        XF_CHK_ERR((d->state & XA_RENDERER_FLAG_POSTINIT_DONE) == 0, XA_RENDERER_CONFIG_FATAL_STATE);
+        /* ...get requested number of periods; checked against period count at post-init */
+        i_value = (UWORD32) *(WORD32 *)pv_value;
+        XF_CHK_ERR(i_value <= DMA_MAX_PERIOD_COUNT, XA_RENDERER_CONFIG_NONFATAL_RANGE);
+        /* ...apply setting */
+        d->start_threshold = i_value;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_UNDERRUN_POLICY:
+        /* ...policy may change at any time, it is applied per period */
+        i_value = (UWORD32) *(WORD32 *)pv_value;
+        XF_CHK_ERR(i_value <= XA_RENDERER_UNDERRUN_REPEAT, XA_RENDERER_CONFIG_NONFATAL_RANGE);
+        d->underrun_policy = i_value;
+        return XA_NO_ERROR;
+
     default:
         /* ...unrecognized parameter */
         return XF_CHK_ERR(0, XA_API_FATAL_INVALID_CMD_TYPE);
@@ -925,6 +1145,37 @@ static inline UWORD32 xa_hw_renderer_get_state(XARenderer *d)
         return XA_RENDERER_STATE_IDLE;
 }
 
+/* ...latch playback position, timestamp and delay */
+static void xa_hw_renderer_get_position(XARenderer *d)
+{
+    UWORD32     frame_bytes = d->sample_size * d->channels;
+    UWORD32     period_frames = d->frame_size_bytes / d->sample_size;
+    UWORD32     queued, partial = 0;
+    UWORD64     now;
+    unsigned long flags;
+
+    /* ...sample the ISR bookkeeping atomically */
+    flags = __xf_disable_interrupts();
+    now = xos_get_system_cycles();
+    d->pos_frames = d->frames_played;
+    queued = (d->frame_size_bytes * d->channels * d->period_count - d->fifo_avail) / frame_bytes;
+    /* ...a concealment period in flight holds no stream data */
+    queued -= (d->concealed ? period_frames : 0);
+    if ((d->state & XA_RENDERER_FLAG_RUNNING) && !d->concealed)
+    {
+        /* ...interpolate into the period the DMA is playing */
+        partial = (UWORD32)((now - d->period_cycles) * d->rate / xos_get_clock_freq());
+        partial = (partial > period_frames ? period_frames : partial);
+    }
+    __xf_restore_interrupts(flags);
+
+    d->pos_frames += partial;
+    /* ...split the conversion, cycles times 10^6 overflows 64 bits in hours */
+    d->pos_time_us = (now / xos_get_clock_freq()) * 1000000ULL +
+                     (now % xos_get_clock_freq()) * 1000000ULL / xos_get_clock_freq();
+    d->pos_delay = (queued > partial ? queued - partial : 0);
+}
+
 /* ...retrieve configuration parameter */
 static XA_ERRORCODE xa_renderer_get_config_param(XARenderer *d, WORD32 i_idx, pVOID pv_value)
 {
@@ -971,6 +1222,52 @@ static XA_ERRORCODE xa_renderer_get_config_param(XARenderer *d, WORD32 i_idx, pV
         *(WORD32 *)pv_value = d->frame_size;
         return XA_NO_ERROR;
 
+    case XA_RENDERER_CONFIG_PARAM_PERIOD_COUNT:
+        /* ...return number of periods in the DMA ring */
+        *(WORD32 *)pv_value = d->period_count;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_START_THRESHOLD:
+        /* ...return start threshold in periods (0 - whole ring, before post-init) */
+        *(WORD32 *)pv_value = d->start_threshold;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_UNDERRUN_POLICY:
+        /* ...return current underrun policy */
+        *(WORD32 *)pv_value = d->underrun_policy;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_UNDERRUN_COUNT:
+        /* ...return number of underruns since initialization */
+        *(UWORD32 *)pv_value = d->underrun_count;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_POSITION:
+        /* ...latch a new position; low 32 bits of frames played */
+        xa_hw_renderer_get_position(d);
+        *(UWORD32 *)pv_value = (UWORD32)d->pos_frames;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_POSITION_HI:
+        /* ...high 32 bits of the latched frames played */
+        *(UWORD32 *)pv_value = (UWORD32)(d->pos_frames >> 32);
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_POSITION_TIME:
+        /* ...return time of the latched position; low 32 bits in us */
+        *(UWORD32 *)pv_value = (UWORD32)d->pos_time_us;
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_POSITION_TIME_HI:
+        /* ...high 32 bits of the latched time in us */
+        *(UWORD32 *)pv_value = (UWORD32)(d->pos_time_us >> 32);
+        return XA_NO_ERROR;
+
+    case XA_RENDERER_CONFIG_PARAM_DELAY:
+        /* ...return frames queued ahead of the latched position */
+        *(UWORD32 *)pv_value = d->pos_delay;
+        return XA_NO_ERROR;
+
     default:
         /* ...unrecognized parameter */
         return XF_CHK_ERR(0, XA_API_FATAL_INVALID_CMD_TYPE);
@@ -68,6 +68,12 @@ struct XFUniaCodec {
 	/* ...codec input over flag */
 	UWORD32 input_over;
 
+	/* ...input is taken as scattered segments */
+	UWORD32 gather;
+
+	/* ...current input segments, fed to the wrapper one by one */
+	xa_codec_input_segments_t segments;
+
 	/* loading library info of codec wrap */
 	struct dpu_lib_stat_t lib_codec_wrap_stat;
 
@@ -261,7 +267,8 @@ static UA_ERROR_TYPE xf_unia_load_lib(struct XFUniaCodec *d, void *pv_value)
 	switch(lib_type) {
 	case DSP_CODEC_LIB:
 		lib_stat = &d->lib_codec_stat;
-		d->codecinterface = dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0);
+		d->codecinterface = dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0,
+				IS_LIB_CODE_SHARED(cmd->lib_type));
 		if (!d->codecinterface) {
 			LOG("load codec lib failed\n");
 			return XA_API_FATAL_INVALID_CMD;
@@ -270,7 +277,8 @@ static UA_ERROR_TYPE xf_unia_load_lib(struct XFUniaCodec *d, void *pv_value)
 		break;
 	case DSP_CODEC_WRAP_LIB:
 		lib_stat = &d->lib_codec_wrap_stat;
-		d->codecwrapinterface = (tUniACodecQueryInterface)dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0);
+		d->codecwrapinterface = (tUniACodecQueryInterface)dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0,
+				IS_LIB_CODE_SHARED(cmd->lib_type));
 		if (!d->codecwrapinterface) {
 			LOG("load codec wrap lib failed\n");
 			return XA_API_FATAL_INVALID_CMD;
@@ -548,6 +556,38 @@ static UA_ERROR_TYPE xf_uniacodec_getparam(struct XFUniaCodec *d,
 	return ret;
 }
 
+/*
+ * feed input segments straight into the wrapper bitstream input, stopping at
+ * the first output, error or segment the wrapper did not take in full
+ */
+static UA_ERROR_TYPE xf_uniacodec_exec_segments(struct XFUniaCodec *d)
+{
+	xa_codec_input_segments_t *seg = &d->segments;
+	UA_ERROR_TYPE ret = ACODEC_SUCCESS;
+	UWORD32 offset;
+	UWORD32 i;
+
+	d->consumed = 0;
+
+	for (i = 0; i < seg->num; i++) {
+		offset = 0;
+		ret = d->WrapFun.Process(d->pWrpHdl,
+					(u8 *)seg->ptr[i],
+					seg->length[i],
+					&offset,
+					(u8 **)&d->outptr,
+					&d->out_size);
+
+		d->consumed += offset;
+
+		if (d->out_size || offset < seg->length[i] ||
+		    (ret && ret <= ACODEC_INIT_ERR))
+			break;
+	}
+
+	return ret;
+}
+
 static UA_ERROR_TYPE xf_uniacodec_exec_process(struct XFUniaCodec *d,
 					   UWORD32 i_idx,
 					   void *pv_value)
@@ -561,6 +601,14 @@ static UA_ERROR_TYPE xf_uniacodec_exec_process(struct XFUniaCodec *d,
 	}
 	d->out_size = 0;
 
+	if (d->gather && d->segments.num) {
+		LOG3("in_segs = %d, in_size = %x, out_buf = %x\n",
+		     d->segments.num, d->in_size, d->outptr);
+
+		ret = xf_uniacodec_exec_segments(d);
+		goto out;
+	}
+
 	LOG4("in_buf = %x, in_size = %x, offset = %d, out_buf = %x\n",
 	     d->inptr, d->in_size, d->consumed, d->outptr);
 
@@ -577,6 +625,7 @@ static UA_ERROR_TYPE xf_uniacodec_exec_process(struct XFUniaCodec *d,
 
 	d->consumed = offset;
 
+out:
 	/* avoid to report normal return val to dsp */
 	if (!d->input_over && ret && ret > ACODEC_INIT_ERR)
 		ret = ACODEC_SUCCESS;
@@ -603,6 +652,7 @@ static UA_ERROR_TYPE xf_uniacodec_runtime_init(struct XFUniaCodec *d,
 	d->in_size = 0;
 	d->consumed = 0;
 	d->out_size = 0;
+	d->segments.num = 0;
 
 	return ret;
 }
@@ -691,6 +741,25 @@ static UA_ERROR_TYPE xf_uniacodec_get_consumed_bytes(struct XFUniaCodec *d,
 	return ACODEC_SUCCESS;
 }
 
+/* NULL pointer queries if segments are accepted, which they always are */
+static UA_ERROR_TYPE xf_uniacodec_set_input_segments(struct XFUniaCodec *d,
+						      UWORD32 i_idx,
+						      void *pv_value)
+{
+	xa_codec_input_segments_t *seg = pv_value;
+
+	if (!seg) {
+		d->gather = 1;
+		return ACODEC_SUCCESS;
+	}
+
+	XF_CHK_ERR(seg->num <= XA_CODEC_INPUT_SEGMENTS_MAX, ACODEC_PARA_ERROR);
+
+	memcpy(&d->segments, seg, sizeof(*seg));
+
+	return ACODEC_SUCCESS;
+}
+
 static UA_ERROR_TYPE xf_uniacodec_input_over(struct XFUniaCodec *d,
 					      UWORD32 i_idx,
 					      void *pv_value)
@@ -855,6 +924,7 @@ static UA_ERROR_TYPE (* const xf_unia_codec_api[])(struct XFUniaCodec *, UWORD32
 	[XA_API_CMD_GET_OUTPUT_BYTES]         = xf_uniacodec_get_output_bytes,
 	[XA_API_CMD_GET_CURIDX_INPUT_BUF]     = xf_uniacodec_get_consumed_bytes,
 	[XA_API_CMD_INPUT_OVER]               = xf_uniacodec_input_over,
+	[XA_API_CMD_SET_INPUT_SEGMENTS]       = xf_uniacodec_set_input_segments,
 
 	[XA_API_CMD_GET_MEMTABS_SIZE]         = xa_uniacodec_get_memtabs_size,
 	[XA_API_CMD_SET_MEMTABS_PTR]          = xa_uniacodec_set_memtabs_ptr,
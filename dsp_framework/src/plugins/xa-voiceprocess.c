@@ -412,7 +412,8 @@ static XA_ERRORCODE xa_load_voice_lib(struct XAVoiceProc *d, void *pv_value)
 	lib_type = GET_LIB_TYPE(cmd->lib_type);
 
 	lib_stat = &d->lib_voice_wrap_stat;
-	d->voice_wrap_interface = (tUniACodecQueryInterface)dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0);
+	d->voice_wrap_interface = (tUniACodecQueryInterface)dpu_process_init_pi_lib(&cmd->pil_info, lib_stat, 0,
+				IS_LIB_CODE_SHARED(cmd->lib_type));
 	if (!d->voice_wrap_interface) {
 		LOG("load codec wrap lib failed\n");
 		return XA_API_FATAL_INVALID_CMD;
@@ -0,0 +1,260 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * sim_roundtrip.c - renderer to capturer round trip on the simulated device
+ *
+ * Runs the FSL renderer and capturer built with SIM_DEVICE on the ISS. The
+ * playback device writes into a memory ring that the capture device records
+ * from. The renderer plays a frame counter as 16-bit stereo, which the
+ * capturer records as 32-bit mono at the same byte rate, so every captured
+ * word is one played frame. Once the leading silence is over the counter
+ * must come back in order, without gaps, underruns or overruns.
+ *
+ * "make sim-test" builds and runs it. Not verified yet: it has not been
+ * built or run on the ISS.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <xtensa/xos.h>
+
+#include "mydefs.h"
+#include "sim_audio.h"
+#include "audio/xa-renderer-api.h"
+#include "audio/xa-capturer-api.h"
+
+#define SIM_RATE                48000
+#define SIM_FRAMES              256
+/* ...one period is SIM_FRAMES frames of 4 bytes on both sides */
+#define SIM_PERIOD_BYTES        (SIM_FRAMES * 4)
+#define SIM_RING_PERIODS        8
+#define SIM_CAPTURE_PERIODS     64
+
+#define SIM_POOL_SIZE           (512 * 1024)
+
+extern XA_ERRORCODE xa_renderer(xa_codec_handle_t, WORD32, WORD32, pVOID);
+extern XA_ERRORCODE xa_capturer(xa_codec_handle_t, WORD32, WORD32, pVOID);
+extern XAF_ERR_CODE xaf_malloc(void **buf_ptr, int size, int id);
+
+/* ...what main.c provides in the firmware */
+xf_dsp_t *xf_g_dsp;
+struct dsp_main_struct *g_dsp;
+
+static struct dsp_main_struct sim_dsp;
+static UWORD8 sim_pool[SIM_POOL_SIZE] __attribute__((aligned(64)));
+
+static UWORD8 loop_ring[SIM_PERIOD_BYTES * SIM_RING_PERIODS];
+static UWORD32 rend_buf[SIM_FRAMES];
+static UWORD32 cap_buf[SIM_FRAMES];
+
+/* ...both devices signal period completion here */
+static XosSem period_sem;
+
+static xa_renderer_cb_t rend_cb;
+static xa_capturer_cb_t cap_cb;
+
+struct dsp_main_struct *get_main_struct()
+{
+	return g_dsp;
+}
+
+/* ...there is no AP, hence no shared memory or IPC message queues */
+int xf_ipc_init(UWORD32 core)
+{
+	return 0;
+}
+
+int xf_ipc_deinit(UWORD32 core)
+{
+	return 0;
+}
+
+static void rend_period_done(xa_renderer_cb_t *cb, WORD32 idx)
+{
+	xos_sem_put(&period_sem);
+}
+
+static void cap_period_done(xa_capturer_cb_t *cb, WORD32 idx)
+{
+	xos_sem_put(&period_sem);
+}
+
+static void *sim_open(xa_codec_func_t *api)
+{
+	WORD32 size;
+	void *h = NULL;
+
+	if (api(NULL, XA_API_CMD_GET_API_SIZE, 0, &size))
+		return NULL;
+	xaf_malloc(&h, size, 0);
+	if (!h)
+		return NULL;
+	if (api(h, XA_API_CMD_INIT, XA_CMD_TYPE_INIT_API_PRE_CONFIG_PARAMS, NULL))
+		return NULL;
+
+	return h;
+}
+
+static int sim_set(xa_codec_func_t *api, void *h, WORD32 idx, WORD32 value)
+{
+	return api(h, XA_API_CMD_SET_CONFIG_PARAM, idx, &value);
+}
+
+static void *renderer_open(void)
+{
+	void *h = sim_open(xa_renderer);
+
+	if (!h)
+		return NULL;
+
+	rend_cb.cb = rend_period_done;
+	if (sim_set(xa_renderer, h, XA_RENDERER_CONFIG_PARAM_PCM_WIDTH, 16) ||
+	    sim_set(xa_renderer, h, XA_RENDERER_CONFIG_PARAM_CHANNELS, 2) ||
+	    sim_set(xa_renderer, h, XA_RENDERER_CONFIG_PARAM_SAMPLE_RATE, SIM_RATE) ||
+	    sim_set(xa_renderer, h, XA_RENDERER_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES, SIM_FRAMES) ||
+	    xa_renderer(h, XA_API_CMD_SET_CONFIG_PARAM, XA_RENDERER_CONFIG_PARAM_CB, &rend_cb) ||
+	    xa_renderer(h, XA_API_CMD_INIT, XA_CMD_TYPE_INIT_API_POST_CONFIG_PARAMS, NULL) ||
+	    xa_renderer(h, XA_API_CMD_SET_MEM_PTR, 0, rend_buf) ||
+	    xa_renderer(h, XA_API_CMD_INIT, XA_CMD_TYPE_INIT_PROCESS, NULL))
+		return NULL;
+
+	return h;
+}
+
+static void *capturer_open(void)
+{
+	void *h = sim_open(xa_capturer);
+
+	if (!h)
+		return NULL;
+
+	cap_cb.cb = cap_period_done;
+	if (sim_set(xa_capturer, h, XA_CAPTURER_CONFIG_PARAM_PCM_WIDTH, 32) ||
+	    sim_set(xa_capturer, h, XA_CAPTURER_CONFIG_PARAM_CHANNELS, 1) ||
+	    sim_set(xa_capturer, h, XA_CAPTURER_CONFIG_PARAM_SAMPLE_RATE, SIM_RATE) ||
+	    sim_set(xa_capturer, h, XA_CAPTURER_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES, SIM_FRAMES) ||
+	    xa_capturer(h, XA_API_CMD_SET_CONFIG_PARAM, XA_CAPTURER_CONFIG_PARAM_CB, &cap_cb) ||
+	    xa_capturer(h, XA_API_CMD_INIT, XA_CMD_TYPE_INIT_API_POST_CONFIG_PARAMS, NULL) ||
+	    xa_capturer(h, XA_API_CMD_SET_MEM_PTR, 0, cap_buf) ||
+	    xa_capturer(h, XA_API_CMD_INIT, XA_CMD_TYPE_INIT_PROCESS, NULL))
+		return NULL;
+
+	return h;
+}
+
+/* ...queue periods while the renderer takes them; returns the next frame */
+static UWORD32 renderer_feed(void *rend, UWORD32 frame)
+{
+	WORD32 bytes = SIM_PERIOD_BYTES;
+	WORD32 consumed;
+	int i;
+
+	for (;;) {
+		/* ...left channel carries the low half, right the high half */
+		for (i = 0; i < SIM_FRAMES; i++)
+			rend_buf[i] = frame + i;
+
+		xa_renderer(rend, XA_API_CMD_SET_INPUT_BYTES, 0, &bytes);
+		xa_renderer(rend, XA_API_CMD_EXECUTE, XA_CMD_TYPE_DO_EXECUTE, NULL);
+		xa_renderer(rend, XA_API_CMD_GET_CURIDX_INPUT_BUF, 0, &consumed);
+		if (consumed == 0)
+			return frame;
+
+		frame += SIM_FRAMES;
+	}
+}
+
+/* ...check captured periods; returns the number of errors */
+static int capturer_check(void *cap, UWORD32 *expect, int *periods)
+{
+	WORD32 produced;
+	int i, errors = 0;
+
+	for (;;) {
+		xa_capturer(cap, XA_API_CMD_EXECUTE, XA_CMD_TYPE_DO_EXECUTE, NULL);
+		xa_capturer(cap, XA_API_CMD_GET_OUTPUT_BYTES, 0, &produced);
+		if (produced == 0)
+			return errors;
+
+		(*periods)++;
+		for (i = 0; i < produced / 4; i++) {
+			/* ...silence until the first played frame comes round */
+			if (*expect == 0 && cap_buf[i] == 0)
+				continue;
+			if (*expect == 0)
+				*expect = cap_buf[i];
+			if (cap_buf[i] != *expect) {
+				if (errors++ < 8)
+					printf("period %d, word %d: got %u, expected %u\n",
+					       *periods, i, cap_buf[i], *expect);
+				*expect = cap_buf[i];
+			}
+			(*expect)++;
+		}
+	}
+}
+
+int main(void)
+{
+	void *rend, *cap;
+	UWORD32 frame = 1, expect = 0;
+	WORD32 value;
+	int periods = 0, errors = 0;
+
+	xos_start_main("main", 7, 0);
+	xos_start_system_timer(-1, 0);
+	xos_sem_create(&period_sem, 0, 0);
+
+	g_dsp = &sim_dsp;
+	xf_g_dsp = &sim_dsp.xf_dsp;
+	XF_CHK_API(xf_mm_init(&XF_CORE_DATA(0)->local_pool, sim_pool, SIM_POOL_SIZE));
+	XF_CHK_API(xf_core_init(0));
+
+	/* ...the capture device records what the playback device plays */
+	sim_audio_set_mem(sim_audio_get(1), loop_ring, sizeof(loop_ring));
+	sim_audio_set_mem(sim_audio_get(0), loop_ring, sizeof(loop_ring));
+
+	rend = renderer_open();
+	cap = capturer_open();
+	if (!rend || !cap) {
+		printf("sim roundtrip: init failed\n");
+		return -1;
+	}
+
+	/* ...the renderer starts once its ring is full */
+	frame = renderer_feed(rend, frame);
+	value = XA_CAPTURER_STATE_START;
+	xa_capturer(cap, XA_API_CMD_SET_CONFIG_PARAM, XA_CAPTURER_CONFIG_PARAM_STATE, &value);
+
+	while (periods < SIM_CAPTURE_PERIODS) {
+		xos_sem_get(&period_sem);
+		frame = renderer_feed(rend, frame);
+		errors += capturer_check(cap, &expect, &periods);
+	}
+
+	if (expect == 0) {
+		printf("sim roundtrip: nothing captured\n");
+		errors++;
+	}
+
+	xa_renderer(rend, XA_API_CMD_GET_CONFIG_PARAM, XA_RENDERER_CONFIG_PARAM_UNDERRUN_COUNT, &value);
+	if (value) {
+		printf("sim roundtrip: %d renderer underruns\n", value);
+		errors++;
+	}
+	xa_capturer(cap, XA_API_CMD_GET_CONFIG_PARAM, XA_CAPTURER_CONFIG_PARAM_OVERRUN_COUNT, &value);
+	if (value) {
+		printf("sim roundtrip: %d capturer overruns\n", value);
+		errors++;
+	}
+
+	/* ...releasing the DMA channels stops both devices */
+	xa_renderer(rend, XA_API_CMD_DEINIT, 0, NULL);
+	xa_capturer(cap, XA_API_CMD_DEINIT, 0, NULL);
+
+	printf("sim roundtrip: %u frames played, %d periods captured, %s\n",
+	       frame - 1, periods, errors ? "FAILED" : "PASSED");
+
+	return errors ? -1 : 0;
+}
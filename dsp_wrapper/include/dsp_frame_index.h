@@ -0,0 +1,46 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Frame index for compressed streams.
+ *
+ * A background thread walks the frame headers of an MP3, ADTS or AMR
+ * storage format file and records where every frame starts, so a seek can
+ * restart decoding exactly on a frame boundary instead of letting the
+ * decoder resync on garbage.
+ */
+
+#ifndef _DSP_FRAME_INDEX_H_
+#define _DSP_FRAME_INDEX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum dsp_frame_index_type {
+	DSP_FRAME_INDEX_MP3,        /* MPEG 1/2/2.5 audio layer 1/2/3 */
+	DSP_FRAME_INDEX_ADTS,       /* AAC in ADTS */
+	DSP_FRAME_INDEX_AMR_NB,     /* "#!AMR\n" storage format */
+	DSP_FRAME_INDEX_AMR_WB,     /* "#!AMR-WB\n" storage format */
+};
+
+struct dsp_frame_index;
+
+struct dsp_frame_index *dsp_frame_index_create(enum dsp_frame_index_type type);
+void dsp_frame_index_destroy(struct dsp_frame_index *idx);
+
+/* start indexing a file in the background, returns 0 or -errno */
+int dsp_frame_index_build(struct dsp_frame_index *idx, const char *path);
+
+/* true once the whole file is indexed */
+bool dsp_frame_index_done(struct dsp_frame_index *idx);
+
+/*
+ * dsp_frame_index_lookup - find the last frame starting at or before time_us
+ *
+ * Returns: 0 on success, -EAGAIN if the index does not reach time_us yet,
+ *          -ENOENT if the file has no frames
+ */
+int dsp_frame_index_lookup(struct dsp_frame_index *idx, uint64_t time_us,
+			   uint64_t *offset, uint64_t *frame_time_us);
+
+#endif /* _DSP_FRAME_INDEX_H_ */
@@ -0,0 +1,72 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * PCM channel and sample format conversion for decoded DSP output.
+ *
+ * All kernels work on little endian interleaved data unless noted. NEON is
+ * used when the wrapper is built for ARM, a portable C version otherwise.
+ * The functions are exported by the wrapper library so applications can
+ * reuse them on the data returned by the decoder.
+ */
+
+#ifndef _DSP_PCM_CONVERT_H_
+#define _DSP_PCM_CONVERT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum dsp_pcm_format {
+	DSP_PCM_S16_LE,         /* 16 bit in 2 bytes */
+	DSP_PCM_S24_3LE,        /* 24 bit packed in 3 bytes */
+	DSP_PCM_S24_LE,         /* 24 bit in the low bytes of 4, sign extended */
+	DSP_PCM_S32_LE,         /* 32 bit in 4 bytes */
+};
+
+/* bytes per sample of a format, 0 for an unknown format */
+uint32_t dsp_pcm_format_width(enum dsp_pcm_format fmt);
+
+/*
+ * dsp_pcm_convert - convert samples between formats
+ *
+ * Narrowing truncates the low bits, widening fills them with zeros.
+ * dst may be the same as src when the destination is not wider.
+ *
+ * Returns: 0 on success, -1 for an unknown format
+ */
+int dsp_pcm_convert(void *dst, enum dsp_pcm_format dst_fmt,
+		    const void *src, enum dsp_pcm_format src_fmt,
+		    uint32_t samples);
+
+/*
+ * dsp_pcm_drop_channels - keep the first out_ch channels of every frame
+ *
+ * dst may be the same as src.
+ */
+void dsp_pcm_drop_channels(void *dst, const void *src, uint32_t frames,
+			   uint32_t in_ch, uint32_t out_ch, uint32_t width);
+
+/*
+ * dsp_pcm_dup_channel - duplicate a mono stream to out_ch channels
+ *
+ * dst and src must not overlap.
+ */
+void dsp_pcm_dup_channel(void *dst, const void *src, uint32_t frames,
+			 uint32_t out_ch, uint32_t width);
+
+/* planar src[channels] to interleaved dst, buffers must not overlap */
+void dsp_pcm_interleave(void *dst, const void *const src[], uint32_t frames,
+			uint32_t channels, uint32_t width);
+
+/* interleaved src to planar dst[channels], buffers must not overlap */
+void dsp_pcm_deinterleave(void *const dst[], const void *src, uint32_t frames,
+			  uint32_t channels, uint32_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DSP_PCM_CONVERT_H_ */
@@ -53,6 +53,8 @@
 
 #include "fsl_unia.h"
 #include "dsp_codec_interface.h"
+#include "dsp_pcm_convert.h"
+#include "dsp_frame_index.h"
 
 /* ...size of auxiliary pool for communication with DSP */
 #define XA_AUX_POOL_SIZE                32
@@ -77,8 +79,13 @@
 #define WBAMR_SERIAL_FRAMESIZE                 480
 #define MAX_WBAMR_PACKET_MIME_IF1_IF2   63
 
-/* Enlarge outbuf size for receive wma10 output */
-#define OUTBUF_SIZE                     8192*3*8*2
+/* ...number of input and output buffers in flight to DSP */
+#ifndef DSP_INBUF_NUM
+#define DSP_INBUF_NUM                   2
+#endif
+#ifndef DSP_OUTBUF_NUM
+#define DSP_OUTBUF_NUM                  2
+#endif
 /* size of parameter buffer for pass complex parameter */
 #define PARAM_SIZE                      120
 
@@ -285,6 +292,7 @@ struct innerBuf {
 	UWORD32 inner_offset;        /* offset of inner buffer */
 	UWORD32 buf_size;            /* total buf size */
 	UWORD32 threshold;           /* threshold of the input buffer*/
+	bool mirrored;               /* ring mapped twice, offset wraps */
 };
 
 struct DSP_Handle {
@@ -316,13 +324,24 @@ struct DSP_Handle {
 	UWORD32 layout_bak[UA_CHANNEL_MAX];
 	bool ID3flag;
 	UWORD32 tagsize;
+	struct dsp_frame_index *frame_index;
 
 /****************DSP******************/
-	xaf_adev_t *p_adev;
-	xaf_adev_config_t adev_config;
+	xaf_adev_t *p_adev;            /* shared unless adev_private */
+	xaf_adev_config_t adev_config; /* config of a private device */
+	bool adev_private;
 	xaf_comp_t *p_comp;
 	xaf_comp_status comp_status;
-	WORD32 saved_comp_status;
+
+	/* ...buffers held by the wrapper, not queued to DSP */
+	void *inbuf_free[XAF_MAX_INBUFS];
+	UWORD32 inbuf_free_num;
+	void *outbuf_free[XAF_MAX_OUTBUFS];
+	UWORD32 outbuf_free_num;
+	/* ...output buffers handed to the caller in zero copy mode */
+	void *outbuf_held[XAF_MAX_OUTBUFS];
+	UWORD32 outbuf_held_num;
+	bool zero_copy;
 
 	AUDIOFORMAT audio_type;
 	WORD32 codec_type;
@@ -332,7 +351,6 @@ struct DSP_Handle {
 	bool memory_allocated;
 	bool depth_is_set;
 	bool input_over;
-	bool inptr_busy, outptr_busy;
 	bool codecdata_copy;
 	bool codecdata_ignored;
 	unsigned int codecoffset;
@@ -348,6 +366,12 @@ UA_ERROR_TYPE InputBufHandle(struct innerBuf *inner_buf,
 UA_ERROR_TYPE ResetInnerBuf(struct innerBuf *inner_buf,
 			    UWORD32 buf_size,
 			    UWORD32 threshold);
+void InnerBufConsume(struct innerBuf *inner_buf, UWORD32 size);
+UA_ERROR_TYPE InnerBufAlloc(struct innerBuf *inner_buf,
+			    UniACodecMemoryOps *memOps,
+			    UWORD32 buf_size,
+			    UWORD32 threshold);
+void InnerBufFree(struct innerBuf *inner_buf, UniACodecMemoryOps *memOps);
 UA_ERROR_TYPE SetDefaultFeature(UniACodec_Handle pua_handle);
 void cancel_unused_channel_data(UWORD8 *data_in, WORD32 length, WORD32 depth);
 
@@ -355,10 +379,12 @@ int comp_process(UniACodec_Handle pua_handle,
 		 UWORD8 *input,
 		 UWORD32 in_size,
 		 UWORD32 *in_off,
-		 UWORD8 *output,
+		 UWORD8 **output,
 		 UWORD32 *out_size);
+int comp_release_output(UniACodec_Handle pua_handle, UWORD8 *output);
 
 int comp_flush_msg(UniACodec_Handle pua_handle);
+void comp_reset_buffers(struct DSP_Handle *pDSP_handle);
 
 const char *DSPDecVersionInfo();
 UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type);
@@ -376,6 +402,8 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 				UWORD32 *offset,
 				UWORD8 **OutputBuf,
 				UWORD32 *OutputSize);
+UA_ERROR_TYPE DSPDecReleaseOutput(UniACodec_Handle pua_handle,
+				  UWORD8 *OutputBuf);
 char *DSPDecLastErr(UniACodec_Handle pua_handle);
 
 #endif //_DSP_WRAP_H_
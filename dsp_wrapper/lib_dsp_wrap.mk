@@ -55,6 +55,13 @@ endif
 CARM += -DTGT_OS_ANDROID
 endif
 
+# LOOPBACK=1 runs the proxy against an emulated DSP, for hosts without one
+ifeq ($(LOOPBACK),1)
+OBJ_DIR     = object_loopback
+LIBRARY    := $(LIBRARY)_loopback
+CARM += -DXF_IPC_LOOPBACK
+endif
+
 ifeq ($(DEBUG),1)
         CARM    += -DDEBUG
 	#-DXF_TRACE
@@ -71,6 +78,8 @@ endif
 # Put the C files here
 C_OBJS	    = $(OBJ_DIR)/dsp_wrap.o
 C_OBJS	   += $(OBJ_DIR)/dsp_dec.o           \
+              $(OBJ_DIR)/dsp_pcm_convert.o   \
+              $(OBJ_DIR)/dsp_frame_index.o   \
               $(OBJ_DIR)/xaf-fsl-api.o       \
               $(OBJ_DIR)/library_load.o      \
               $(OBJ_DIR)/xf-fsl-ipc.o        \
@@ -80,6 +89,11 @@ C_OBJS	   += $(OBJ_DIR)/dsp_dec.o           \
 
 SONAME = lib_$(PROGRAM)_$(TGT_OS_BIN).so.$(VERSION)
 
+ifeq ($(LOOPBACK),1)
+C_OBJS	   += $(OBJ_DIR)/xf-fsl-loopback.o
+SONAME = lib_$(PROGRAM)_$(TGT_OS_BIN)_loopback.so.$(VERSION)
+endif
+
 #Include only 'c' files for unix build
 ifeq ($(BUILD),UNIX)
 	OBJS = $(C_OBJS)
@@ -140,4 +154,5 @@ usage:
 	@echo "		 =ARM12ANDROID - builds for ARM12 "
 	@echo "		 =ARMV8ELINUX  - builds for ARMV8 "
 	@echo "		 =ARMV8ANDROID - builds for ARMV8 "
+	@echo "            LOOPBACK=1 - emulated DSP, no hardware needed"
 	@echo " "
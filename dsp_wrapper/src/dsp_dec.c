@@ -24,6 +24,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <sys/syscall.h>
 #include "xf-types.h"
 #include "dsp_wrap.h"
 
@@ -73,7 +74,9 @@ UA_ERROR_TYPE  InputBufHandle(struct innerBuf *inner_buf,
 			ret = ACODEC_NOT_ENOUGH_DATA;
 	}
 
-	if ((*inner_offset != 0) && (bufsize - (*inner_offset)) < threshold) {
+	/* ...a mirrored ring never needs compaction, data wraps in place */
+	if (!inner_buf->mirrored && (*inner_offset != 0) &&
+	    (bufsize - (*inner_offset)) < threshold) {
 		memmove(inner_data, inner_data + (*inner_offset), *inner_size);
 		*inner_offset = 0;
 	}
@@ -93,6 +96,126 @@ UA_ERROR_TYPE  InputBufHandle(struct innerBuf *inner_buf,
 	return ret;
 }
 
+/*
+ * InnerBufConsume - drop data from the head of the inner buffer
+ *
+ * @inner_buf : inner buffer
+ * @size      : number of bytes consumed
+ */
+void InnerBufConsume(struct innerBuf *inner_buf, UWORD32 size)
+{
+	inner_buf->inner_offset += size;
+	inner_buf->inner_size -= size;
+
+	if (inner_buf->mirrored)
+		inner_buf->inner_offset &= inner_buf->buf_size - 1;
+}
+
+#ifdef SYS_memfd_create
+/* map the same pages twice back to back, returns NULL if not possible */
+static UWORD8 *inner_buf_map_ring(UWORD32 size)
+{
+	UWORD8 *addr;
+	int fd;
+
+	fd = syscall(SYS_memfd_create, "dsp_inner_buf", 0);
+	if (fd < 0)
+		return NULL;
+
+	if (ftruncate(fd, size))
+		goto err_close;
+
+	/* ...reserve both halves first so nothing else lands in between */
+	addr = mmap(NULL, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED)
+		goto err_close;
+
+	if (mmap(addr, size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+	    mmap(addr + size, size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(addr, size * 2);
+		goto err_close;
+	}
+
+	close(fd);
+	return addr;
+
+err_close:
+	close(fd);
+	return NULL;
+}
+#endif
+
+/*
+ * InnerBufAlloc - allocate the inner buffer
+ *
+ * On Linux the buffer is a power of two ring whose pages are mapped twice,
+ * so data at the read offset is always contiguous and is never moved once
+ * written. Otherwise fall back to a linear buffer from memOps, which gets
+ * compacted when it runs out of room.
+ *
+ * @inner_buf : inner buffer
+ * @memOps    : memory operations of the wrapper
+ * @buf_size  : minimum inner buffer size
+ * @threshold : threshold of data size in inner buffer
+ * Returns:
+ *          ACODEC_SUCCESS: inner buffer allocated
+ *          ACODEC_INSUFFICIENT_MEM: allocation failed
+ */
+UA_ERROR_TYPE InnerBufAlloc(struct innerBuf *inner_buf,
+			    UniACodecMemoryOps *memOps,
+			    UWORD32 buf_size,
+			    UWORD32 threshold)
+{
+	memset(inner_buf, 0, sizeof(*inner_buf));
+	inner_buf->threshold = threshold;
+
+#ifdef SYS_memfd_create
+	{
+		UWORD32 ring_size = sysconf(_SC_PAGESIZE);
+
+		while (ring_size < buf_size)
+			ring_size <<= 1;
+
+		inner_buf->data = inner_buf_map_ring(ring_size);
+		if (inner_buf->data) {
+			inner_buf->buf_size = ring_size;
+			inner_buf->mirrored = true;
+			return ACODEC_SUCCESS;
+		}
+	}
+#endif
+
+	inner_buf->data = memOps->Malloc(buf_size);
+	if (!inner_buf->data)
+		return ACODEC_INSUFFICIENT_MEM;
+
+	inner_buf->buf_size = buf_size;
+	memset(inner_buf->data, 0, buf_size);
+
+	return ACODEC_SUCCESS;
+}
+
+/*
+ * InnerBufFree - release the inner buffer
+ *
+ * @inner_buf : inner buffer
+ * @memOps    : memory operations of the wrapper
+ */
+void InnerBufFree(struct innerBuf *inner_buf, UniACodecMemoryOps *memOps)
+{
+	if (!inner_buf->data)
+		return;
+
+	if (inner_buf->mirrored)
+		munmap(inner_buf->data, inner_buf->buf_size * 2);
+	else
+		memOps->Free(inner_buf->data);
+
+	inner_buf->data = NULL;
+}
+
 /*
  * ResetInnerBuf - Reset the inner buffer data
  *
@@ -208,39 +331,117 @@ UA_ERROR_TYPE SetDefaultFeature(UniACodec_Handle pua_handle)
  * @depth: width of sample
  */
 void cancel_unused_channel_data(UWORD8 *data_in, WORD32 length, WORD32 depth)
+{
+	UWORD32 width = depth / 8;
+
+	if (depth != 16 && depth != 24)
+		return;
+
+	dsp_pcm_drop_channels(data_in, data_in, length / (2 * width), 2, 1, width);
+}
+
+static bool comp_find_buf(void **list, UWORD32 num, void *buf)
 {
 	UWORD32 i;
-	UWORD8 *ptr1, *ptr2;
 
-	if (depth == 16) {
-		ptr1 = data_in + 2;
-		ptr2 = data_in + 4;
+	for (i = 0; i < num; i++) {
+		if (list[i] == buf)
+			return true;
+	}
 
-		for (i = 1; i < length / 4; i++) {
-			*ptr1++ = *ptr2;
-			*ptr1++ = *(ptr2 + 1);
+	return false;
+}
 
-			ptr2 += 4;
-		}
-	} else if (depth == 24) {
-		ptr1 = data_in + 3;
-		ptr2 = data_in + 6;
+/*
+ * comp_reset_buffers - hand all component buffers back to the wrapper
+ *
+ * @pDSP_handle: DSP handle
+ *
+ * Called on creation and once the DSP returned every buffer, e.g. at the
+ * end of stream. Output buffers exist only after init is done.
+ */
+void comp_reset_buffers(struct DSP_Handle *pDSP_handle)
+{
+	xaf_comp_t *p_decoder = pDSP_handle->p_comp;
+	UWORD32 i;
+
+	for (i = 0; i < p_decoder->ninbuf; i++)
+		pDSP_handle->inbuf_free[i] = p_decoder->p_input[i];
+	pDSP_handle->inbuf_free_num = p_decoder->ninbuf;
+
+	/* ...buffers still held by the caller are queued on release */
+	pDSP_handle->outbuf_free_num = 0;
+	for (i = 0; p_decoder->outpool && i < p_decoder->noutbuf; i++) {
+		if (!comp_find_buf(pDSP_handle->outbuf_held,
+				   pDSP_handle->outbuf_held_num,
+				   p_decoder->pout_buf[i]))
+			pDSP_handle->outbuf_free[pDSP_handle->outbuf_free_num++] =
+				p_decoder->pout_buf[i];
+	}
+}
 
-		for (i = 1; i < length / 6; i++) {
-			*ptr1++ = *ptr2;
-			*ptr1++ = *(ptr2 + 1);
-			*ptr1++ = *(ptr2 + 2);
+/* put a buffer returned by DSP on the free list, unknown buffers are ignored */
+static void comp_put_buf(void **free_list, UWORD32 *free_num,
+			 void **bufs, UWORD32 num, void *buf)
+{
+	if (comp_find_buf(free_list, *free_num, buf) ||
+	    !comp_find_buf(bufs, num, buf))
+		return;
 
-			ptr2 += 6;
+	free_list[(*free_num)++] = buf;
+}
+
+/* remove a buffer from a list, returns false if it is not there */
+static bool comp_take_buf(void **list, UWORD32 *num, void *buf)
+{
+	UWORD32 i;
+
+	for (i = 0; i < *num; i++) {
+		if (list[i] == buf) {
+			list[i] = list[--(*num)];
+			return true;
 		}
 	}
+
+	return false;
+}
+
+/* queue the free output buffers to DSP again, sized as the codec reported at init */
+static int comp_queue_outbuf(struct DSP_Handle *pDSP_handle)
+{
+	xaf_comp_t *p_decoder = pDSP_handle->p_comp;
+	void *buf;
+	int error = 0;
+
+	while (pDSP_handle->outbuf_free_num && p_decoder->expect_out_cmd) {
+		buf = pDSP_handle->outbuf_free[pDSP_handle->outbuf_free_num - 1];
+		error = xaf_comp_process(NULL, p_decoder, buf,
+					 p_decoder->out_format.output_length[0],
+					 XAF_NEED_OUTPUT_FLAG);
+		if (error)
+			break;
+		pDSP_handle->outbuf_free_num--;
+	}
+
+	return error;
 }
 
+/*
+ * comp_process - feed input to DSP and collect one response
+ *
+ * Every free input buffer gets the next compressed chunk and every free
+ * output buffer is queued again right away, so DSP decodes the next frame
+ * while the caller handles the current one.
+ *
+ * Decoded data is copied to *output. In zero copy mode with *output NULL,
+ * *output returns the DSP buffer itself, which stays with the caller until
+ * comp_release_output().
+ */
 int comp_process(UniACodec_Handle pua_handle,
 		 UWORD8 *input,
 		 UWORD32 in_size,
 		 UWORD32 *in_off,
-		 UWORD8 *output,
+		 UWORD8 **output,
 		 UWORD32 *out_size)
 {
 	struct DSP_Handle *pDSP_handle = (struct DSP_Handle *)pua_handle;
@@ -252,19 +453,26 @@ int comp_process(UniACodec_Handle pua_handle,
 	long *p_buf = NULL;
 	long size = 0;
 
-	if (!input || !output)
+	if (!input || !output || (!*output && !pDSP_handle->zero_copy))
 		return ACODEC_PARA_ERROR;
 
 	if (*comp_status == XAF_STARTING) {
 		error = xaf_comp_process(p_adev, p_decoder, NULL, 0, XAF_START_FLAG);
 	}
 
-	if (!pDSP_handle->inptr_busy && !pDSP_handle->input_over) {
+	/* ...DSP can not make progress without an output buffer, keep the input */
+	if (p_decoder->outpool && pDSP_handle->outbuf_held_num == p_decoder->noutbuf) {
+		fprintf(stderr, "all output buffers held, release one first\n");
+		return ACODEC_NO_OUTPUT;
+	}
+
+	if (pDSP_handle->inbuf_free_num && !pDSP_handle->input_over) {
 		if (in_size) {
-			memcpy(p_decoder->p_input[0], input, in_size);
+			void *inbuf = pDSP_handle->inbuf_free[--pDSP_handle->inbuf_free_num];
+
+			memcpy(inbuf, input, in_size);
 			*in_off = in_size;
-			/* only use input buf0 */
-			error = xaf_comp_process(p_adev, p_decoder, p_decoder->p_input[0], in_size, XAF_INPUT_READY_FLAG);
+			error = xaf_comp_process(p_adev, p_decoder, inbuf, in_size, XAF_INPUT_READY_FLAG);
 		} else {
 			*in_off = 0;
 			pDSP_handle->input_over = 1;
@@ -274,24 +482,20 @@ int comp_process(UniACodec_Handle pua_handle,
 			fprintf(stderr, "inbuf error: %d\n", error);
 			return ACODEC_ERROR_STREAM;
 		}
-		pDSP_handle->inptr_busy = true;
 	}
 
 send_output:
 
-	if (!pDSP_handle->outptr_busy) {
-		if (*comp_status == XAF_INIT_DONE) {
-			error = xaf_comp_process(NULL, p_decoder, NULL, 0, XAF_EXEC_FLAG);
-			pDSP_handle->outptr_busy = true;
-		} else if (*comp_status == XAF_OUTPUT_READY || pDSP_handle->saved_comp_status == XAF_OUTPUT_READY) {
-			error = xaf_comp_process(NULL, p_decoder, p_decoder->pout_buf[0], OUTBUF_SIZE, XAF_NEED_OUTPUT_FLAG);
-			pDSP_handle->saved_comp_status = -1;
-			pDSP_handle->outptr_busy = true;
-		}
-		if (error) {
-			fprintf(stderr, "outbuf error: %d\n", error);
-			return ACODEC_ERROR_STREAM;
-		}
+	if (*comp_status == XAF_INIT_DONE) {
+		/* ...exec queues all output buffers */
+		error = xaf_comp_process(NULL, p_decoder, NULL, 0, XAF_EXEC_FLAG);
+		pDSP_handle->outbuf_free_num = 0;
+	} else {
+		error = comp_queue_outbuf(pDSP_handle);
+	}
+	if (error) {
+		fprintf(stderr, "outbuf error: %d\n", error);
+		return ACODEC_ERROR_STREAM;
 	}
 
 	/* ...wait until result is delivered */
@@ -324,9 +528,7 @@ send_output:
 		fprintf(stdout, "xaf_comp_get_status exec done\n");
 #endif
 		pDSP_handle->input_over = 0;
-		pDSP_handle->outptr_busy = false;
-		pDSP_handle->inptr_busy = false;
-		pDSP_handle->saved_comp_status = XAF_OUTPUT_READY;
+		comp_reset_buffers(pDSP_handle);
 		return ACODEC_END_OF_STREAM;
 	case XAF_INIT_DONE:
 #ifdef DEBUG
@@ -338,7 +540,8 @@ send_output:
 	case XAF_NEED_INPUT:
 		p_buf = (long *)comp_info[0];
 		size = comp_info[1];
-		pDSP_handle->inptr_busy = false;
+		comp_put_buf(pDSP_handle->inbuf_free, &pDSP_handle->inbuf_free_num,
+			     p_decoder->p_input, p_decoder->ninbuf, p_buf);
 #ifdef DEBUG
 		fprintf(stdout, "xaf need input\n");
 #endif
@@ -346,12 +549,33 @@ send_output:
 	case XAF_OUTPUT_READY:
 		p_buf = (long *)comp_info[0];
 		size = comp_info[1];
+		if (p_buf && size && !*output) {
+			/* ...only a pool buffer not yet held can be lent out */
+			if (!comp_find_buf(p_decoder->pout_buf, p_decoder->noutbuf, p_buf) ||
+			    comp_find_buf(pDSP_handle->outbuf_held,
+					  pDSP_handle->outbuf_held_num, p_buf)) {
+				fprintf(stderr, "unknown output buffer %p\n", p_buf);
+				return ACODEC_ERROR_STREAM;
+			}
+			/* ...zero copy, caller owns the buffer until release */
+			*output = (UWORD8 *)p_buf;
+			*out_size = size;
+			pDSP_handle->outbuf_held[pDSP_handle->outbuf_held_num++] = p_buf;
+			return ACODEC_SUCCESS;
+		}
 		if (p_buf && size) {
-			memcpy(output, p_buf, size);
+			memcpy(*output, p_buf, size);
 			*out_size = size;
 		}
-		pDSP_handle->outptr_busy = false;
-		pDSP_handle->saved_comp_status = *comp_status;
+		comp_put_buf(pDSP_handle->outbuf_free, &pDSP_handle->outbuf_free_num,
+			     p_decoder->pout_buf, p_decoder->noutbuf, p_buf);
+
+		/* ...let DSP decode into it while the caller consumes this frame */
+		error = comp_queue_outbuf(pDSP_handle);
+		if (error) {
+			fprintf(stderr, "outbuf error: %d\n", error);
+			return ACODEC_ERROR_STREAM;
+		}
 #ifdef DEBUG
 		fprintf(stdout, "xaf output ready\n");
 #endif
@@ -362,6 +586,30 @@ send_output:
 	}
 }
 
+/*
+ * comp_release_output - queue an output buffer held by the caller again
+ *
+ * @pua_handle: DSP handle
+ * @output: buffer returned by comp_process() in zero copy mode
+ */
+int comp_release_output(UniACodec_Handle pua_handle, UWORD8 *output)
+{
+	struct DSP_Handle *pDSP_handle = (struct DSP_Handle *)pua_handle;
+	xaf_comp_t *p_decoder = pDSP_handle->p_comp;
+
+	if (!comp_take_buf(pDSP_handle->outbuf_held,
+			   &pDSP_handle->outbuf_held_num, output))
+		return ACODEC_PARA_ERROR;
+
+	comp_put_buf(pDSP_handle->outbuf_free, &pDSP_handle->outbuf_free_num,
+		     p_decoder->pout_buf, p_decoder->noutbuf, output);
+
+	if (comp_queue_outbuf(pDSP_handle))
+		return ACODEC_ERROR_STREAM;
+
+	return ACODEC_SUCCESS;
+}
+
 int comp_flush_msg(UniACodec_Handle pua_handle)
 {
 	int error;
@@ -390,17 +638,19 @@ int comp_flush_msg(UniACodec_Handle pua_handle)
 		case XAF_PROBE_DONE:
 			return ACODEC_ERROR_STREAM;
 		case XAF_EXEC_DONE:
-			pDSP_handle->outptr_busy = false;
-			pDSP_handle->inptr_busy = false;
-			pDSP_handle->saved_comp_status = XAF_OUTPUT_READY;
+			comp_reset_buffers(pDSP_handle);
 			break;
 		case XAF_NEED_INPUT:
-			pDSP_handle->inptr_busy = false;
+			comp_put_buf(pDSP_handle->inbuf_free, &pDSP_handle->inbuf_free_num,
+				     p_decoder->p_input, p_decoder->ninbuf,
+				     (void *)comp_info[0]);
 			break;
 		case XAF_INIT_DONE:
+			break;
 		case XAF_OUTPUT_READY:
-			pDSP_handle->outptr_busy = false;
-			pDSP_handle->saved_comp_status = *comp_status;
+			comp_put_buf(pDSP_handle->outbuf_free, &pDSP_handle->outbuf_free_num,
+				     p_decoder->pout_buf, p_decoder->noutbuf,
+				     (void *)comp_info[0]);
 			break;
 		default:
 			return ACODEC_ERR_UNKNOWN;
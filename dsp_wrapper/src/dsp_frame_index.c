@@ -0,0 +1,423 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "dsp_frame_index.h"
+
+#define SCAN_CHUNK              (64 * 1024)
+#define MAX_HEADER_LEN          10
+
+struct frame_entry {
+	uint64_t offset;            /* byte offset of the frame header */
+	uint64_t sample;            /* first sample of the frame */
+};
+
+struct frame_info {
+	uint32_t size;              /* frame size in bytes, header included */
+	uint32_t samples;           /* samples per channel in the frame */
+	uint32_t rate;
+	uint32_t fixed;             /* header bits that stay the same */
+};
+
+struct dsp_frame_index {
+	enum dsp_frame_index_type type;
+	pthread_mutex_t lock;
+	pthread_t thread;
+	bool thread_started;
+	volatile bool stop;
+	bool done;
+	int fd;
+
+	struct frame_entry *entries;
+	uint32_t num;
+	uint32_t size;
+	uint32_t rate;
+	uint64_t total_samples;
+};
+
+/* buffered pread window over the file */
+struct scan_reader {
+	int fd;
+	uint8_t *buf;
+	uint64_t pos;
+	uint32_t len;
+};
+
+static const uint8_t *scan_peek(struct scan_reader *r, uint64_t off, uint32_t n)
+{
+	ssize_t got;
+
+	if (off >= r->pos && off + n <= r->pos + r->len)
+		return r->buf + (off - r->pos);
+
+	got = pread(r->fd, r->buf, SCAN_CHUNK, off);
+	r->pos = off;
+	r->len = (got > 0) ? got : 0;
+
+	return (n <= r->len) ? r->buf : NULL;
+}
+
+static const uint16_t mp3_bitrate[2][3][15] = {
+	{	/* MPEG 1: layer 1, 2, 3 */
+		{ 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+		{ 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+		{ 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },
+	},
+	{	/* MPEG 2 and 2.5: layer 1, 2, 3 */
+		{ 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+		{ 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+		{ 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+	},
+};
+
+static const uint32_t mp3_rate[3] = { 44100, 48000, 32000 };
+
+static int mp3_parse(const uint8_t *h, struct frame_info *fi)
+{
+	uint32_t version, layer, br_idx, sr_idx, pad, br;
+
+	if (h[0] != 0xff || (h[1] & 0xe0) != 0xe0)
+		return -1;
+
+	version = (h[1] >> 3) & 3;      /* 0: 2.5, 2: 2, 3: 1 */
+	layer = 4 - ((h[1] >> 1) & 3);  /* 4 means reserved */
+	br_idx = h[2] >> 4;
+	sr_idx = (h[2] >> 2) & 3;
+	pad = (h[2] >> 1) & 1;
+
+	if (version == 1 || layer == 4 || br_idx == 0 || br_idx == 15 || sr_idx == 3)
+		return -1;
+
+	br = mp3_bitrate[version != 3][layer - 1][br_idx] * 1000;
+	fi->rate = mp3_rate[sr_idx] >> (version == 3 ? 0 : (version == 2 ? 1 : 2));
+
+	if (layer == 1) {
+		fi->size = (12 * br / fi->rate + pad) * 4;
+		fi->samples = 384;
+	} else if (layer == 2 || version == 3) {
+		fi->size = 144 * br / fi->rate + pad;
+		fi->samples = 1152;
+	} else {
+		fi->size = 72 * br / fi->rate + pad;
+		fi->samples = 576;
+	}
+	fi->fixed = (h[1] & 0xfe) << 8 | (h[2] & 0x0c);
+
+	return 0;
+}
+
+static const uint32_t adts_rate[13] = {
+	96000, 88200, 64000, 48000, 44100, 32000, 24000,
+	22050, 16000, 12000, 11025, 8000, 7350,
+};
+
+static int adts_parse(const uint8_t *h, struct frame_info *fi)
+{
+	uint32_t sr_idx;
+
+	if (h[0] != 0xff || (h[1] & 0xf6) != 0xf0)
+		return -1;
+
+	sr_idx = (h[2] >> 2) & 0xf;
+	if (sr_idx >= 13)
+		return -1;
+
+	fi->size = (h[3] & 3) << 11 | h[4] << 3 | h[5] >> 5;
+	if (fi->size < 7)
+		return -1;
+
+	fi->rate = adts_rate[sr_idx];
+	fi->samples = 1024 * ((h[6] & 3) + 1);
+	fi->fixed = h[1] << 8 | (h[2] & 0xfc);
+
+	return 0;
+}
+
+/* frame size including the toc byte, 0 for a type not used in storage */
+static const uint8_t amr_nb_size[16] = {
+	13, 14, 16, 18, 20, 21, 27, 32, 6, 0, 0, 0, 0, 0, 0, 1,
+};
+
+static const uint8_t amr_wb_size[16] = {
+	18, 24, 33, 37, 41, 47, 51, 59, 61, 6, 0, 0, 0, 0, 1, 1,
+};
+
+static int amr_parse(const uint8_t *h, struct frame_info *fi, bool wb)
+{
+	if (h[0] & 0x83)
+		return -1;
+
+	fi->size = (wb ? amr_wb_size : amr_nb_size)[(h[0] >> 3) & 0xf];
+	if (!fi->size)
+		return -1;
+
+	fi->rate = wb ? 16000 : 8000;
+	fi->samples = wb ? 320 : 160;
+	fi->fixed = 0;
+
+	return 0;
+}
+
+static uint32_t header_len(enum dsp_frame_index_type type)
+{
+	switch (type) {
+	case DSP_FRAME_INDEX_MP3:
+		return 4;
+	case DSP_FRAME_INDEX_ADTS:
+		return 7;
+	default:
+		return 1;
+	}
+}
+
+/* valid header at off, matching the stream so far if ref is set */
+static bool frame_at(struct dsp_frame_index *idx, struct scan_reader *r,
+		     uint64_t off, const struct frame_info *ref,
+		     struct frame_info *fi)
+{
+	const uint8_t *h = scan_peek(r, off, header_len(idx->type));
+	int ret;
+
+	if (!h)
+		return false;
+
+	switch (idx->type) {
+	case DSP_FRAME_INDEX_MP3:
+		ret = mp3_parse(h, fi);
+		break;
+	case DSP_FRAME_INDEX_ADTS:
+		ret = adts_parse(h, fi);
+		break;
+	default:
+		ret = amr_parse(h, fi, idx->type == DSP_FRAME_INDEX_AMR_WB);
+		break;
+	}
+
+	return !ret && (!ref || ref->fixed == fi->fixed);
+}
+
+/* a header counts as sync only if the next one follows it or the file ends */
+static bool frame_confirmed(struct dsp_frame_index *idx, struct scan_reader *r,
+			    uint64_t off, struct frame_info *fi)
+{
+	struct frame_info next;
+
+	if (!frame_at(idx, r, off, NULL, fi))
+		return false;
+
+	if (!scan_peek(r, off + fi->size, header_len(idx->type)))
+		return true;
+
+	return frame_at(idx, r, off + fi->size, fi, &next);
+}
+
+/* skip an ID3v2 tag or the AMR magic, returns offset of the first frame */
+static uint64_t stream_start(struct dsp_frame_index *idx, struct scan_reader *r)
+{
+	const uint8_t *h;
+
+	if (idx->type == DSP_FRAME_INDEX_AMR_NB) {
+		h = scan_peek(r, 0, 6);
+		return (h && !memcmp(h, "#!AMR\n", 6)) ? 6 : 0;
+	}
+	if (idx->type == DSP_FRAME_INDEX_AMR_WB) {
+		h = scan_peek(r, 0, 9);
+		return (h && !memcmp(h, "#!AMR-WB\n", 9)) ? 9 : 0;
+	}
+
+	h = scan_peek(r, 0, MAX_HEADER_LEN);
+	if (h && !memcmp(h, "ID3", 3))
+		return 10 + ((h[5] & 0x10) ? 10 : 0) +
+			((h[6] & 0x7f) << 21 | (h[7] & 0x7f) << 14 |
+			 (h[8] & 0x7f) << 7 | (h[9] & 0x7f));
+
+	return 0;
+}
+
+static int frame_index_add(struct dsp_frame_index *idx, uint64_t offset,
+			   const struct frame_info *fi)
+{
+	struct frame_entry *entries;
+	int ret = 0;
+
+	pthread_mutex_lock(&idx->lock);
+
+	if (idx->num == idx->size) {
+		uint32_t size = idx->size ? idx->size * 2 : 1024;
+
+		entries = realloc(idx->entries, size * sizeof(*entries));
+		if (!entries) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		idx->entries = entries;
+		idx->size = size;
+	}
+
+	if (!idx->num)
+		idx->rate = fi->rate;
+
+	idx->entries[idx->num].offset = offset;
+	idx->entries[idx->num].sample = idx->total_samples;
+	idx->num++;
+	idx->total_samples += fi->samples;
+out:
+	pthread_mutex_unlock(&idx->lock);
+
+	return ret;
+}
+
+static void *frame_index_thread(void *arg)
+{
+	struct dsp_frame_index *idx = arg;
+	struct scan_reader r = { .fd = idx->fd };
+	struct frame_info ref, fi;
+	uint64_t off;
+	bool synced = false;
+
+	r.buf = malloc(SCAN_CHUNK);
+	if (!r.buf)
+		goto out;
+
+	off = stream_start(idx, &r);
+
+	while (!idx->stop) {
+		if (synced && frame_at(idx, &r, off, &ref, &fi)) {
+			if (frame_index_add(idx, off, &fi))
+				break;
+			off += fi.size;
+			continue;
+		}
+
+		/* ...AMR has no sync word, nothing to search for */
+		if (synced && idx->type != DSP_FRAME_INDEX_MP3 &&
+		    idx->type != DSP_FRAME_INDEX_ADTS)
+			break;
+
+		/* ...lost sync, search the next pair of valid headers */
+		while (!idx->stop && scan_peek(&r, off, header_len(idx->type)) &&
+		       !frame_confirmed(idx, &r, off, &ref))
+			off++;
+		if (!scan_peek(&r, off, header_len(idx->type)))
+			break;
+		synced = true;
+	}
+
+	free(r.buf);
+out:
+	pthread_mutex_lock(&idx->lock);
+	idx->done = true;
+	pthread_mutex_unlock(&idx->lock);
+
+	return NULL;
+}
+
+struct dsp_frame_index *dsp_frame_index_create(enum dsp_frame_index_type type)
+{
+	struct dsp_frame_index *idx;
+
+	idx = calloc(1, sizeof(*idx));
+	if (!idx)
+		return NULL;
+
+	idx->type = type;
+	idx->fd = -1;
+	pthread_mutex_init(&idx->lock, NULL);
+
+	return idx;
+}
+
+void dsp_frame_index_destroy(struct dsp_frame_index *idx)
+{
+	if (!idx)
+		return;
+
+	if (idx->thread_started) {
+		idx->stop = true;
+		pthread_join(idx->thread, NULL);
+	}
+	if (idx->fd >= 0)
+		close(idx->fd);
+
+	pthread_mutex_destroy(&idx->lock);
+	free(idx->entries);
+	free(idx);
+}
+
+int dsp_frame_index_build(struct dsp_frame_index *idx, const char *path)
+{
+	int ret;
+
+	if (!idx || !path || idx->thread_started)
+		return -EINVAL;
+
+	idx->fd = open(path, O_RDONLY);
+	if (idx->fd < 0)
+		return -errno;
+
+	ret = pthread_create(&idx->thread, NULL, frame_index_thread, idx);
+	if (ret) {
+		close(idx->fd);
+		idx->fd = -1;
+		return -ret;
+	}
+	idx->thread_started = true;
+
+	return 0;
+}
+
+bool dsp_frame_index_done(struct dsp_frame_index *idx)
+{
+	bool done;
+
+	pthread_mutex_lock(&idx->lock);
+	done = idx->done;
+	pthread_mutex_unlock(&idx->lock);
+
+	return done;
+}
+
+int dsp_frame_index_lookup(struct dsp_frame_index *idx, uint64_t time_us,
+			   uint64_t *offset, uint64_t *frame_time_us)
+{
+	uint64_t sample;
+	uint32_t lo, hi, mid;
+	int ret = 0;
+
+	pthread_mutex_lock(&idx->lock);
+
+	if (!idx->num) {
+		ret = idx->done ? -ENOENT : -EAGAIN;
+		goto out;
+	}
+
+	sample = time_us * idx->rate / 1000000;
+	if (!idx->done && sample >= idx->total_samples) {
+		ret = -EAGAIN;
+		goto out;
+	}
+
+	/* ...last entry whose first sample is not after the target */
+	lo = 0;
+	hi = idx->num - 1;
+	while (lo < hi) {
+		mid = lo + (hi - lo + 1) / 2;
+		if (idx->entries[mid].sample <= sample)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	*offset = idx->entries[lo].offset;
+	*frame_time_us = idx->entries[lo].sample * 1000000 / idx->rate;
+out:
+	pthread_mutex_unlock(&idx->lock);
+
+	return ret;
+}
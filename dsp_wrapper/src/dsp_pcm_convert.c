@@ -0,0 +1,318 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <string.h>
+#include "dsp_pcm_convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DSP_PCM_NEON
+#endif
+
+uint32_t dsp_pcm_format_width(enum dsp_pcm_format fmt)
+{
+	switch (fmt) {
+	case DSP_PCM_S16_LE:
+		return 2;
+	case DSP_PCM_S24_3LE:
+		return 3;
+	case DSP_PCM_S24_LE:
+	case DSP_PCM_S32_LE:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+/* read one sample as a left aligned 32 bit value */
+static inline int32_t pcm_load(const uint8_t *p, enum dsp_pcm_format fmt)
+{
+	switch (fmt) {
+	case DSP_PCM_S16_LE:
+		return (int32_t)((uint32_t)p[0] << 16 | (uint32_t)p[1] << 24);
+	case DSP_PCM_S24_3LE:
+	case DSP_PCM_S24_LE:
+		return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 |
+				 (uint32_t)p[2] << 24);
+	default:
+		return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+				 (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+	}
+}
+
+/* write a left aligned 32 bit value as one sample */
+static inline void pcm_store(uint8_t *p, enum dsp_pcm_format fmt, int32_t v)
+{
+	uint32_t u = (uint32_t)v;
+
+	switch (fmt) {
+	case DSP_PCM_S16_LE:
+		p[0] = u >> 16;
+		p[1] = u >> 24;
+		break;
+	case DSP_PCM_S24_3LE:
+		p[0] = u >> 8;
+		p[1] = u >> 16;
+		p[2] = u >> 24;
+		break;
+	case DSP_PCM_S24_LE:
+		p[0] = u >> 8;
+		p[1] = u >> 16;
+		p[2] = u >> 24;
+		p[3] = (v < 0) ? 0xff : 0;
+		break;
+	default:
+		p[0] = u;
+		p[1] = u >> 8;
+		p[2] = u >> 16;
+		p[3] = u >> 24;
+		break;
+	}
+}
+
+#ifdef DSP_PCM_NEON
+/*
+ * 16 samples at a time, split into the four bytes of their left aligned
+ * 32 bit value, so every format pair is a pure byte shuffle.
+ */
+static inline uint8x16x4_t pcm_neon_load(const uint8_t *p,
+					 enum dsp_pcm_format fmt)
+{
+	uint8x16_t zero = vdupq_n_u8(0);
+	uint8x16x4_t b;
+	uint8x16x3_t b3;
+	uint8x16x2_t b2;
+
+	switch (fmt) {
+	case DSP_PCM_S16_LE:
+		b2 = vld2q_u8(p);
+		b.val[0] = zero;
+		b.val[1] = zero;
+		b.val[2] = b2.val[0];
+		b.val[3] = b2.val[1];
+		break;
+	case DSP_PCM_S24_3LE:
+		b3 = vld3q_u8(p);
+		b.val[0] = zero;
+		b.val[1] = b3.val[0];
+		b.val[2] = b3.val[1];
+		b.val[3] = b3.val[2];
+		break;
+	case DSP_PCM_S24_LE:
+		b = vld4q_u8(p);
+		b.val[3] = b.val[2];
+		b.val[2] = b.val[1];
+		b.val[1] = b.val[0];
+		b.val[0] = zero;
+		break;
+	default:
+		b = vld4q_u8(p);
+		break;
+	}
+
+	return b;
+}
+
+static inline void pcm_neon_store(uint8_t *p, enum dsp_pcm_format fmt,
+				  uint8x16x4_t b)
+{
+	uint8x16x4_t b4;
+	uint8x16x3_t b3;
+	uint8x16x2_t b2;
+
+	switch (fmt) {
+	case DSP_PCM_S16_LE:
+		b2.val[0] = b.val[2];
+		b2.val[1] = b.val[3];
+		vst2q_u8(p, b2);
+		break;
+	case DSP_PCM_S24_3LE:
+		b3.val[0] = b.val[1];
+		b3.val[1] = b.val[2];
+		b3.val[2] = b.val[3];
+		vst3q_u8(p, b3);
+		break;
+	case DSP_PCM_S24_LE:
+		b4.val[0] = b.val[1];
+		b4.val[1] = b.val[2];
+		b4.val[2] = b.val[3];
+		b4.val[3] = vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(b.val[3]), 7));
+		vst4q_u8(p, b4);
+		break;
+	default:
+		vst4q_u8(p, b);
+		break;
+	}
+}
+#endif
+
+int dsp_pcm_convert(void *dst, enum dsp_pcm_format dst_fmt,
+		    const void *src, enum dsp_pcm_format src_fmt,
+		    uint32_t samples)
+{
+	uint32_t dw = dsp_pcm_format_width(dst_fmt);
+	uint32_t sw = dsp_pcm_format_width(src_fmt);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	uint32_t i = 0;
+
+	if (!dw || !sw)
+		return -1;
+
+	if (dst_fmt == src_fmt) {
+		if (d != s)
+			memcpy(d, s, samples * sw);
+		return 0;
+	}
+
+#ifdef DSP_PCM_NEON
+	for (; i + 16 <= samples; i += 16)
+		pcm_neon_store(d + i * dw, dst_fmt,
+			       pcm_neon_load(s + i * sw, src_fmt));
+#endif
+	for (; i < samples; i++)
+		pcm_store(d + i * dw, dst_fmt, pcm_load(s + i * sw, src_fmt));
+
+	return 0;
+}
+
+void dsp_pcm_drop_channels(void *dst, const void *src, uint32_t frames,
+			   uint32_t in_ch, uint32_t out_ch, uint32_t width)
+{
+	uint32_t in_fs = in_ch * width;
+	uint32_t out_fs = out_ch * width;
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	uint32_t i = 0;
+
+	if (out_ch > in_ch)
+		return;
+
+#ifdef DSP_PCM_NEON
+	/* ...stereo to mono is what the wrapper does on every frame */
+	if (in_ch == 2 && out_ch == 1) {
+		if (width == 2) {
+			for (; i + 8 <= frames; i += 8)
+				vst1q_u16((uint16_t *)(d + i * 2),
+					  vld2q_u16((const uint16_t *)(s + i * 4)).val[0]);
+		} else if (width == 4) {
+			for (; i + 4 <= frames; i += 4)
+				vst1q_u32((uint32_t *)(d + i * 4),
+					  vld2q_u32((const uint32_t *)(s + i * 8)).val[0]);
+		} else if (width == 3) {
+			/* ...a 6 byte frame is three halfwords, left is 1.5 of them */
+			for (; i + 8 <= frames; i += 8) {
+				uint16x8x3_t w = vld3q_u16((const uint16_t *)(s + i * 6));
+				uint8x8x3_t o;
+
+				o.val[0] = vmovn_u16(w.val[0]);
+				o.val[1] = vshrn_n_u16(w.val[0], 8);
+				o.val[2] = vmovn_u16(w.val[1]);
+				vst3_u8(d + i * 3, o);
+			}
+		}
+	}
+#endif
+	for (; i < frames; i++)
+		memmove(d + i * out_fs, s + i * in_fs, out_fs);
+}
+
+void dsp_pcm_dup_channel(void *dst, const void *src, uint32_t frames,
+			 uint32_t out_ch, uint32_t width)
+{
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	uint32_t i = 0, ch;
+
+#ifdef DSP_PCM_NEON
+	if (out_ch == 2 && width == 2) {
+		for (; i + 8 <= frames; i += 8) {
+			uint16x8x2_t o;
+
+			o.val[0] = o.val[1] = vld1q_u16((const uint16_t *)(s + i * 2));
+			vst2q_u16((uint16_t *)(d + i * 4), o);
+		}
+	} else if (out_ch == 2 && width == 4) {
+		for (; i + 4 <= frames; i += 4) {
+			uint32x4x2_t o;
+
+			o.val[0] = o.val[1] = vld1q_u32((const uint32_t *)(s + i * 4));
+			vst2q_u32((uint32_t *)(d + i * 8), o);
+		}
+	}
+#endif
+	for (; i < frames; i++) {
+		for (ch = 0; ch < out_ch; ch++)
+			memcpy(d + (i * out_ch + ch) * width, s + i * width, width);
+	}
+}
+
+void dsp_pcm_interleave(void *dst, const void *const src[], uint32_t frames,
+			uint32_t channels, uint32_t width)
+{
+	uint8_t *d = dst;
+	uint32_t i = 0, ch;
+
+#ifdef DSP_PCM_NEON
+	if (channels == 2 && width == 2) {
+		const uint16_t *l = src[0], *r = src[1];
+
+		for (; i + 8 <= frames; i += 8) {
+			uint16x8x2_t o;
+
+			o.val[0] = vld1q_u16(l + i);
+			o.val[1] = vld1q_u16(r + i);
+			vst2q_u16((uint16_t *)(d + i * 4), o);
+		}
+	} else if (channels == 2 && width == 4) {
+		const uint32_t *l = src[0], *r = src[1];
+
+		for (; i + 4 <= frames; i += 4) {
+			uint32x4x2_t o;
+
+			o.val[0] = vld1q_u32(l + i);
+			o.val[1] = vld1q_u32(r + i);
+			vst2q_u32((uint32_t *)(d + i * 8), o);
+		}
+	}
+#endif
+	for (; i < frames; i++) {
+		for (ch = 0; ch < channels; ch++)
+			memcpy(d + (i * channels + ch) * width,
+			       (const uint8_t *)src[ch] + i * width, width);
+	}
+}
+
+void dsp_pcm_deinterleave(void *const dst[], const void *src, uint32_t frames,
+			  uint32_t channels, uint32_t width)
+{
+	const uint8_t *s = src;
+	uint32_t i = 0, ch;
+
+#ifdef DSP_PCM_NEON
+	if (channels == 2 && width == 2) {
+		uint16_t *l = dst[0], *r = dst[1];
+
+		for (; i + 8 <= frames; i += 8) {
+			uint16x8x2_t v = vld2q_u16((const uint16_t *)(s + i * 4));
+
+			vst1q_u16(l + i, v.val[0]);
+			vst1q_u16(r + i, v.val[1]);
+		}
+	} else if (channels == 2 && width == 4) {
+		uint32_t *l = dst[0], *r = dst[1];
+
+		for (; i + 4 <= frames; i += 4) {
+			uint32x4x2_t v = vld2q_u32((const uint32_t *)(s + i * 8));
+
+			vst1q_u32(l + i, v.val[0]);
+			vst1q_u32(r + i, v.val[1]);
+		}
+	}
+#endif
+	for (; i < frames; i++) {
+		for (ch = 0; ch < channels; ch++)
+			memcpy((uint8_t *)dst[ch] + i * width,
+			       s + (i * channels + ch) * width, width);
+	}
+}
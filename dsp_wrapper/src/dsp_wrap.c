@@ -23,6 +23,7 @@
  *****************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include "dsp_wrap.h"
@@ -91,6 +92,10 @@ WORD32 UniACodecQueryInterface(UWORD32 id, void **func)
 		*func = (void *)DSPDecLastErr;
 		break;
 
+	case ACODEC_API_RELEASE_OUTPUT:
+		*func = (void *)DSPDecReleaseOutput;
+		break;
+
 	default:
 		*func = NULL;
 		break;
@@ -197,6 +202,188 @@ static const CODECINFO codecinfo_factory[] = {
 };
 
 #define CODECINFO_LEN (sizeof(codecinfo_factory) / sizeof(codecinfo_factory[0]))
+
+/* ...decoders sharing one audio device, DSP_WRAP_SHARED_STREAMS overrides */
+#define DSP_ADEV_SHARED_STREAMS	4
+
+/* ...audio device shared by the wrapper handles of the process */
+static struct {
+	pthread_mutex_t lock;
+	xaf_adev_t *p_adev;
+	xaf_adev_config_t config;
+	UWORD32 refcount;
+	UWORD32 max_streams;
+	bool configured;
+	bool full;
+} shared_adev = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ * dsp_adev_open - open an audio device
+ *
+ * The component pool is sized for @streams decoders, so a shared device
+ * does not starve its later users.
+ *
+ * Returns: XAF_NO_ERR in case of success, error code otherwise
+ */
+static int dsp_adev_open(xaf_adev_config_t *adev_config, UWORD32 streams,
+			 xaf_adev_t **pp_adev)
+{
+	int err;
+
+	xaf_adev_config_default_init(adev_config);
+
+	mem_init(adev_config);
+	adev_config->pmem_malloc = mem_malloc;
+	adev_config->pmem_free = mem_free;
+	adev_config->audio_component_buffer_size *= streams;
+#ifndef XA_DISABLE_EVENT
+	adev_config->app_event_handler_cb = app_event_handler;
+#endif
+	err = xaf_adev_open((pVOID *)pp_adev, adev_config);
+	if (err) {
+#ifdef DEBUG
+		fprintf(stderr, "open dev error: %d\n", err);
+#endif
+		mem_exit(&adev_config->g_mem_obj);
+		*pp_adev = NULL;
+	}
+
+	return err;
+}
+
+/*
+ * dsp_adev_get - take a reference on the shared audio device
+ *
+ * The first caller opens the device, later callers only bump the refcount
+ * and create their own component on it. Responses are routed back to each
+ * component by its client id, so handles do not interfere.
+ *
+ * Returns: audio device, or NULL if sharing is disabled, the device already
+ * serves its maximum number of streams or it can not be opened. The caller
+ * then opens a private device instead.
+ */
+static xaf_adev_t *dsp_adev_get(void)
+{
+	xaf_adev_t *p_adev = NULL;
+	const char *env;
+
+	pthread_mutex_lock(&shared_adev.lock);
+
+	if (!shared_adev.configured) {
+		env = getenv("DSP_WRAP_SHARED_STREAMS");
+		shared_adev.max_streams = env ? strtoul(env, NULL, 0) : DSP_ADEV_SHARED_STREAMS;
+		shared_adev.configured = true;
+	}
+
+	if (shared_adev.full || shared_adev.refcount >= shared_adev.max_streams)
+		goto out;
+
+	if (!shared_adev.refcount &&
+	    dsp_adev_open(&shared_adev.config, shared_adev.max_streams,
+			  &shared_adev.p_adev))
+		goto out;
+
+	shared_adev.refcount++;
+	p_adev = shared_adev.p_adev;
+out:
+	pthread_mutex_unlock(&shared_adev.lock);
+
+	return p_adev;
+}
+
+/*
+ * dsp_adev_put - drop a reference on the shared audio device
+ *
+ * The device is closed when the last handle goes away, all components
+ * created on it must be deleted before.
+ *
+ * @full: the pool ran out, route further handles to private devices
+ *        until a component is deleted from the shared one
+ */
+static void dsp_adev_put(bool full)
+{
+	pthread_mutex_lock(&shared_adev.lock);
+
+	shared_adev.full = full;
+
+	if (shared_adev.refcount && --shared_adev.refcount == 0) {
+		xaf_adev_close(shared_adev.p_adev, XAF_ADEV_NORMAL_CLOSE);
+		mem_exit(&shared_adev.config.g_mem_obj);
+		shared_adev.p_adev = NULL;
+		shared_adev.full = false;
+	}
+
+	pthread_mutex_unlock(&shared_adev.lock);
+}
+
+/*
+ * dsp_adev_release - release the audio device of a handle
+ *
+ * @full: see dsp_adev_put()
+ */
+static void dsp_adev_release(struct DSP_Handle *pDSP_handle, bool full)
+{
+	if (pDSP_handle->adev_private) {
+		xaf_adev_close(pDSP_handle->p_adev, XAF_ADEV_NORMAL_CLOSE);
+		mem_exit(&pDSP_handle->adev_config.g_mem_obj);
+	} else {
+		dsp_adev_put(full);
+	}
+	pDSP_handle->p_adev = NULL;
+}
+
+/*
+ * dsp_adev_acquire - give a handle an audio device
+ *
+ * Prefer the shared device, fall back to a private one sized for a single
+ * stream when sharing is not possible.
+ *
+ * Returns: 0 in case of success, error code otherwise
+ */
+static int dsp_adev_acquire(struct DSP_Handle *pDSP_handle)
+{
+	pDSP_handle->p_adev = dsp_adev_get();
+	pDSP_handle->adev_private = !pDSP_handle->p_adev;
+	if (pDSP_handle->p_adev)
+		return 0;
+
+	return dsp_adev_open(&pDSP_handle->adev_config, 1, &pDSP_handle->p_adev);
+}
+
+/*
+ * dsp_outbuf_alloc_size - largest decoded frame of a codec
+ *
+ * @type: codec type
+ *
+ * Returns: output buffer size in bytes
+ */
+static UWORD32 dsp_outbuf_alloc_size(AUDIOFORMAT type)
+{
+	switch (type) {
+	case MP2:
+	case MP3:
+		return 16384;
+	case AAC:
+	case AAC_PLUS:
+		return 18432;
+	case AC3:
+		return 1536*sizeof(long)*6;
+	case DD_PLUS:
+		return 36864;
+	case NBAMR:
+		return 240*sizeof(short);
+	case WBAMR:
+		return 320*sizeof(short);
+	case WMA:
+		/* wma10 pro frames */
+		return 8192*3*8*2;
+	default:
+		return 16384;
+	}
+}
+
 /*
  * DSPDecCreate - DSP wrapper creation
  *
@@ -215,9 +402,8 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
 	int err = 0;
 	enum ChipCode chip_info;
 	void *p_adev = NULL;
-	xaf_adev_config_t *adev_config;
         xaf_comp_config_t comp_config;
-	void *dec_inbuf[2];
+	void *dec_inbuf[XAF_MAX_INBUFS];
 	const char *dec_id;
 	int  idx;
 
@@ -235,7 +421,7 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
 	pDSP_handle->audio_type = type;
 
 	threshold = INBUF_SIZE;
-	pDSP_handle->outbuf_alloc_size = OUTBUF_SIZE;
+	pDSP_handle->outbuf_alloc_size = dsp_outbuf_alloc_size(type);
 
 	chip_info = getChipCodeFromSocid();
 
@@ -312,15 +498,11 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
 		goto Err2;
 	}
 
-	pDSP_handle->inner_buf.data = memOps->Malloc(INBUF_SIZE);
-	if (!pDSP_handle->inner_buf.data) {
+	if (InnerBufAlloc(&pDSP_handle->inner_buf, memOps, INBUF_SIZE, threshold)) {
 		fprintf(stderr, "memory allocation error for inner_buf.data\n");
 		goto Err2;
 	}
 
-	pDSP_handle->inner_buf.buf_size = INBUF_SIZE;
-	pDSP_handle->inner_buf.threshold = threshold;
-	memset(pDSP_handle->inner_buf.data, 0, INBUF_SIZE);
 	pDSP_handle->codecoffset = 0;
 	pDSP_handle->codecdata_copy = false;
 
@@ -332,6 +514,7 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
 		}
 	}
 
+#ifndef XF_IPC_LOOPBACK
 	/* ... check whether codec library is exist */
 	{
 		char lib_wrap_path[200];
@@ -345,23 +528,10 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
 		}
 		fclose(fpInfile);
 	}
-
-	adev_config = &pDSP_handle->adev_config;
-	err = xaf_adev_config_default_init(adev_config);
-
-	mem_init(adev_config);
-	adev_config->pmem_malloc = mem_malloc;
-	adev_config->pmem_free = mem_free;
-#ifndef XA_DISABLE_EVENT
-	adev_config->app_event_handler_cb = app_event_handler;
-#endif
-	err = xaf_adev_open((pVOID *)&pDSP_handle->p_adev, adev_config);
-	if (err) {
-#ifdef DEBUG
-		fprintf(stderr, "open dev error: %d\n", err);
 #endif
+
+	if (dsp_adev_acquire(pDSP_handle))
 		goto Err2;
-	}
 	p_adev = pDSP_handle->p_adev;
 
 	/* ...create decoder p_comp */
@@ -370,17 +540,28 @@ UniACodec_Handle DSPDecCreate(UniACodecMemoryOps *memOps, AUDIOFORMAT type)
         xaf_comp_config_default_init(&comp_config);
 	comp_config.comp_id = dec_id;
 	comp_config.comp_type = comp_type;
-	comp_config.num_input_buffers = 1;
-	comp_config.num_output_buffers = 1;
+	comp_config.num_input_buffers = DSP_INBUF_NUM;
+	/* ...wma frames are too large to keep more than one in flight */
+	comp_config.num_output_buffers = (type == WMA) ? 1 : DSP_OUTBUF_NUM;
 	comp_config.pp_inbuf = (pVOID (*)[XAF_MAX_INBUFS])&dec_inbuf[0];
 #ifndef XA_DISABLE_EVENT
 	comp_config.error_channel_ctl = XAF_ERR_CHANNEL_ALL;
 #endif
 	err = xaf_comp_create((pVOID)p_adev, (pVOID *)&pDSP_handle->p_comp, &comp_config);
+	if (err == XAF_MEMORY_ERR && !pDSP_handle->adev_private) {
+		/* ...shared pool exhausted, retry on a device of our own */
+		dsp_adev_release(pDSP_handle, true);
+		pDSP_handle->adev_private = true;
+		if (dsp_adev_open(&pDSP_handle->adev_config, 1, &pDSP_handle->p_adev))
+			goto Err2;
+		p_adev = pDSP_handle->p_adev;
+		err = xaf_comp_create((pVOID)p_adev, (pVOID *)&pDSP_handle->p_comp, &comp_config);
+	}
 	if (err) {
 		fprintf(stderr, "create comp error: %d\n", err);
 		goto Err1;
 	}
+	comp_reset_buffers(pDSP_handle);
 
 	/* ...load codec library */
 	err = xaf_load_library(p_adev, pDSP_handle->p_comp, dec_id);
@@ -400,10 +581,9 @@ Err:
 	fprintf(stderr, "Create Decoder Failed, Please Check it!\n");
 	xaf_comp_delete(pDSP_handle->p_comp);
 Err1:
-	xaf_adev_close(pDSP_handle->p_adev, XAF_ADEV_NORMAL_CLOSE);
+	dsp_adev_release(pDSP_handle, false);
 Err2:
-	if (pDSP_handle->inner_buf.data)
-		pDSP_handle->sMemOps.Free(pDSP_handle->inner_buf.data);
+	InnerBufFree(&pDSP_handle->inner_buf, &pDSP_handle->sMemOps);
 
 	pDSP_handle->sMemOps.Free(pDSP_handle);
 
@@ -429,13 +609,10 @@ UA_ERROR_TYPE DSPDecDelete(UniACodec_Handle pua_handle)
 		return ACODEC_PARA_ERROR;
 
 	xaf_comp_delete(pDSP_handle->p_comp);
-	xaf_adev_close(pDSP_handle->p_adev, XAF_ADEV_NORMAL_CLOSE);
-	mem_exit(&pDSP_handle->adev_config.g_mem_obj);
+	dsp_adev_release(pDSP_handle, false);
+	dsp_frame_index_destroy(pDSP_handle->frame_index);
 
-	if (pDSP_handle->inner_buf.data) {
-		pDSP_handle->sMemOps.Free(pDSP_handle->inner_buf.data);
-		pDSP_handle->inner_buf.data = NULL;
-	}
+	InnerBufFree(&pDSP_handle->inner_buf, &pDSP_handle->sMemOps);
 
 	pDSP_handle->sMemOps.Free(pDSP_handle);
 	pua_handle = NULL;
@@ -443,6 +620,59 @@ UA_ERROR_TYPE DSPDecDelete(UniACodec_Handle pua_handle)
 	return ACODEC_SUCCESS;
 }
 
+/*
+ * FrameIndexStart - index the frames of the stream file in background
+ *
+ * @pDSP_handle: handle of DSP codec wrapper
+ * @path: file the caller feeds to the decoder
+ *
+ * Returns: ACODEC_SUCCESS in case of success and other codes in case of error
+ */
+static UA_ERROR_TYPE FrameIndexStart(struct DSP_Handle *pDSP_handle,
+				     const char *path)
+{
+	enum dsp_frame_index_type type;
+
+	switch (pDSP_handle->audio_type) {
+	case MP2:
+	case MP3:
+		type = DSP_FRAME_INDEX_MP3;
+		break;
+	case AAC:
+	case AAC_PLUS:
+		if (pDSP_handle->stream_type != STREAM_ADTS)
+			return ACODEC_PROFILE_NOT_SUPPORT;
+		type = DSP_FRAME_INDEX_ADTS;
+		break;
+	case NBAMR:
+		if (pDSP_handle->stream_type != STREAM_NBAMR_MMSIO)
+			return ACODEC_PROFILE_NOT_SUPPORT;
+		type = DSP_FRAME_INDEX_AMR_NB;
+		break;
+	case WBAMR:
+		if (pDSP_handle->stream_type != STREAM_WBAMR_MIME)
+			return ACODEC_PROFILE_NOT_SUPPORT;
+		type = DSP_FRAME_INDEX_AMR_WB;
+		break;
+	default:
+		return ACODEC_PROFILE_NOT_SUPPORT;
+	}
+
+	dsp_frame_index_destroy(pDSP_handle->frame_index);
+	pDSP_handle->frame_index = dsp_frame_index_create(type);
+	if (!pDSP_handle->frame_index)
+		return ACODEC_INSUFFICIENT_MEM;
+
+	if (dsp_frame_index_build(pDSP_handle->frame_index, path)) {
+		fprintf(stderr, "frame index: can not open %s\n", path);
+		dsp_frame_index_destroy(pDSP_handle->frame_index);
+		pDSP_handle->frame_index = NULL;
+		return ACODEC_PARA_ERROR;
+	}
+
+	return ACODEC_SUCCESS;
+}
+
 /*
  * DSPDecReset - function to reset DSP codec wrapper
  * (e.g flushing internal buffer)
@@ -466,6 +696,9 @@ UA_ERROR_TYPE DSPDecReset(UniACodec_Handle pua_handle)
 	ResetInnerBuf(&pDSP_handle->inner_buf,
 		      pDSP_handle->inner_buf.buf_size,
 		      pDSP_handle->inner_buf.threshold);
+	/* ...a seek may land in the middle of a tag being skipped */
+	pDSP_handle->ID3flag = false;
+	pDSP_handle->tagsize = 0;
 
 Fail:
 	return ret;
@@ -524,6 +757,12 @@ UA_ERROR_TYPE DSPDecSetPara(UniACodec_Handle pua_handle,
 	case UNIA_DOWNMIX_STEREO:
 		pDSP_handle->downmix = parameter->downmix;
 		break;
+	case UNIA_ZERO_COPY_OUTPUT:
+		/* ...wrapper only, nothing to send to DSP */
+		pDSP_handle->zero_copy = parameter->zero_copy;
+		return ACODEC_SUCCESS;
+	case UNIA_FRAME_INDEX_FILE:
+		return FrameIndexStart(pDSP_handle, parameter->index_file);
 	case UNIA_TO_STEREO:
 		param[1] = parameter->mono_to_stereo;
 		break;
@@ -732,39 +971,34 @@ UA_ERROR_TYPE DSPDecGetPara(UniACodec_Handle pua_handle,
 			parameter->outputFormat = pDSP_handle->outputFormat;
 		}
 		break;
+	case UNIA_SEEK_POSITION:
+	{
+		uint64_t offset, frame_time;
+
+		if (!pDSP_handle->frame_index)
+			return ACODEC_PARA_ERROR;
+		err = dsp_frame_index_lookup(pDSP_handle->frame_index,
+					     parameter->seek.time_us,
+					     &offset, &frame_time);
+		/* ...index not there yet, caller seeks the old way */
+		if (err == -EAGAIN)
+			return ACODEC_NOT_ENOUGH_DATA;
+		if (err)
+			return ACODEC_ERR_UNKNOWN;
+		parameter->seek.offset = offset;
+		parameter->seek.frame_time_us = frame_time;
+		break;
+	}
+	case UNIA_IPC_MSG_COUNT:
+		/* ...counts every handle, the device is shared */
+		parameter->ipc_msg_count = pDSP_handle->p_adev->proxy.ipc.msg_sent;
+		break;
 	case UNIA_CODEC_DESCRIPTION:
 		pDSP_handle->codcDesc = "dsp codec version";
 		parameter->codecDesc = &pDSP_handle->codcDesc;
 		break;
 	case UNIA_OUTBUF_ALLOC_SIZE:
-		switch (pDSP_handle->audio_type) {
-		case MP2:
-		case MP3:
-			parameter->outbuf_alloc_size = 16384;
-			break;
-		case AAC:
-		case AAC_PLUS:
-			parameter->outbuf_alloc_size = 18432;
-			break;
-		case AC3:
-			parameter->outbuf_alloc_size = 1536*sizeof(long)*6;
-			break;
-		case DD_PLUS:
-			parameter->outbuf_alloc_size = 36864;
-			break;
-		case NBAMR:
-			parameter->outbuf_alloc_size = 240*sizeof(short);
-			break;
-		case WBAMR:
-			parameter->outbuf_alloc_size = 320*sizeof(short);
-			break;
-		case WMA:
-			parameter->outbuf_alloc_size = 8192*3*8*2;
-			break;
-		default:
-			parameter->outbuf_alloc_size = 16384;
-			break;
-		}
+		parameter->outbuf_alloc_size = pDSP_handle->outbuf_alloc_size;
 		break;
 	default:
 		break;
@@ -787,7 +1021,9 @@ UA_ERROR_TYPE DSPDecGetPara(UniACodec_Handle pua_handle,
  * @InputSize  (in)    : input buffer size
  * @offset     (in/out): offset of the input buffer
  * @OutputBuf  (in/out): decoder output buffer, if set to NULL
- *                       decoder wrapper will malloc buffer inside the decoder
+ *                       decoder wrapper will malloc buffer inside the decoder,
+ *                       or in zero copy mode return the DSP output buffer,
+ *                       which must be given back by DSPDecReleaseOutput()
  * @OutputSize (in/out): decoder output buffer size
  */
 UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
@@ -804,6 +1040,7 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 	UWORD32 *inner_offset, *inner_size;
 	UWORD8 *pIn = NULL, *pOut = NULL;
 	bool buf_from_out = false;
+	bool from_codec_data = false;
 	UWORD32 *channel_map = NULL;
 	UWORD32 in_size = 0, in_off = 0, out_size = 0;
 	unsigned int *codecoffset = &pDSP_handle->codecoffset;
@@ -823,21 +1060,24 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 #ifdef DEBUG
 	fprintf(stdout, "InputSize = %d, offset = %d\n", InputSize, *offset);
 #endif
+	inbuf_data = pDSP_handle->inner_buf.data;
+	inner_offset = &pDSP_handle->inner_buf.inner_offset;
+	inner_size = &pDSP_handle->inner_buf.inner_size;
+
+	if (pDSP_handle->codecData.size <= *codecoffset)
+		pDSP_handle->codecdata_copy = true;
+
 	if (pDSP_handle->codecData.buf && (pDSP_handle->codecdata_copy == false)
 			&& (pDSP_handle->codecdata_ignored == false)) {
+		/* ...codec data goes to DSP straight from the caller's buffer */
 		UWORD32 need_copy = pDSP_handle->codecData.size - *codecoffset;
-		UWORD32 actual_copy = (need_copy > INBUF_SIZE) ? INBUF_SIZE : need_copy;
-		int offset = 0;
-		InputBufHandle(&pDSP_handle->inner_buf,
-					pDSP_handle->codecData.buf + *codecoffset,
-					actual_copy,
-					&offset,
-					0);
-		*codecoffset += offset;
-	}
+		UWORD32 threshold = pDSP_handle->inner_buf.threshold;
 
-	if ((pDSP_handle->codecdata_copy == true) || pDSP_handle->codecdata_ignored == true) {
-		if (!pDSP_handle->inptr_busy) {
+		pIn = (UWORD8 *)pDSP_handle->codecData.buf + *codecoffset;
+		in_size = (need_copy > threshold) ? threshold : need_copy;
+		from_codec_data = true;
+	} else {
+		if (pDSP_handle->inbuf_free_num) {
 			err = InputBufHandle(&pDSP_handle->inner_buf,
 						 InputBuf,
 						 InputSize,
@@ -849,14 +1089,7 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 		}
 	}
 
-	if (pDSP_handle->codecData.size <= *codecoffset)
-		pDSP_handle->codecdata_copy = true;
-
-	inbuf_data = pDSP_handle->inner_buf.data;
-	inner_offset = &pDSP_handle->inner_buf.inner_offset;
-	inner_size = &pDSP_handle->inner_buf.inner_size;
-
-	if (pDSP_handle->codec_type != CODEC_FSL_MP3_DEC) {
+	if (!from_codec_data && pDSP_handle->codec_type != CODEC_FSL_MP3_DEC) {
 		if (!pDSP_handle->ID3flag && !memcmp(inbuf_data +
 						(*inner_offset), "ID3", 3)) {
 			UWORD8 *pBuff = inbuf_data + (*inner_offset);
@@ -869,19 +1102,14 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 		if (pDSP_handle->ID3flag) {
 			if (*inner_size >= pDSP_handle->tagsize) {
 				pDSP_handle->ID3flag = false;
-				*inner_offset += pDSP_handle->tagsize;
-				*inner_size -= pDSP_handle->tagsize;
+				InnerBufConsume(&pDSP_handle->inner_buf,
+						pDSP_handle->tagsize);
 				pDSP_handle->consumed_length += pDSP_handle->tagsize;
 				pDSP_handle->tagsize = 0;
-
-				memmove(inbuf_data,
-					inbuf_data + (*inner_offset), *inner_size);
-				*inner_offset = 0;
 			} else {
 				pDSP_handle->tagsize -= *inner_size;
-				*inner_offset += *inner_size;
 				pDSP_handle->consumed_length += *inner_size;
-				*inner_size = 0;
+				InnerBufConsume(&pDSP_handle->inner_buf, *inner_size);
 				return ACODEC_NOT_ENOUGH_DATA;
 			}
 		}
@@ -897,7 +1125,7 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 		pDSP_handle->memory_allocated = true;
 	}
 
-	if (!(*OutputBuf)) {
+	if (!(*OutputBuf) && !pDSP_handle->zero_copy) {
 		pDSP_handle->dsp_out_buf =
 		  pDSP_handle->sMemOps.Malloc(pDSP_handle->outbuf_alloc_size);
 		if (!pDSP_handle->dsp_out_buf) {
@@ -910,21 +1138,27 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 	}
 
 	pOut = *OutputBuf;
-	pIn = inbuf_data + *inner_offset;
-	in_size = *inner_size;
+	if (!from_codec_data) {
+		pIn = inbuf_data + *inner_offset;
+		in_size = *inner_size;
+	}
 	in_off = 0;
 
 #ifdef DEBUG
 	fprintf(stdout,"inner buffer data size = %d, inner buffer offset = %d\n",
 	      in_size, *inner_offset);
 #endif
-	err = comp_process(pDSP_handle, pIn, in_size, &in_off, pOut, &out_size);
-
-	*inner_size -= in_off;
-	*inner_offset += in_off;
+	err = comp_process(pDSP_handle, pIn, in_size, &in_off, &pOut, &out_size);
+
+	if (from_codec_data) {
+		*codecoffset += in_off;
+		if (pDSP_handle->codecData.size <= *codecoffset)
+			pDSP_handle->codecdata_copy = true;
+	} else {
+		InnerBufConsume(&pDSP_handle->inner_buf, in_off);
+	}
 
-	if (buf_from_out)
-		memcpy(*OutputBuf, pOut, out_size);
+	*OutputBuf = pOut;
 	*OutputSize = out_size;
 
 	pDSP_handle->last_output_size = out_size;
@@ -1027,7 +1261,8 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 #endif
 
 	if (!(out_size)) {
-		if ((*OutputBuf) && (buf_from_out == false)) {
+		if ((*OutputBuf) && (buf_from_out == false) &&
+		    (pDSP_handle->dsp_out_buf == *OutputBuf)) {
 			pDSP_handle->sMemOps.Free(*OutputBuf);
 			pDSP_handle->dsp_out_buf = NULL;
 			*OutputBuf = NULL;
@@ -1038,6 +1273,23 @@ UA_ERROR_TYPE DSPDecFrameDecode(UniACodec_Handle pua_handle,
 	return err;
 }
 
+/*
+ * DSPDecReleaseOutput - give a zero copy output buffer back to DSP
+ *
+ * @pua_handle: handle of DSP codec wrapper
+ * @OutputBuf: buffer returned by DSPDecFrameDecode() in zero copy mode
+ */
+UA_ERROR_TYPE DSPDecReleaseOutput(UniACodec_Handle pua_handle,
+				  UWORD8 *OutputBuf)
+{
+	struct DSP_Handle *pDSP_handle = (struct DSP_Handle *)pua_handle;
+
+	if (!pDSP_handle || !OutputBuf)
+		return ACODEC_PARA_ERROR;
+
+	return comp_release_output(pua_handle, OutputBuf);
+}
+
 char *DSPDecLastErr(UniACodec_Handle pua_handle)
 {
 	struct DSP_Handle *pDSP_handle = (struct DSP_Handle *)pua_handle;
@@ -42,8 +42,8 @@
 /* ...allocate 2 bits for core id */
 #define XF_CFG_MAX_CORES                (1 << 2)
 
-/* ...allocate 4 bits for maximal number of input/output ports per component */
-#define XF_CFG_MAX_PORTS                (1 << 4)
+/* ...allocate 6 bits for maximal number of input/output ports per component */
+#define XF_CFG_MAX_PORTS                (1 << 6)
 
 /* ...allocate 6 bits for opcode type */
 #define XF_CFG_MAX_CODES                (1 << 6)
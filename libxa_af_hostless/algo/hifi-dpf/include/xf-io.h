@@ -79,11 +79,14 @@ typedef struct xf_input_port
 /* ...stream purging sequence */
 #define XF_INPUT_FLAG_PURGING           (1 << 4)
 
+/* ...data is presented as scattered segments rather than copied */
+#define XF_INPUT_FLAG_GATHER            (1 << 5)
+
 /* ...base input port flags mask */
-#define __XF_INPUT_FLAGS(flags)         ((flags) & ((1 << 5) - 1))
+#define __XF_INPUT_FLAGS(flags)         ((flags) & ((1 << 6) - 1))
 
 /* ...custom input port flag */
-#define __XF_INPUT_FLAG(f)              ((f) << 5)
+#define __XF_INPUT_FLAG(f)              ((f) << 6)
 
 /*******************************************************************************
  * Helpers
@@ -113,18 +116,24 @@ static inline int xf_input_port_bypass(xf_input_port_t *port)
     return port->buffer == NULL;
 }
 
-/* ...bypass port only: check if there is a data available */
+/* ...check if there is a data available in head message (not in internal buffer) */
 static inline void * xf_input_port_data(xf_input_port_t *port)
 {
     return port->access;
 }
 
-/* ...bypass port only: get remaining length of current message */
+/* ...get remaining length of head message (not of internal buffer) */
 static inline UWORD32 xf_input_port_length(xf_input_port_t *port)
 {
     return port->remaining;
 }
 
+/* ...check if port is in gather mode */
+static inline int xf_input_port_gather_mode(xf_input_port_t *port)
+{
+    return ((port->flags & XF_INPUT_FLAG_GATHER) != 0);
+}
+
 /* ...non-bypass port only: get current fill level */
 static inline UWORD32 xf_input_port_level(xf_input_port_t *port)
 {
@@ -135,6 +144,12 @@ static inline UWORD32 xf_input_port_level(xf_input_port_t *port)
  * Output port data
  ******************************************************************************/
 
+/* ...maximal number of sinks an output port may be routed to */
+#define XF_OUTPUT_PORT_MAX_SINKS        4
+
+/* ...initial number of buffers in circulation for adaptive route */
+#define XF_OUTPUT_PORT_MIN_DEPTH        2
+
 typedef struct xf_output_port
 {
     /* ...pending message queue */
@@ -152,6 +167,36 @@ typedef struct xf_output_port
     /* ...output port flags */
     UWORD32                     flags;
 
+    /* ...number of fan-out sinks besides the first routed one */
+    UWORD32                     sinks;
+
+    /* ...fan-out sink message pools; item 0 is the sink flow-control message */
+    xf_msg_pool_t           sink_pool[XF_OUTPUT_PORT_MAX_SINKS - 1];
+
+    /* ...per-buffer count of sink references still outstanding */
+    UWORD32                    *refcount;
+
+    /* ...fan-out flow-control messages still outstanding */
+    UWORD32                     pending;
+
+    /* ...saved unroute command of a single sink and the sink index (0 is the first one) */
+    xf_message_t           *unroute_sink;
+    UWORD32                     unroute_idx;
+
+    /* ...per-buffer input message lending its buffer for in-place output; the
+     * lender goes back to its source only when the sink returns the buffer,
+     * so it stays out of the upstream pool for the downstream latency */
+    xf_message_t          **lent;
+
+    /* ...number of buffers in circulation */
+    UWORD32                     depth;
+
+    /* ...adaptive route buffers not put in circulation yet */
+    xf_msg_queue_t          reserve;
+
+    /* ...buffers produced since port last ran out of them (up to depth) */
+    UWORD32                     stall_age;
+
 }   xf_output_port_t;
 
 /*******************************************************************************
@@ -179,11 +224,26 @@ typedef struct xf_output_port
 /* ...port is being unrouted */
 #define XF_OUTPUT_FLAG_UNROUTING        (1 << 6)
 
+/* ...flow-control message waits for fan-out sinks to complete flushing */
+#define XF_OUTPUT_FLAG_PARKED           (1 << 7)
+
+/* ...one of fan-out sinks no longer exists */
+#define XF_OUTPUT_FLAG_SINK_LOST        (1 << 8)
+
+/* ...port grows its buffer circulation on stalls */
+#define XF_OUTPUT_FLAG_ADAPTIVE         (1 << 9)
+
+/* ...port has run out of buffers and none has come back yet */
+#define XF_OUTPUT_FLAG_STALLED          (1 << 10)
+
+/* ...first routed sink is unrouted; fan-out sinks still take port buffers */
+#define XF_OUTPUT_FLAG_DETACHED         (1 << 11)
+
 /* ...base output port flags accessor */
-#define __XF_OUTPUT_FLAGS(flags)        ((flags) & ((1 << 7) - 1))
+#define __XF_OUTPUT_FLAGS(flags)        ((flags) & ((1 << 12) - 1))
 
 /* ...custom output port flag */
-#define __XF_OUTPUT_FLAG(f)             ((f) << 7)
+#define __XF_OUTPUT_FLAG(f)             ((f) << 12)
 
 /*******************************************************************************
  * Helpers
@@ -201,6 +261,12 @@ static inline int xf_output_port_routed(xf_output_port_t *port)
     return ((port->flags & XF_OUTPUT_FLAG_ROUTED) != 0);
 }
 
+/* ...check if more than one sink takes port buffers */
+static inline int xf_output_port_fanned_out(xf_output_port_t *port)
+{
+    return (port->sinks + !(port->flags & XF_OUTPUT_FLAG_DETACHED) > 1);
+}
+
 /* ...check if port unrouting sequence is ongoing */
 static inline int xf_output_port_unrouting(xf_output_port_t *port)
 {
@@ -231,6 +297,12 @@ static inline int xf_output_port_flushing(xf_output_port_t *port)
     return ((port->flags & XF_OUTPUT_FLAG_FLUSHING) != 0);
 }
 
+/* ...number of buffers port currently circulates (zero if not routed) */
+static inline UWORD32 xf_output_port_depth(xf_output_port_t *port)
+{
+    return port->depth;
+}
+
 /*******************************************************************************
  * Input port API
  ******************************************************************************/
@@ -244,6 +316,24 @@ extern int  xf_input_port_put(xf_input_port_t *port, xf_message_t *m);
 /* ...fill-in required amount of data into input port buffer */
 extern int  xf_input_port_fill(xf_input_port_t *port);
 
+/* ...non-bypass port only: present data as segments instead of copying it */
+extern void xf_input_port_gather_enable(xf_input_port_t *port);
+
+/* ...gather port only: describe available data as segments; non-zero if ready */
+extern int  xf_input_port_gather(xf_input_port_t *port, void **ptr, UWORD32 *length, UWORD32 *num);
+
+/* ...non-bypass port only: get head message buffer if it may be processed in place */
+extern void * xf_input_port_inplace(xf_input_port_t *port);
+
+/* ...take head message out of the port without completing it */
+extern xf_message_t * xf_input_port_detach(xf_input_port_t *port);
+
+/* ...get total amount of data held by the port */
+extern UWORD32 xf_input_port_queued(xf_input_port_t *port);
+
+/* ...non-bypass port only: consume bytes of queued messages, not of internal buffer */
+extern void xf_input_port_skip(xf_input_port_t *port, UWORD32 n);
+
 /* ...consume bytes from input buffer */
 extern void xf_input_port_consume(xf_input_port_t *port, UWORD32 n);
 
@@ -275,6 +365,21 @@ extern void * xf_output_port_data(xf_output_port_t *port);
 /* ...route output port */
 extern int xf_output_port_route(xf_output_port_t *port, UWORD32 id, UWORD32 n, UWORD32 length, UWORD32 align);
 
+/* ...route output port to one more sink sharing its buffers */
+extern int xf_output_port_route_add(xf_output_port_t *port, UWORD32 id, UWORD32 length);
+
+/* ...resolve message returned by a sink; NULL if other sinks still hold it */
+extern xf_message_t * xf_output_port_fanout(xf_output_port_t *port, xf_message_t *m);
+
+/* ...unroute one sink of fanned-out port; 1 if done, 0 if started, negative on error */
+extern int xf_output_port_unroute_sink(xf_output_port_t *port, UWORD32 dst, xf_message_t *m);
+
+/* ...check if next output message may carry a buffer lent by an input message */
+extern int xf_output_port_lend_ready(xf_output_port_t *port);
+
+/* ...produce output in the buffer of input message; output message is completed on return, input message is held until the sink returns the buffer */
+extern int xf_output_port_produce_lent(xf_output_port_t *port, UWORD32 n, xf_message_t *m);
+
 /* ...unroute output port */
 extern void xf_output_port_unroute(xf_output_port_t *port);
 
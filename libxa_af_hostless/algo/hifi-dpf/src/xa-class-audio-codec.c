@@ -93,6 +93,12 @@ typedef struct XAAudioCodec
     /* ...temporary output pointer for audio class component initialization */
     void                   *pinit_output;
 
+    /* ...input data segments for codecs consuming scattered input */
+    xa_codec_input_segments_t   segments;
+
+    /* ...codec may write output over its input buffer */
+    UWORD32                     inplace;
+
     /***************************************************************************
      * response message pointer 
      **************************************************************************/
@@ -116,6 +122,9 @@ typedef struct XAAudioCodec
 /* ...end-of-stream sequence complete condition */
 #define XA_CODEC_FLAG_EOS_SEQ_DONE		__XA_BASE_FLAG(1 << 3)
 
+/* ...input and output are set up on the buffer of head input message */
+#define XA_CODEC_FLAG_INPLACE           __XA_BASE_FLAG(1 << 4)
+
 /*******************************************************************************
  * Auxiliary port operation flags
  ******************************************************************************/
@@ -288,6 +297,12 @@ static XA_ERRORCODE xa_codec_fill_this_buffer(XACodecBase *base, xf_message_t *m
     /* ...make sure the port is sane */
     XF_CHK_ERR(XF_MSG_DST_PORT(m->id) == 1, XA_API_FATAL_INVALID_CMD);
 
+    /* ...buffer shared with fan-out sinks is recycled by the last one */
+    if ((m = xf_output_port_fanout(&codec->output, m)) == NULL)
+    {
+        return XA_NO_ERROR;
+    }
+
     /* ...special handling of zero-length buffer */
     if (base->state & XA_BASE_FLAG_RUNTIME_INIT)
     {
@@ -419,8 +434,15 @@ static XA_ERRORCODE xa_codec_port_route(XACodecBase *base, xf_message_t *m)
     /* ...make sure output port is addressed */
     XF_CHK_ERR(XF_MSG_DST_PORT(m->id) == 1, XA_API_FATAL_INVALID_CMD_TYPE);
 
-    /* ...make sure port is not routed yet */
-    XF_CHK_ERR(!xf_output_port_routed(port), XA_API_FATAL_INVALID_CMD_TYPE);
+    /* ...routed port fans out to one more sink sharing its buffers */
+    if (xf_output_port_routed(port))
+    {
+        XF_CHK_ERR(xf_output_port_route_add(port, __XF_MSG_ID(dst, src), cmd->alloc_size) == 0, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        xf_response_ok(m);
+
+        return XA_NO_ERROR;
+    }
 
     /* ...route output port - allocate queue */
     XF_CHK_ERR(xf_output_port_route(port, __XF_MSG_ID(dst, src), cmd->alloc_number, cmd->alloc_size, cmd->alloc_align) == 0, XA_API_FATAL_MEM_ALLOC);
@@ -438,6 +460,7 @@ static XA_ERRORCODE xa_codec_port_route(XACodecBase *base, xf_message_t *m)
 static XA_ERRORCODE xa_codec_port_unroute(XACodecBase *base, xf_message_t *m)
 {
     XAAudioCodec           *codec = (XAAudioCodec *) base;
+    xf_unroute_port_msg_t  *cmd = m->buffer;
     
     /* ...command is allowed only in "postinit" state */
     XF_CHK_ERR(base->state & XA_BASE_FLAG_POSTINIT, XA_API_FATAL_INVALID_CMD);
@@ -452,6 +475,14 @@ static XA_ERRORCODE xa_codec_port_unroute(XACodecBase *base, xf_message_t *m)
         return XA_NO_ERROR;
     }
 
+    /* ...single sink of fanned-out port goes; the others keep running */
+    if (cmd->dst && xf_output_port_fanned_out(&codec->output))
+    {
+        XF_CHK_ERR(xf_output_port_unroute_sink(&codec->output, cmd->dst, m) >= 0, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        return XA_NO_ERROR;
+    }
+
     /* ...cancel any pending processing */
     xa_base_cancel(base);
 
@@ -537,6 +568,10 @@ static XA_ERRORCODE xa_codec_flush(XACodecBase *base, xf_message_t *m)
             xf_input_port_control_save(&codec->input, m);
         }
     }
+    else if ((m = xf_output_port_fanout(&codec->output, m)) == NULL)
+    {
+        /* ...fan-out sinks are still flushing */
+    }
     else if (xf_output_port_unrouting(&codec->output))
     {
         /* ...flushing during port unrouting; complete unroute sequence */
@@ -729,6 +764,20 @@ static XA_ERRORCODE xa_codec_memtab(XACodecBase *base, WORD32 idx, WORD32 type,
 
     if (type == XA_MEMTYPE_INPUT)
     {
+        int     gather = 0;
+
+        /* ...codec consuming scattered input avoids copies into internal buffer */
+        if (!XF_CHK_PORT_MASK(codec->probe_enabled, 0))
+        {
+            gather = (base->process((xa_codec_handle_t)base->api.addr, XA_API_CMD_SET_INPUT_SEGMENTS, idx, NULL) == XA_NO_ERROR);
+        }
+
+        /* ...codec taking any amount of input as segments needs no minimal fill */
+        if (gather && size == 0)
+        {
+            size = 1;
+        }
+
         /* ...input port specification; allocate internal buffer */
         XF_CHK_ERR(xf_input_port_init(&codec->input, size, align, core) == 0, XA_API_FATAL_MEM_ALLOC);
 
@@ -739,6 +788,21 @@ static XA_ERRORCODE xa_codec_memtab(XACodecBase *base, WORD32 idx, WORD32 type,
         if(size)
         {
             XA_API(base, XA_API_CMD_SET_MEM_PTR, idx, codec->input.buffer);
+
+            if (!XF_CHK_PORT_MASK(codec->probe_enabled, 0))
+            {
+                WORD32  inplace = 0;
+
+                if (gather)
+                {
+                    xf_input_port_gather_enable(&codec->input);
+                }
+                /* ...codec writing output over input avoids copies of full frames */
+                else if (base->process((xa_codec_handle_t)base->api.addr, XA_API_CMD_GET_INPLACE, idx, &inplace) == XA_NO_ERROR && inplace)
+                {
+                    codec->inplace = 1;
+                }
+            }
         }
 
         (size ? TRACE(INPUT, _x("set input ptr: %p"), codec->input.buffer) : 0);
@@ -826,6 +890,36 @@ static XA_ERRORCODE xa_codec_preprocess(XACodecBase *base)
     	}
     }
 
+    /* ...full input frame may be processed right in the buffer of its message;
+     * that message then stays with the sink until it returns the output, so
+     * the source runs short of buffers if the sink holds on to them */
+    if (codec->inplace && !(base->state & (XA_BASE_FLAG_RUNTIME_INIT | XA_CODEC_FLAG_INPUT_SETUP | XA_CODEC_FLAG_OUTPUT_SETUP)))
+    {
+        void   *buffer;
+        UWORD32     filled = codec->input.length;
+
+        if (codec->input.length == codec->output.length
+            && (buffer = xf_input_port_inplace(&codec->input)) != NULL
+            && xf_output_port_lend_ready(&codec->output))
+        {
+            /* ...set both input and output buffer pointers to the message buffer */
+            XA_API(base, XA_API_CMD_SET_MEM_PTR, codec->in_idx, buffer);
+            XA_API(base, XA_API_CMD_SET_MEM_PTR, codec->out_idx, buffer);
+
+            /* ...copy codec output buffer pointer for probe */
+            codec->out_ptr = buffer;
+
+            XA_API(base, XA_API_CMD_SET_INPUT_BYTES, codec->in_idx, &filled);
+
+            TRACE(INPUT, _b("in-place buffer: %p"), buffer);
+
+            /* ...mark both ports are setup */
+            base->state |= XA_CODEC_FLAG_INPLACE | XA_CODEC_FLAG_INPUT_SETUP | XA_CODEC_FLAG_OUTPUT_SETUP;
+
+            return XA_NO_ERROR;
+        }
+    }
+
     /* ...prepare output buffer if needed */
     if (!(base->state & XA_CODEC_FLAG_OUTPUT_SETUP))
     {
@@ -899,6 +993,27 @@ static XA_ERRORCODE xa_codec_preprocess(XACodecBase *base)
                 filled = 0;
             }
         }
+        else if (xf_input_port_gather_mode(&codec->input))
+        {
+            xa_codec_input_segments_t  *seg = &codec->segments;
+            UWORD32                     i;
+
+            /* ...collect queued input as segments */
+            seg->num = XA_CODEC_INPUT_SEGMENTS_MAX;
+
+            if (!xf_input_port_gather(&codec->input, seg->ptr, seg->length, &seg->num))
+            {
+                /* ...return non-fatal indication to prevent further processing */
+                return XA_CODEC_EXEC_NO_DATA;
+            }
+
+            for (filled = 0, i = 0; i < seg->num; i++)
+            {
+                filled += seg->length[i];
+            }
+
+            XA_API(base, XA_API_CMD_SET_INPUT_SEGMENTS, codec->in_idx, seg);
+        }
         else
         {
             /* ...port is in non-bypass mode; try to fill internal buffer */
@@ -944,6 +1059,7 @@ static XA_ERRORCODE xa_codec_postprocess(XACodecBase *base, int done)
     xaf_comp_type    comp_type = base->comp_type;
     UWORD32 probe_length = 0;
     void   *probe_outptr = codec->probe_output;
+    UWORD32     inplace = base->state & XA_CODEC_FLAG_INPLACE;
 
     /* ...get number of consumed / produced bytes */
     XA_API(base, XA_API_CMD_GET_CURIDX_INPUT_BUF, codec->in_idx, &consumed);
@@ -978,8 +1094,43 @@ static XA_ERRORCODE xa_codec_postprocess(XACodecBase *base, int done)
         }
     }
 
+    /* ...in-place round; input message goes on as output once fully consumed */
+    if (inplace)
+    {
+        /* ...part of the frame may be overwritten already; partial consumption is not allowed */
+        XF_CHK_ERR(consumed == 0 || consumed == (WORD32)codec->input.length, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        if (consumed)
+        {
+            xf_message_t   *m = xf_input_port_detach(&codec->input);
+
+            if(comp_type == XAF_ENCODER)
+            {
+                codec->consumed += consumed / codec->sample_size;
+            }
+
+            if (produced)
+            {
+                codec->produced += produced / codec->sample_size;
+
+                /* ...output buffer travels downstream in place of the input one */
+                xf_output_port_produce_lent(&codec->output, produced, m);
+            }
+            else
+            {
+                /* ...nothing to pass on; return input message to its source */
+                xf_response(m);
+            }
+        }
+
+        /* ...restore internal input buffer; both ports are set up anew next time */
+        XA_API(base, XA_API_CMD_SET_MEM_PTR, codec->in_idx, codec->input.buffer);
+
+        base->state &= ~(XA_CODEC_FLAG_INPLACE | XA_CODEC_FLAG_INPUT_SETUP | XA_CODEC_FLAG_OUTPUT_SETUP);
+    }
+
     /* ...input buffer maintenance; check if we consumed anything */
-    if (consumed)
+    if (consumed && !inplace)
     {
         if(comp_type == XAF_ENCODER)
         {
@@ -993,7 +1144,7 @@ static XA_ERRORCODE xa_codec_postprocess(XACodecBase *base, int done)
     }
 
     /* ...output buffer maintenance; check if we have produced anything */
-    if (produced)
+    if (produced && !inplace)
     {
         /* ...increment total number of produced samples (really don't like division here - tbd) */
         codec->produced += produced / codec->sample_size;
@@ -1104,6 +1255,15 @@ static XA_ERRORCODE xa_codec_getparam(XACodecBase *base, WORD32 id, pVOID value)
 
         return XA_NO_ERROR;
     }
+    else if (XAF_PORT_DEPTH_ID(id))
+    {
+        /* ...make sure output port is addressed */
+        XF_CHK_ERR(XAF_PORT_DEPTH_PORT(id) == 1, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        *(UWORD32 *)value = xf_output_port_depth(&codec->output);
+
+        return XA_NO_ERROR;
+    }
     else
     {
         /* ...pass command to underlying codec plugin */
@@ -1179,6 +1339,11 @@ static int xa_audio_codec_terminate(xf_component_t *component, xf_message_t *m)
         TRACE(OUTPUT, _b("component processing ignored.."));
         return -1;
     }
+    else if ((m = xf_output_port_fanout(&codec->output, m)) == NULL)
+    {
+        /* ...message held by fan-out bookkeeping; keep waiting */
+        return 0;
+    }
     /* ...check if we received output port control message */
     else if (m == xf_output_port_control_msg(&codec->output))
     {
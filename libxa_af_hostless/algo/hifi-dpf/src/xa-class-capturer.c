@@ -75,6 +75,9 @@ typedef struct XACapturer
     /* ...internal message scheduling flag (shared with interrupt) */
     UWORD32                 schedule;
 
+    /* ...output buffers are handed to the capturer DMA */
+    UWORD32                 zero_copy;
+
     /***************************************************************************
      * response message pointer 
      **************************************************************************/
@@ -93,6 +96,17 @@ typedef struct XACapturer
  * Data processing scheduling
  ******************************************************************************/
 
+/* ...hand an empty output buffer to a zero-copy capturer */
+static inline void xa_capturer_give_buffer(XACapturer *capturer, xf_message_t *m)
+{
+    XACodecBase    *base = (XACodecBase *)capturer;
+
+    if (capturer->zero_copy)
+    {
+        XA_API_NORET(base, XA_API_CMD_SET_CONFIG_PARAM, XA_CAPTURER_CONFIG_PARAM_DMA_BUFFER, m->buffer);
+    }
+}
+
 /* ...prepare codec for steady operation (tbd - don't absolutely like it) */
 static inline XA_ERRORCODE xa_capturer_prepare_runtime(XACapturer *capturer)
 {
@@ -125,10 +139,25 @@ static inline XA_ERRORCODE xa_capturer_prepare_runtime(XACapturer *capturer)
 
     BUG(capturer->factor * capturer->sample_size != factor, _x("Freq mismatch: %u vs %u"), capturer->factor * capturer->sample_size, factor);
 
+    /* ...let the DMA fill output buffers in place if the plugin supports it
+     * and the port buffers are exactly one period */
+    if (base->process((xa_codec_handle_t)base->api.addr, XA_API_CMD_GET_CONFIG_PARAM,
+                      XA_CAPTURER_CONFIG_PARAM_ZERO_COPY, &capturer->zero_copy) != XA_NO_ERROR ||
+        capturer->output.length != msg->output_length[0])
+    {
+        capturer->zero_copy = 0;
+    }
+
     /* ...pass response to caller (push out of output port) */
     /*here the capturer would be sending the response back to the app*/
     xf_output_port_produce(&capturer->output, sizeof(*msg));
 
+    /* ...buffers queued during initialization are available right away */
+    for (m = xf_msg_queue_head(&capturer->output.queue); m; m = m->next)
+    {
+        xa_capturer_give_buffer(capturer, m);
+    }
+
     /* ...codec runtime initialization is completed */
     TRACE(INIT, _b("codec[%p] runtime initialized: o=%u"), capturer, msg->output_length[0]);
 
@@ -252,6 +281,9 @@ static XA_ERRORCODE xa_capturer_fill_this_buffer(XACodecBase *base, xf_message_t
 
         /* ...adjust message length (may be shorter than original) */
         m->length = capturer->output.length;
+
+        /* ...buffer is empty; the DMA may write into it straight away */
+        xa_capturer_give_buffer(capturer, m);
     }
 
     /* ...place message into output port */
@@ -547,6 +579,30 @@ static XA_ERRORCODE xa_capturer_suspend_resume(XACodecBase *base, xf_message_t *
 	return XA_NO_ERROR;
 }
 
+/* ...get configuration parameter */
+static XA_ERRORCODE xa_capturer_getparam(XACodecBase *base, WORD32 id, pVOID value)
+{
+    XACapturer *capturer = (XACapturer *) base;
+
+    if (XAF_PORT_DEPTH_ID(id))
+    {
+        /* ...make sure output port is addressed */
+#if CAPTURER_PORT_RENAME
+        XF_CHK_ERR(XAF_PORT_DEPTH_PORT(id) == 0, XA_API_FATAL_INVALID_CMD_TYPE);
+#else
+        XF_CHK_ERR(XAF_PORT_DEPTH_PORT(id) == 1, XA_API_FATAL_INVALID_CMD_TYPE);
+#endif
+        *(UWORD32 *)value = xf_output_port_depth(&capturer->output);
+
+        return XA_NO_ERROR;
+    }
+    else
+    {
+        /* ...pass command to underlying capturer plugin */
+        return XA_API(base, XA_API_CMD_GET_CONFIG_PARAM, id, value);
+    }
+}
+
 /*******************************************************************************
  * Component entry point
  ******************************************************************************/
@@ -689,6 +745,7 @@ xf_component_t * xa_capturer_factory(UWORD32 core, xa_codec_func_t process, xaf_
     capturer->base.memtab = xa_capturer_memtab;
     capturer->base.preprocess = xa_capturer_preprocess;
     capturer->base.postprocess = xa_capturer_postprocess;
+    capturer->base.getparam = xa_capturer_getparam;
 
     /* ...set message commands processing table */
     capturer->base.command = xa_capturer_cmd;
@@ -73,6 +73,12 @@ typedef struct XAInTrack
     /* ...total amount of consumed frames since last synchronization point */
     UWORD32             consumed;
 
+    /* ...readiness policy (XAF_PORT_POLICY_*) */
+    UWORD32             policy;
+
+    /* ...optional port wait limit in bytes queued on a required port */
+    UWORD32             threshold;
+
 }   XAInTrack;
 
 /* ...mimo-proc - output data */
@@ -275,6 +281,48 @@ static inline UWORD32 xa_mimo_proc_check_active(XAMimoProc *mimo_proc)
     return cnt;
 }
 
+/* ...count the active input tracks the component must wait for */
+static inline UWORD32 xa_mimo_proc_check_required(XAMimoProc *mimo_proc)
+{
+    XAInTrack      *track;
+    UWORD32        i;
+    UWORD32        cnt = 0;
+
+    for (track = &mimo_proc->in_track[i = 0]; i < mimo_proc->num_in_ports; i++, track++)
+    {
+        if (track->policy == XAF_PORT_POLICY_REQUIRED && xa_in_track_test_flags(track, XA_IN_TRACK_FLAG_RECVD_DATA | XA_IN_TRACK_FLAG_ACTIVE))
+            cnt++;
+    }
+    return cnt ? cnt : xa_mimo_proc_check_active(mimo_proc);
+}
+
+/* ...check if required input tracks have queued more than given number of bytes */
+static inline UWORD32 xa_mimo_proc_input_port_lagging(XAMimoProc *mimo_proc, UWORD32 threshold)
+{
+    XAInTrack      *track;
+    UWORD32        i;
+    UWORD32        queued;
+
+    for (track = &mimo_proc->in_track[i = 0]; i < mimo_proc->num_in_ports; i++, track++)
+    {
+        if (track->policy != XAF_PORT_POLICY_REQUIRED)  continue;
+
+        if (!xa_in_track_test_flags(track, XA_IN_TRACK_FLAG_ACTIVE) || xa_in_track_test_flags(track, XA_IN_TRACK_FLAG_PAUSED))  continue;
+
+        queued = xf_input_port_queued(&track->input);
+
+        if (queued > threshold)
+            return 1;
+
+        /* ...a full frame with data held behind it: the route depth is not
+         * known here, so the producer may be out of buffers and nothing
+         * would run the component again; stop waiting */
+        if (queued > track->input.length)
+            return 1;
+    }
+    return 0;
+}
+
 static inline UWORD32 xa_mimo_proc_input_port_ready(XAMimoProc *mimo_proc)
 {
     XAInTrack      *track;
@@ -290,6 +338,9 @@ static inline UWORD32 xa_mimo_proc_input_port_ready(XAMimoProc *mimo_proc)
             continue;
         }
 
+        /* ...zero-filled port alone does not make component ready */
+        if (track->policy == XAF_PORT_POLICY_ZERO_FILL)  continue;
+
         /* ...tbd - check only XA_IN_TRACK_FLAG_ACTIVE here? */
         if (xa_in_track_test_flags(track, XA_IN_TRACK_FLAG_RECVD_DATA | XA_IN_TRACK_FLAG_ACTIVE) && xf_input_port_ready(&track->input))
             ports_ready++;
@@ -1208,14 +1259,38 @@ static XA_ERRORCODE xa_mimo_proc_preprocess(XACodecBase *base)
 
             /* ...retrieve number of bytes available */
             filled = xf_input_port_level(&in_track->input);
+
+            /* ...apply optional port policy if frame is not complete */
+            if (!xf_input_port_done(&in_track->input) && filled < in_track->input.length && !xa_in_track_test_flags(in_track, XA_IN_TRACK_FLAG_PAUSED))
+            {
+                if (in_track->policy == XAF_PORT_POLICY_OPTIONAL)
+                {
+                    /* ...wait for the frame unless required inputs run too far ahead */
+                    if (!xa_mimo_proc_input_port_lagging(mimo_proc, in_track->threshold))
+                    {
+                        return XA_MIMO_PROC_EXEC_NONFATAL_NO_DATA;
+                    }
+
+                    TRACE(INPUT, _b("in_track-%u: threshold reached, passing %u bytes"), i, filled);
+                }
+                else if (in_track->policy == XAF_PORT_POLICY_ZERO_FILL)
+                {
+                    /* ...pad missing data with silence */
+                    memset(in_track->input.buffer + filled, 0, in_track->input.length - filled);
+
+                    in_track->input.filled = filled = in_track->input.length;
+
+                    TRACE(INPUT, _b("in_track-%u: zero-filled"), i);
+                }
+            }
            
             /* ...allow partially filled inputs to components */ 
-            if (!xf_input_port_done(&in_track->input) && !filled && !xa_in_track_test_flags(in_track, XA_IN_TRACK_FLAG_PAUSED))
+            if (!xf_input_port_done(&in_track->input) && !filled && !xa_in_track_test_flags(in_track, XA_IN_TRACK_FLAG_PAUSED) && in_track->policy == XAF_PORT_POLICY_REQUIRED)
             {
                 if ( !XF_CHK_PORT_MASK(mimo_proc->relax_sched, i) )
                 {
                     inport_nodata++; 
-                    if (inport_nodata == xa_mimo_proc_check_active(mimo_proc))
+                    if (inport_nodata == xa_mimo_proc_check_required(mimo_proc))
                     {
                         return XA_MIMO_PROC_EXEC_NONFATAL_NO_DATA;
                     }
@@ -1513,6 +1588,29 @@ static XA_ERRORCODE xa_mimo_proc_postprocess(XACodecBase *base, int done)
     return XA_NO_ERROR;
 }
 
+/* ...get configuration parameter */
+static XA_ERRORCODE xa_mimo_proc_getparam(XACodecBase *base, WORD32 id, pVOID value)
+{
+    XAMimoProc     *mimo_proc = (XAMimoProc *) base;
+
+    if (XAF_PORT_DEPTH_ID(id))
+    {
+        UWORD32     i = XAF_PORT_DEPTH_PORT(id) - mimo_proc->num_in_ports;
+
+        /* ...make sure output port is addressed */
+        XF_CHK_ERR(i < mimo_proc->num_out_ports, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        *(UWORD32 *)value = xf_output_port_depth(&mimo_proc->out_track[i].output);
+
+        return XA_NO_ERROR;
+    }
+    else
+    {
+        /* ...pass command to underlying codec plugin */
+        return XA_API(base, XA_API_CMD_GET_CONFIG_PARAM, id, value);
+    }
+}
+
 /* ...set configuration parameter */
 static XA_ERRORCODE xa_mimo_proc_setparam(XACodecBase *base, WORD32 id, pVOID value)
 {
@@ -1531,6 +1629,22 @@ static XA_ERRORCODE xa_mimo_proc_setparam(XACodecBase *base, WORD32 id, pVOID va
         mimo_proc->relax_sched = *(UWORD32 *) value;
         return XA_NO_ERROR;
     }
+    else if (id == XAF_COMP_CONFIG_PARAM_PORT_POLICY)
+    {
+        UWORD32     i = *(UWORD32 *) value >> 24;
+        UWORD32     policy = (*(UWORD32 *) value >> 16) & 0xFF;
+
+        /* ...policy applies to input ports only */
+        XF_CHK_ERR(i < mimo_proc->num_in_ports, XA_API_FATAL_INVALID_CMD_TYPE);
+        XF_CHK_ERR(policy <= XAF_PORT_POLICY_ZERO_FILL, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        mimo_proc->in_track[i].policy = policy;
+        mimo_proc->in_track[i].threshold = *(UWORD32 *) value & 0xFFFF;
+
+        TRACE(INIT, _b("mimo_proc[%p]::in_track[%u] policy=%u, threshold=%u bytes"), mimo_proc, i, policy, mimo_proc->in_track[i].threshold);
+
+        return XA_NO_ERROR;
+    }
     else
     {
         /* ...pass command to underlying codec plugin */
@@ -1975,6 +2089,7 @@ xf_component_t * xa_mimo_proc_factory(UWORD32 core, xa_codec_func_t process, xaf
     mimo_proc->base.memtab = xa_mimo_proc_memtab;
     mimo_proc->base.preprocess = xa_mimo_proc_preprocess;
     mimo_proc->base.postprocess = xa_mimo_proc_postprocess;
+    mimo_proc->base.getparam = xa_mimo_proc_getparam;
     mimo_proc->base.setparam = xa_mimo_proc_setparam;
 
     /* ...set message-processing table */
@@ -35,11 +35,45 @@
 #include "xf-dp.h"
 #include "xa-class-base.h"
 #include "audio/xa-mixer-api.h"
+#include "xf-pcm.h"
 
 /*******************************************************************************
  * Data structures
  ******************************************************************************/
 
+/* ...track rate converter: number of filter phases and taps */
+#define XA_TRACK_SRC_PHASES             64
+#define XA_TRACK_SRC_TAPS               4
+
+/* ...track rate converter: maximal number of channels */
+#define XA_TRACK_SRC_MAX_CHANNELS       8
+
+/* ...track sample rate converter state */
+typedef struct XATrackSRC
+{
+    /* ...track sample rate (zero if track runs at mixer rate) */
+    UWORD32                 rate;
+
+    /* ...phase increment per output sample (zero if conversion is disabled) */
+    UWORD32                 step;
+
+    /* ...output position past the latest input sample (in 1/mixer-rate units) */
+    UWORD32                 phase;
+
+    /* ...history ring head (latest input sample) */
+    UWORD32                 head;
+
+    /* ...bytes collected of an input sample split between messages */
+    UWORD32                 pending;
+
+    /* ...input sample split between messages */
+    WORD32                  frame[XA_TRACK_SRC_MAX_CHANNELS];
+
+    /* ...last input samples */
+    WORD32                  hist[XA_TRACK_SRC_TAPS][XA_TRACK_SRC_MAX_CHANNELS];
+
+}   XATrackSRC;
+
 /* ...mixed source - input data */
 typedef struct XATrack
 {
@@ -55,6 +89,9 @@ typedef struct XATrack
     /* ...total amount of rendered frames (consumed) since last synchronization point */
     UWORD32                 rendered;
 
+    /* ...sample rate converter */
+    XATrackSRC              src;
+
 }   XATrack;
 
 /*******************************************************************************
@@ -111,11 +148,16 @@ typedef struct XAMixer
     /* ...audio frame duration */
     UWORD32                 frame_duration;
     
-    /* ...sample size in bytes */
+    /* ...sample size in bytes (all tracks share mixer format) */
     UWORD32                     sample_size;
 
-    /* ...audio byte duration */
-    UWORD32                     factor;
+    /* ...mixer sample rate, number of channels and PCM width */
+    UWORD32                 sample_rate;
+    UWORD32                 channels;
+    UWORD32                 pcm_width;
+
+    /* ...track rate converter filter bank (Q14) */
+    WORD16                  src_coef[XA_TRACK_SRC_PHASES][XA_TRACK_SRC_TAPS];
 
     /* ...presentation timestamp (in samples; local mixer scope) */
     UWORD32                 pts;
@@ -204,6 +246,199 @@ static inline UWORD32 xa_mixer_check_active(XAMixer *mixer)
 }
 #endif
 
+/*******************************************************************************
+ * Track sample rate conversion
+ ******************************************************************************/
+
+/* ...build cubic (Catmull-Rom) interpolation filter bank; it has no
+ * anti-alias filtering, so tracks are only ever converted up in rate */
+static void xa_mixer_src_init(XAMixer *mixer)
+{
+    WORD32      t, t2, t3;
+    UWORD32     i;
+
+    for (i = 0; i < XA_TRACK_SRC_PHASES; i++)
+    {
+        WORD16     *c = mixer->src_coef[i];
+
+        /* ...fractional position in Q14 */
+        t = (WORD32)((i << 14) / XA_TRACK_SRC_PHASES);
+        t2 = (t * t) >> 14;
+        t3 = (t2 * t) >> 14;
+
+        c[0] = (WORD16)((-t3 + 2 * t2 - t) >> 1);
+        c[2] = (WORD16)((-3 * t3 + 4 * t2 + t) >> 1);
+        c[3] = (WORD16)((t3 - t2) >> 1);
+
+        /* ...keep unity DC gain regardless of rounding */
+        c[1] = (WORD16)((1 << 14) - c[0] - c[2] - c[3]);
+    }
+}
+
+/* ...reset track converter state (track is (re)started) */
+static inline void xa_track_src_reset(XATrack *track)
+{
+    XATrackSRC     *s = &track->src;
+
+    s->phase = 0, s->head = 0, s->pending = 0;
+
+    memset(s->hist, 0, sizeof(s->hist));
+}
+
+/* ...enable track converter if track rate differs from mixer one */
+static inline XA_ERRORCODE xa_track_src_setup(XAMixer *mixer, XATrack *track)
+{
+    XATrackSRC     *s = &track->src;
+
+    if (s->rate == 0 || s->rate == mixer->sample_rate)
+    {
+        s->step = 0;
+        return XA_NO_ERROR;
+    }
+
+    /* ...history holds a limited number of channels */
+    XF_CHK_ERR(mixer->channels <= XA_TRACK_SRC_MAX_CHANNELS, XA_MIXER_CONFIG_FATAL_RANGE);
+
+    /* ...interpolation only; decimation would alias without band-limiting */
+    XF_CHK_ERR(s->rate < mixer->sample_rate, XA_MIXER_CONFIG_FATAL_RANGE);
+
+    s->step = s->rate;
+
+    TRACE(INIT, _b("mixer[%p]::track[%u] rate conversion %u -> %u"), mixer, (UWORD32)(track - mixer->track), s->rate, mixer->sample_rate);
+
+    return XA_NO_ERROR;
+}
+
+/* ...push next input sample of the track into converter history */
+static inline int xa_track_src_pull(XAMixer *mixer, XATrack *track)
+{
+    XATrackSRC         *s = &track->src;
+    xf_input_port_t    *port = &track->input;
+    UWORD32             size = mixer->sample_size;
+    UWORD32             n = mixer->channels;
+    WORD32             *x;
+    void               *p;
+    UWORD32             i, k;
+
+    if (s->pending == 0 && xf_input_port_length(port) >= size)
+    {
+        /* ...sample is contiguous in head message; read it in place */
+        p = xf_input_port_data(port);
+    }
+    else
+    {
+        /* ...collect sample split between messages */
+        while (s->pending < size)
+        {
+            if ((p = xf_input_port_data(port)) == NULL)
+            {
+                return 0;
+            }
+
+            ((k = xf_input_port_length(port)) > size - s->pending ? k = size - s->pending : 0);
+
+            memcpy((UWORD8 *)s->frame + s->pending, p, k);
+
+            s->pending += k;
+
+            xf_input_port_skip(port, k);
+        }
+
+        p = s->frame, s->pending = 0;
+    }
+
+    /* ...overwrite oldest history entry */
+    x = s->hist[s->head = (s->head + 1) & (XA_TRACK_SRC_TAPS - 1)];
+
+    if (mixer->pcm_width == 16)
+    {
+        for (i = 0; i < n; i++)
+            x[i] = ((WORD16 *)p)[i];
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+            x[i] = ((WORD32 *)p)[i];
+    }
+
+    /* ...release the sample from the message (may complete it) */
+    (p != s->frame ? xf_input_port_skip(port, size) : 0);
+
+    return 1;
+}
+
+/* ...fill track input buffer with data converted to mixer rate */
+static int xa_track_src_fill(XAMixer *mixer, XATrack *track)
+{
+    XATrackSRC         *s = &track->src;
+    xf_input_port_t    *port = &track->input;
+    UWORD32             rate = mixer->sample_rate;
+    UWORD32             n = mixer->channels;
+    UWORD32             filled = xf_input_port_level(port);
+    UWORD32             i;
+
+    /* ...if there is no message pending, bail out */
+    if (!xf_msg_queue_head(&port->queue))
+    {
+        return 0;
+    }
+
+    while (filled < port->length)
+    {
+        WORD32     *x0, *x1, *x2, *x3;
+        WORD16     *c;
+
+        /* ...advance input history up to current output position */
+        while (s->phase >= rate)
+        {
+            if (!xa_track_src_pull(mixer, track))
+            {
+                /* ...update fill level; buffer is ready only if stream is over */
+                port->filled = filled;
+
+                return xf_input_port_done(port);
+            }
+
+            s->phase -= rate;
+        }
+
+        /* ...output sample lies between x1 and x2 */
+        x0 = s->hist[(s->head + 1) & (XA_TRACK_SRC_TAPS - 1)];
+        x1 = s->hist[(s->head + 2) & (XA_TRACK_SRC_TAPS - 1)];
+        x2 = s->hist[(s->head + 3) & (XA_TRACK_SRC_TAPS - 1)];
+        x3 = s->hist[s->head];
+
+        /* ...select filter phase */
+        c = mixer->src_coef[s->phase * XA_TRACK_SRC_PHASES / rate];
+
+        if (mixer->pcm_width == 16)
+        {
+            WORD16     *y = (WORD16 *)(port->buffer + filled);
+
+            for (i = 0; i < n; i++)
+            {
+                y[i] = xf_pcm_sat16((x0[i] * c[0] + x1[i] * c[1] + x2[i] * c[2] + x3[i] * c[3] + (1 << 13)) >> 14);
+            }
+        }
+        else
+        {
+            WORD32     *y = (WORD32 *)(port->buffer + filled);
+            WORD32      mask = (mixer->pcm_width == 24 ? XF_PCM_MASK_S24 : (WORD32)0xFFFFFFFF);
+
+            for (i = 0; i < n; i++)
+            {
+                y[i] = xf_pcm_sat32(((WORD64)x0[i] * c[0] + (WORD64)x1[i] * c[1] + (WORD64)x2[i] * c[2] + (WORD64)x3[i] * c[3] + (1 << 13)) >> 14) & mask;
+            }
+        }
+
+        filled += mixer->sample_size, s->phase += s->step;
+    }
+
+    port->filled = filled;
+
+    return 1;
+}
+
 /* ...prepare mixer for steady operation */
 static inline XA_ERRORCODE xa_mixer_prepare_runtime(XAMixer *mixer)
 {
@@ -212,6 +447,7 @@ static inline XA_ERRORCODE xa_mixer_prepare_runtime(XAMixer *mixer)
     xf_start_msg_t *msg = m->buffer;
     UWORD32             frame_size;
     UWORD32             factor;
+    UWORD32             i;
     
     /* ...query mixer parameters */
     XA_API(base, XA_API_CMD_GET_CONFIG_PARAM, XA_MIXER_CONFIG_PARAM_SAMPLE_RATE, &msg->sample_rate);
@@ -227,7 +463,12 @@ static inline XA_ERRORCODE xa_mixer_prepare_runtime(XAMixer *mixer)
     TRACE(INIT, _b("mixer[%p]::runtime init: f=%u, c=%u, w=%u, i=%u, o=%u"), mixer, msg->sample_rate, msg->channels, msg->pcm_width, msg->input_length[0], msg->output_length[0]);
 
     /* ...save sample size in bytes */
-    mixer->sample_size = msg->channels * (msg->pcm_width == 16 ? 2 : 4);
+    mixer->sample_size = msg->channels * xf_pcm_sample_size(msg->pcm_width);
+
+    /* ...save mixer format for track rate conversion */
+    mixer->sample_rate = msg->sample_rate;
+    mixer->channels = msg->channels;
+    mixer->pcm_width = msg->pcm_width;
 
     /* ...calculate mixer frame duration; get upsample factor */
     XF_CHK_ERR(factor = xf_timebase_factor(msg->sample_rate), XA_MIXER_CONFIG_FATAL_RANGE);
@@ -235,12 +476,14 @@ static inline XA_ERRORCODE xa_mixer_prepare_runtime(XAMixer *mixer)
     /* ...sample size should be positive */
     XF_CHK_ERR(mixer->sample_size > 0, XA_API_FATAL_INVALID_CMD_TYPE);
 
-    /* ...set frame duration factor (converts number of bytes into timebase units) */
-    mixer->factor = factor / mixer->sample_size;
-
-    TRACE(INIT, _b("ts-factor: %u (%u)"), mixer->factor, factor);
+    /* ...mixer is scheduled by frames; per-byte factor is not exact for 5 or 7 channels anyway */
+    TRACE(INIT, _b("ts-factor: %u"), factor);
 
-    BUG((mixer->factor * mixer->sample_size) != factor, _x("Freq mismatch: %u vs %u"), (mixer->factor * mixer->sample_size), factor);
+    /* ...set up rate conversion of the tracks configured with own sample rate */
+    for (i = 0; i < XA_MIXER_MAX_TRACK_NUMBER; i++)
+    {
+        XA_CHK(xa_track_src_setup(mixer, &mixer->track[i]));
+    }
 
     /* ...set mixer frame duration */
     mixer->frame_duration = frame_size * factor; /* Note: mixer->factor, factor is for samples */
@@ -301,6 +544,9 @@ static XA_ERRORCODE xa_mixer_empty_this_buffer(XACodecBase *base, xf_message_t *
             /* ...save track presentation timestamp */
             track->pts = mixer->pts;
 
+            /* ...restart track rate conversion */
+            xa_track_src_reset(track);
+
             TRACE(INFO, _b("track-%u started (pts=%08x)"), i, track->pts);
         }
         
@@ -357,6 +603,12 @@ static XA_ERRORCODE xa_mixer_fill_this_buffer(XACodecBase *base, xf_message_t *m
    
     /* ...make sure the port is valid */
     XF_CHK_ERR(i == XA_MIXER_MAX_TRACK_NUMBER, XA_API_FATAL_INVALID_CMD_TYPE);
+
+    /* ...buffer shared with fan-out sinks is recycled by the last one */
+    if ((m = xf_output_port_fanout(&mixer->output, m)) == NULL)
+    {
+        return XA_NO_ERROR;
+    }
     
     /* ...process runtime initialization explicitly */
     if (base->state & XA_BASE_FLAG_RUNTIME_INIT)
@@ -471,8 +723,15 @@ static XA_ERRORCODE xa_mixer_port_route(XACodecBase *base, xf_message_t *m)
     /* ...make sure output port is addressed */
     XF_CHK_ERR(XF_MSG_DST_PORT(m->id) == XA_MIXER_MAX_TRACK_NUMBER, XA_API_FATAL_INVALID_CMD_TYPE);
 
-    /* ...make sure port is not routed yet */
-    XF_CHK_ERR(!xf_output_port_routed(port), XA_API_FATAL_INVALID_CMD_TYPE);
+    /* ...routed port fans out to one more sink sharing its buffers */
+    if (xf_output_port_routed(port))
+    {
+        XF_CHK_ERR(xf_output_port_route_add(port, __XF_MSG_ID(dst, src), cmd->alloc_size) == 0, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        xf_response_ok(m);
+
+        return XA_NO_ERROR;
+    }
 
     /* ...route output port - allocate queue */
     XF_CHK_ERR(xf_output_port_route(port, __XF_MSG_ID(dst, src), cmd->alloc_number, cmd->alloc_size, cmd->alloc_align) == 0, XA_API_FATAL_MEM_ALLOC);
@@ -491,6 +750,7 @@ static XA_ERRORCODE xa_mixer_port_unroute(XACodecBase *base, xf_message_t *m)
 {
     XAMixer            *mixer = (XAMixer *) base;
     xf_output_port_t   *port = &mixer->output;
+    xf_unroute_port_msg_t  *cmd = m->buffer;
     
     /* ...command is allowed only in "postinit" state */
     XF_CHK_ERR(base->state & XA_BASE_FLAG_POSTINIT, XA_API_FATAL_INVALID_CMD);
@@ -505,6 +765,14 @@ static XA_ERRORCODE xa_mixer_port_unroute(XACodecBase *base, xf_message_t *m)
         return XA_NO_ERROR;
     }
 
+    /* ...single sink of fanned-out port goes; the others keep running */
+    if (cmd->dst && xf_output_port_fanned_out(port))
+    {
+        XF_CHK_ERR(xf_output_port_unroute_sink(port, cmd->dst, m) >= 0, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        return XA_NO_ERROR;
+    }
+
     /* ...cancel any pending processing */
     xa_base_cancel(base);
 
@@ -700,6 +968,12 @@ static XA_ERRORCODE xa_mixer_flush(XACodecBase *base, xf_message_t *m)
     /* ...check destination port index */
     if (i == XA_MIXER_MAX_TRACK_NUMBER)
     {
+        /* ...fan-out sinks are still flushing */
+        if ((m = xf_output_port_fanout(&mixer->output, m)) == NULL)
+        {
+            return XA_NO_ERROR;
+        }
+
         /* ...flushing response received; that is a port unrouting sequence */
         XF_CHK_ERR(xf_output_port_unrouting(&mixer->output), XA_API_FATAL_INVALID_CMD_TYPE);
         
@@ -921,7 +1195,7 @@ static XA_ERRORCODE xa_mixer_preprocess(XACodecBase *base)
             UWORD32     filled;
             
             /* ...take actual data from input port (mixer is always using internal buffer) */
-            if (!xf_input_port_fill(&track->input))
+            if (!(track->src.step ? xa_track_src_fill(mixer, track) : xf_input_port_fill(&track->input)))
             {
                 /* ...failed to prefill input buffer - no sufficient data yet */
                 inport_nodata_flag = 1; 
@@ -1134,6 +1408,27 @@ static XA_ERRORCODE xa_mixer_postprocess(XACodecBase *base, int done)
     return XA_NO_ERROR;
 }
 
+/* ...get configuration parameter */
+static XA_ERRORCODE xa_mixer_getparam(XACodecBase *base, WORD32 id, pVOID value)
+{
+    XAMixer     *mixer = (XAMixer *) base;
+
+    if (XAF_PORT_DEPTH_ID(id))
+    {
+        /* ...make sure output port is addressed */
+        XF_CHK_ERR(XAF_PORT_DEPTH_PORT(id) == XA_MIXER_MAX_TRACK_NUMBER, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        *(UWORD32 *)value = xf_output_port_depth(&mixer->output);
+
+        return XA_NO_ERROR;
+    }
+    else
+    {
+        /* ...pass command to underlying codec plugin */
+        return XA_API(base, XA_API_CMD_GET_CONFIG_PARAM, id, value);
+    }
+}
+
 /* ...set configuration parameter */
 static XA_ERRORCODE xa_mixer_setparam(XACodecBase *base, WORD32 id, pVOID value)
 {
@@ -1147,6 +1442,26 @@ static XA_ERRORCODE xa_mixer_setparam(XACodecBase *base, WORD32 id, pVOID value)
         mixer->probe_enabled = *(WORD32 *) value;
         return XA_NO_ERROR;
     }
+    else if (id == XA_MIXER_CONFIG_PARAM_TRACK_SAMPLE_RATE)
+    {
+        UWORD32     i = *(UWORD32 *) value >> 24;
+        UWORD32     rate = *(UWORD32 *) value & 0xFFFFFF;
+        XATrack    *track;
+
+        /* ...check track index and rate are sane */
+        XF_CHK_ERR(i < XA_MIXER_MAX_TRACK_NUMBER, XA_MIXER_CONFIG_FATAL_RANGE);
+        XF_CHK_ERR(rate == 0 || xf_timebase_factor(rate), XA_MIXER_CONFIG_FATAL_RANGE);
+
+        track = &mixer->track[i];
+
+        /* ...track rate cannot be changed while the track is running */
+        XF_CHK_ERR(!xa_track_test_flags(track, XA_TRACK_FLAG_ACTIVE | XA_TRACK_FLAG_PAUSED), XA_MIXER_CONFIG_FATAL_TRACK_STATE);
+
+        track->src.rate = rate;
+
+        /* ...apply immediately if mixer runtime is initialized already */
+        return (mixer->sample_rate ? xa_track_src_setup(mixer, track) : XA_NO_ERROR);
+    }
     else
     {
         /* ...pass command to underlying codec plugin */
@@ -1198,6 +1513,12 @@ static int xa_mixer_terminate(xf_component_t *component, xf_message_t *m)
         return -1;
     }
 
+    if ((m = xf_output_port_fanout(&mixer->output, m)) == NULL)
+    {
+        /* ...message held by fan-out bookkeeping; keep waiting */
+        return 0;
+    }
+
     if (m == xf_output_port_control_msg(&mixer->output))
     {
         /* ...output port flushing complete; mark port is idle and terminate */
@@ -1320,8 +1641,12 @@ xf_component_t * xa_mixer_factory(UWORD32 core, xa_codec_func_t process, xaf_com
     mixer->base.memtab = xa_mixer_memtab;
     mixer->base.preprocess = xa_mixer_preprocess;
     mixer->base.postprocess = xa_mixer_postprocess;
+    mixer->base.getparam = xa_mixer_getparam;
     mixer->base.setparam = xa_mixer_setparam;
 
+    /* ...prepare track rate converter filter bank */
+    xa_mixer_src_init(mixer);
+
     /* ...set message-processing table */
     mixer->base.command = xa_mixer_cmd;
     mixer->base.command_num = XA_MIXER_CMD_NUM;
@@ -733,6 +733,28 @@ static XA_ERRORCODE xa_renderer_suspend_resume(XACodecBase *base, xf_message_t *
 	XA_API(base, XA_API_CMD_SET_CONFIG_PARAM, XA_RENDERER_CONFIG_PARAM_STATE, &state);
 	return XA_NO_ERROR;
 }
+
+/* ...get configuration parameter */
+static XA_ERRORCODE xa_renderer_getparam(XACodecBase *base, WORD32 id, pVOID value)
+{
+    XARenderer *renderer = (XARenderer *) base;
+
+    if (XAF_PORT_DEPTH_ID(id))
+    {
+        /* ...make sure output port is addressed */
+        XF_CHK_ERR(XAF_PORT_DEPTH_PORT(id) == 1, XA_API_FATAL_INVALID_CMD_TYPE);
+
+        *(UWORD32 *)value = xf_output_port_depth(&renderer->output);
+
+        return XA_NO_ERROR;
+    }
+    else
+    {
+        /* ...pass command to underlying renderer plugin */
+        return XA_API(base, XA_API_CMD_GET_CONFIG_PARAM, id, value);
+    }
+}
+
 /*******************************************************************************
  * Command-processing function
  ******************************************************************************/
@@ -871,6 +893,7 @@ xf_component_t * xa_renderer_factory(UWORD32 core, xa_codec_func_t process,xaf_c
     renderer->base.memtab = xa_renderer_memtab;
     renderer->base.preprocess = xa_renderer_preprocess;
     renderer->base.postprocess = xa_renderer_postprocess;
+    renderer->base.getparam = xa_renderer_getparam;
 
     /* ...set message-processing table */
     renderer->base.command = xa_renderer_cmd;
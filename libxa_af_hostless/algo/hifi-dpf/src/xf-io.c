@@ -234,9 +234,192 @@ int xf_input_port_fill(xf_input_port_t *port)
     return (n == 0);
 }
 
+/* ...switch non-bypass port into gather mode */
+void xf_input_port_gather_enable(xf_input_port_t *port)
+{
+    /* ...internal buffer takes over data when queued messages are not enough */
+    BUG(xf_input_port_bypass(port), _x("Invalid transaction"));
+
+    port->flags |= XF_INPUT_FLAG_GATHER;
+
+    TRACE(INIT, _b("input-port[%p] gather mode"), port);
+}
+
+/* ...describe data available in gather port as a list of segments */
+int xf_input_port_gather(xf_input_port_t *port, void **ptr, UWORD32 *length, UWORD32 *num)
+{
+    xf_message_t   *m = xf_msg_queue_head(&port->queue);
+    UWORD32         max = *num;
+    UWORD32         total = 0;
+    UWORD32         n = 0;
+    int             eos = xf_input_port_done(port);
+
+    BUG(!xf_input_port_gather_mode(port), _x("Invalid transaction"));
+
+    /* ...data left in internal buffer goes first */
+    if (port->filled)
+    {
+        ptr[n] = port->buffer, length[n++] = total = port->filled;
+    }
+
+    /* ...followed by queued messages; the head one may be partially consumed */
+    for (; !eos && m && n < max && total < port->length; m = m->next)
+    {
+        void       *p = (m == xf_msg_queue_head(&port->queue) ? port->access : m->buffer);
+        UWORD32     k = (m == xf_msg_queue_head(&port->queue) ? port->remaining : m->length);
+
+        /* ...zero-length message terminates the stream */
+        if (k == 0)
+        {
+            eos = 1;
+            break;
+        }
+
+        ptr[n] = p, length[n++] = k, total += k;
+    }
+
+    /* ...enough data to process or no more data to wait for */
+    if (eos || total >= port->length)
+    {
+        *num = n;
+        return 1;
+    }
+
+    /* ...source may be starving for these buffers; take the data over and release them */
+    if (xf_msg_queue_head(&port->queue) && xf_input_port_fill(port))
+    {
+        ptr[0] = port->buffer, length[0] = port->filled, *num = 1;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* ...get head message buffer if it may be processed in place */
+void * xf_input_port_inplace(xf_input_port_t *port)
+{
+    xf_message_t   *m = xf_msg_queue_head(&port->queue);
+
+    BUG(xf_input_port_bypass(port), _x("Invalid transaction"));
+
+    /* ...nothing buffered internally and head message holds exactly one untouched frame */
+    if (xf_input_port_gather_mode(port) || port->filled || !m)      return NULL;
+    if (port->access != m->buffer || port->remaining != port->length)   return NULL;
+
+    /* ...buffer must be private to this port and local to this core */
+    if (XF_MSG_SRC_PROXY(m->id) || XF_MSG_SRC_READONLY(m->id) || XF_MSG_SHARED(m->id))
+    {
+        return NULL;
+    }
+
+    return m->buffer;
+}
+
+/* ...take head message out of the port without completing it */
+xf_message_t * xf_input_port_detach(xf_input_port_t *port)
+{
+    xf_message_t   *m = xf_msg_dequeue(&port->queue);
+    xf_message_t   *n;
+
+    /* ...message cannot be NULL */
+    BUG(m == NULL, _x("invalid port state"));
+
+    /* ...set up next head */
+    if ((n = xf_msg_queue_head(&port->queue)) != NULL)
+    {
+        port->access = n->buffer, port->remaining = n->length;
+
+        /* ...check if end-of-stream message is at the head now */
+        if (!port->access && !xf_input_port_done(port))
+        {
+            BUG((port->flags & XF_INPUT_FLAG_EOS) == 0, _x("port[%p]: invalid state: %x"), port, port->flags);
+
+            port->flags ^= XF_INPUT_FLAG_EOS | XF_INPUT_FLAG_DONE;
+
+            TRACE(INPUT, _b("input-port[%p] done"), port);
+        }
+    }
+    else
+    {
+        port->access = NULL, port->remaining = 0;
+    }
+
+    return m;
+}
+
+/* ...get total amount of data held by the port (internal buffer and queued messages) */
+UWORD32 xf_input_port_queued(xf_input_port_t *port)
+{
+    xf_message_t   *m = xf_msg_queue_head(&port->queue);
+    UWORD32         n = port->filled;
+
+    if (m)
+    {
+        /* ...head message may be partially consumed */
+        for (n += port->remaining, m = m->next; m; m = m->next)
+        {
+            n += m->length;
+        }
+    }
+
+    return n;
+}
+
+/* ...consume data of queued messages, leaving internal buffer intact */
+void xf_input_port_skip(xf_input_port_t *port, UWORD32 n)
+{
+    UWORD32     k;
+
+    BUG(xf_input_port_bypass(port), _x("Invalid transaction"));
+
+    while (n)
+    {
+        BUG(!port->access, _x("invalid port state"));
+
+        k = (n < port->remaining ? n : port->remaining);
+
+        port->access += k, n -= k;
+
+        if ((port->remaining -= k) == 0 && !xf_input_port_complete(port))
+        {
+            break;
+        }
+    }
+
+    /* ...check if end-of-stream message is at the head now */
+    if (!xf_input_port_done(port) && xf_msg_queue_head(&port->queue) && !port->access)
+    {
+        BUG((port->flags & XF_INPUT_FLAG_EOS) == 0, _x("port[%p]: invalid state: %x"), port, port->flags);
+
+        /* ...mark stream is completed */
+        port->flags ^= XF_INPUT_FLAG_EOS | XF_INPUT_FLAG_DONE;
+
+        TRACE(INPUT, _b("input-port[%p] done"), port);
+    }
+}
+
 /* ...consume input buffer data */
 void xf_input_port_consume(xf_input_port_t *port, UWORD32 n)
 {
+    /* ...gather port consumes internal buffer first, then queued messages */
+    if (xf_input_port_gather_mode(port))
+    {
+        UWORD32     k = (n < port->filled ? n : port->filled);
+
+        if (k)
+        {
+            /* ...move tail of buffer to the head (safe to use memcpy) */
+            memcpy(port->buffer, port->buffer + k, port->filled - k);
+
+            port->filled -= k, n -= k;
+        }
+
+        xf_input_port_skip(port, n);
+
+        return;
+    }
+
+
     /* ...check whether input port is in bypass mode */
     if (xf_input_port_bypass(port))
     {
@@ -298,7 +481,7 @@ void xf_input_port_purge(xf_input_port_t *port)
     port->filled = 0, port->access = NULL;
     
     /* ...reset port flags */
-    port->flags = (port->flags & ~__XF_INPUT_FLAGS(~0)) | XF_INPUT_FLAG_ENABLED | XF_INPUT_FLAG_CREATED;
+    port->flags = (port->flags & ~__XF_INPUT_FLAGS(~XF_INPUT_FLAG_GATHER)) | XF_INPUT_FLAG_ENABLED | XF_INPUT_FLAG_CREATED;
     
     TRACE(INPUT, _b("input-port[%p] purged"), port);
 }
@@ -374,12 +557,19 @@ int xf_output_port_route(xf_output_port_t *port, UWORD32 id, UWORD32 n, UWORD32
 {
     UWORD32             core = XF_MSG_DST_CORE(id);
     UWORD32             shared = XF_MSG_SHARED(id);
+    UWORD32             adaptive = ((n & XF_ROUTE_ADAPTIVE) != 0);
     xf_message_t   *m;
     UWORD32             i;
-    
+
+    /* ...adaptive route allocates buffers up to the limit but circulates a few */
+    n &= ~XF_ROUTE_ADAPTIVE;
+    adaptive = (adaptive && n > XF_OUTPUT_PORT_MIN_DEPTH);
+
     /* ...allocate message pool for a port; extra message for control */
     XF_CHK_API(xf_msg_pool_init(&port->pool, n + 1, core));
 
+    xf_msg_queue_init(&port->reserve);
+
     /* ...allocate required amount of buffers */
     for (i = 1; i <= n; i++)
     {
@@ -398,8 +588,15 @@ int xf_output_port_route(xf_output_port_t *port, UWORD32 id, UWORD32 n, UWORD32
         /* ...if allocation failed, do a cleanup */
         if (!m->buffer)     goto error;
 
-        /* ...place message into output port */
-        xf_msg_enqueue(&port->queue, m);
+        /* ...place message into output port or keep it for later growth */
+        if (adaptive && i > XF_OUTPUT_PORT_MIN_DEPTH)
+        {
+            xf_msg_enqueue(&port->reserve, m);
+        }
+        else
+        {
+            xf_msg_enqueue(&port->queue, m);
+        }
     }
 
     /* ...setup flow-control message */
@@ -414,13 +611,17 @@ int xf_output_port_route(xf_output_port_t *port, UWORD32 id, UWORD32 n, UWORD32
     /* ...save port length */
     port->length = length;
 
+    /* ...set number of buffers in circulation; no stall seen yet */
+    port->depth = (adaptive ? XF_OUTPUT_PORT_MIN_DEPTH : n);
+    port->stall_age = port->depth;
+
     /* ...mark port is routed */
-    port->flags |= XF_OUTPUT_FLAG_ROUTED;
+    port->flags |= XF_OUTPUT_FLAG_ROUTED | (adaptive ? XF_OUTPUT_FLAG_ADAPTIVE : 0);
 
     /* ...clear port idle flag */
     port->flags &= ~XF_OUTPUT_FLAG_IDLE;
 
-    TRACE(ROUTE, _b("output-port[%p] routed: %03x -> %03x"), port, XF_MSG_DST(id), XF_MSG_SRC(id));
+    TRACE(ROUTE, _b("output-port[%p] routed: %03x -> %03x, depth %u/%u"), port, XF_MSG_DST(id), XF_MSG_SRC(id), port->depth, n);
 
     return 0;
 
@@ -437,12 +638,325 @@ error:
     /* ...destroy pool data */
     xf_msg_pool_destroy(&port->pool, core);
     
-    /* ...reset message queue (it is empty again) */
+    /* ...reset message queues (they are empty again) */
     xf_msg_queue_init(&port->queue);
+    xf_msg_queue_init(&port->reserve);
 
     return XAF_MEMORY_ERR;
 }
 
+/* ...route output port to one more sink; the sink shares buffers of the port */
+int xf_output_port_route_add(xf_output_port_t *port, UWORD32 id, UWORD32 length)
+{
+    xf_message_t   *c = xf_output_port_control_msg(port);
+    UWORD32             core = XF_MSG_DST_CORE(c->id);
+    UWORD32             n = port->pool.n - 1;
+    xf_msg_pool_t  *pool;
+    xf_message_t   *m;
+    UWORD32             i;
+
+    /* ...port must be routed already */
+    BUG(!xf_output_port_routed(port), _x("invalid state: %x"), port->flags);
+
+    /* ...sink must fit into port buffers and have same memory visibility */
+    XF_CHK_ERR(port->sinks < XF_OUTPUT_PORT_MAX_SINKS - 1, XAF_ROUTING_ERR);
+    XF_CHK_ERR(length <= port->length, XAF_INVALIDVAL_ERR);
+    XF_CHK_ERR(XF_MSG_DST_CORE(id) == core && XF_MSG_SHARED(id) <= XF_MSG_SHARED(c->id), XAF_ROUTING_ERR);
+
+    /* ...no new sink while buffers are being collected */
+    XF_CHK_ERR(!xf_output_port_flushing(port) && !xf_output_port_unrouting(port), XAF_ROUTING_ERR);
+
+    /* ...reference counters are allocated along with the first fan-out sink */
+    if (port->sinks == 0)
+    {
+        XF_CHK_ERR(port->refcount = xf_mem_alloc(n * sizeof(UWORD32), sizeof(UWORD32), core, 0), XAF_MEMORY_ERR);
+
+        /* ...buffers in flight are held by the first sink only */
+        memset(port->refcount, 0, n * sizeof(UWORD32));
+    }
+
+    /* ...allocate sink message pool; extra message for control */
+    pool = &port->sink_pool[port->sinks];
+
+    if (xf_msg_pool_init(pool, n + 1, core) != 0)
+    {
+        if (port->sinks == 0)
+        {
+            xf_mem_free(port->refcount, n * sizeof(UWORD32), core, 0), port->refcount = NULL;
+        }
+
+        return XAF_MEMORY_ERR;
+    }
+
+    /* ...sink messages alias port buffers one-to-one */
+    for (i = 1; i <= n; i++)
+    {
+        m = xf_msg_pool_item(pool, i);
+
+        m->next = NULL;
+        m->id = id | (__XF_PORT_READONLY << 16);
+        m->opcode = XF_FILL_THIS_BUFFER;
+        m->length = port->length;
+
+        /* ...buffer lent out by an input message is kept by that message meanwhile */
+        if (port->lent && port->lent[i - 1])
+        {
+            m->buffer = port->lent[i - 1]->buffer;
+        }
+        else
+        {
+            m->buffer = xf_msg_pool_item(&port->pool, i)->buffer;
+        }
+    }
+
+    /* ...setup sink flow-control message */
+    m = xf_msg_pool_item(pool, 0);
+    m->next = NULL;
+    m->id = id;
+    m->length = 0;
+    m->buffer = NULL;
+
+    port->sinks++;
+
+    TRACE(ROUTE, _b("output-port[%p] fan-out #%u: %03x -> %03x"), port, port->sinks, XF_MSG_DST(id), XF_MSG_SRC(id));
+
+    return 0;
+}
+
+/* ...internal helper - give own buffer back to the message and release the lender */
+static inline xf_message_t * xf_output_port_reclaim(xf_output_port_t *port, xf_message_t *m)
+{
+    xf_message_t   *l;
+    void           *b;
+    UWORD32             i;
+
+    /* ...bail out if nothing has ever been lent */
+    if (!port->lent || !xf_msg_from_pool(&port->pool, m))     return m;
+
+    i = (UWORD32)((__xf_message_t *)m - port->pool.p);
+
+    if (i == 0 || (l = port->lent[i - 1]) == NULL)      return m;
+
+    port->lent[i - 1] = NULL;
+
+    /* ...swap buffers back and return input message to its source */
+    b = m->buffer, m->buffer = l->buffer, l->buffer = b;
+
+    xf_response(l);
+
+    return m;
+}
+
+/* ...internal helper - flow-control message of a sink (0 is the first one) */
+static inline xf_message_t * xf_output_port_sink_control(xf_output_port_t *port, UWORD32 k)
+{
+    return (k ? xf_msg_pool_item(&port->sink_pool[k - 1], 0) : xf_output_port_control_msg(port));
+}
+
+/* ...internal helper - check if sink takes port buffers (0 is the first one) */
+static inline int xf_output_port_sink_active(xf_output_port_t *port, UWORD32 k)
+{
+    if (port->unroute_sink && port->unroute_idx == k)       return 0;
+
+    return (k || !(port->flags & XF_OUTPUT_FLAG_DETACHED));
+}
+
+/* ...internal helper - drop unrouted sink and complete the saved command */
+static void xf_output_port_unroute_sink_done(xf_output_port_t *port)
+{
+    UWORD32             core = XF_MSG_DST_CORE(xf_output_port_control_msg(port)->id);
+    UWORD32             n = port->pool.n - 1;
+    UWORD32             k = port->unroute_idx;
+    xf_message_t   *m = port->unroute_sink;
+
+    port->unroute_sink = NULL;
+
+    if (k == 0)
+    {
+        /* ...port messages keep circulating through the fan-out sinks only */
+        port->flags |= XF_OUTPUT_FLAG_DETACHED;
+    }
+    else
+    {
+        /* ...buffers belong to the port pool; only sink messages go away */
+        xf_msg_pool_destroy(&port->sink_pool[k - 1], core);
+
+        for (; k < port->sinks; k++)
+        {
+            port->sink_pool[k - 1] = port->sink_pool[k];
+        }
+
+        /* ...single remaining sink is the first one; no reference counting needed */
+        if (--port->sinks == 0)
+        {
+            xf_mem_free(port->refcount, n * sizeof(UWORD32), core, 0), port->refcount = NULL;
+        }
+    }
+
+    TRACE(ROUTE, _b("output-port[%p] sink #%u unrouted"), port, port->unroute_idx);
+
+    xf_response_ok(m);
+}
+
+/* ...unroute one sink of fanned-out port leaving the others running */
+int xf_output_port_unroute_sink(xf_output_port_t *port, UWORD32 dst, xf_message_t *m)
+{
+    xf_message_t   *c;
+    UWORD32             k;
+
+    /* ...one sink at a time, and not while the port collects its buffers */
+    XF_CHK_ERR(xf_output_port_fanned_out(port) && !port->unroute_sink, XAF_ROUTING_ERR);
+    XF_CHK_ERR(!xf_output_port_flushing(port) && !xf_output_port_unrouting(port), XAF_ROUTING_ERR);
+
+    /* ...find sink by its port specification */
+    for (k = 0; k <= port->sinks; k++)
+    {
+        if (xf_output_port_sink_active(port, k) && XF_MSG_SRC(xf_output_port_sink_control(port, k)->id) == dst)
+        {
+            break;
+        }
+    }
+
+    XF_CHK_ERR(k <= port->sinks, XAF_ROUTING_ERR);
+
+    port->unroute_sink = m;
+    port->unroute_idx = k;
+
+    /* ...idle port owns every buffer; sink may go instantly */
+    if (port->flags & XF_OUTPUT_FLAG_IDLE)
+    {
+        xf_output_port_unroute_sink_done(port);
+        return 1;
+    }
+
+    /* ...sink returns the buffers it holds, then its flow-control message */
+    c = xf_output_port_sink_control(port, k);
+    c->opcode = XF_FLUSH;
+    xf_response(c);
+
+    return 0;
+}
+
+/* ...resolve message returned by a sink to the one the port owner should process */
+xf_message_t * xf_output_port_fanout(xf_output_port_t *port, xf_message_t *m)
+{
+    xf_message_t   *c = xf_output_port_control_msg(port);
+    xf_msg_pool_t  *pool = NULL;
+    UWORD32             i, k;
+
+    /* ...port with a single sink passes everything through */
+    if (port->sinks == 0)       return xf_output_port_reclaim(port, m);
+
+    if (xf_msg_from_pool(&port->pool, m))
+    {
+        pool = &port->pool;
+    }
+    else
+    {
+        for (k = 0; k < port->sinks && !pool; k++)
+        {
+            if (xf_msg_from_pool(&port->sink_pool[k], m))      pool = &port->sink_pool[k];
+        }
+
+        /* ...not a message of this port */
+        if (!pool)      return m;
+    }
+
+    i = (UWORD32)((__xf_message_t *)m - pool->p);
+
+    /* ...sink being unrouted has given back everything it held */
+    if (i == 0 && port->unroute_sink && m == xf_output_port_sink_control(port, port->unroute_idx))
+    {
+        xf_output_port_unroute_sink_done(port);
+    }
+    else
+    {
+        /* ...lost sink turns the port into an invalid one once everything is back */
+        if (m->length == XF_MSG_LENGTH_INVALID)
+        {
+            port->flags |= XF_OUTPUT_FLAG_SINK_LOST;
+        }
+
+        if (i == 0 && m == c)
+        {
+            /* ...first sink completed flushing */
+            port->flags |= XF_OUTPUT_FLAG_PARKED;
+        }
+        else if (i == 0)
+        {
+            BUG(port->pending == 0, _x("unexpected flow-control message"));
+
+            /* ...fan-out sink completed flushing */
+            port->pending--;
+        }
+    }
+
+    if (i == 0)
+    {
+        /* ...flushing sequence completes once the last sink is done */
+        if (port->pending || port->unroute_sink || !(port->flags & XF_OUTPUT_FLAG_PARKED))
+        {
+            return NULL;
+        }
+
+        port->flags &= ~XF_OUTPUT_FLAG_PARKED;
+
+        if (port->flags & XF_OUTPUT_FLAG_SINK_LOST)
+        {
+            c->length = XF_MSG_LENGTH_INVALID;
+        }
+
+        return c;
+    }
+
+    /* ...buffer is still referenced by other sinks */
+    if (port->refcount[i - 1])
+    {
+        port->refcount[i - 1]--;
+        return NULL;
+    }
+
+    /* ...last reference is gone; port recycles its own message */
+    c = xf_msg_pool_item(&port->pool, i);
+
+    c->length = ((port->flags & XF_OUTPUT_FLAG_SINK_LOST) ? XF_MSG_LENGTH_INVALID : m->length);
+
+    return xf_output_port_reclaim(port, c);
+}
+
+/* ...check if next output message may carry a buffer lent by an input message */
+int xf_output_port_lend_ready(xf_output_port_t *port)
+{
+    xf_message_t   *c = xf_output_port_control_msg(port);
+    UWORD32             n;
+
+    /* ...port must be routed and not collecting its buffers back */
+    if (!xf_output_port_routed(port) || xf_output_port_flushing(port) || xf_output_port_unrouting(port))
+    {
+        return 0;
+    }
+
+    if (!xf_msg_queue_head(&port->queue))       return 0;
+
+    /* ...lent buffer cannot be shared by fan-out sinks or go to another core */
+    if (port->sinks || XF_MSG_SHARED(c->id))    return 0;
+
+    /* ...lenders table is allocated on first use */
+    if (!port->lent)
+    {
+        n = port->pool.n - 1;
+
+        if ((port->lent = xf_mem_alloc(n * sizeof(xf_message_t *), sizeof(xf_message_t *), XF_MSG_DST_CORE(c->id), 0)) == NULL)
+        {
+            return 0;
+        }
+
+        memset(port->lent, 0, n * sizeof(xf_message_t *));
+    }
+
+    return 1;
+}
+
 /* ...start output port unrouting sequence */
 void xf_output_port_unroute_start(xf_output_port_t *port, xf_message_t *m)
 {
@@ -483,6 +997,27 @@ void xf_output_port_unroute(xf_output_port_t *port)
     UWORD32             n = port->pool.n - 1;
     UWORD32             i;
     
+    /* ...destroy fan-out sink pools; buffers belong to the port pool */
+    if (port->sinks)
+    {
+        for (i = 0; i < port->sinks; i++)
+        {
+            xf_msg_pool_destroy(&port->sink_pool[i], core);
+        }
+
+        xf_mem_free(port->refcount, n * sizeof(UWORD32), core, 0);
+
+        port->refcount = NULL, port->sinks = 0, port->pending = 0;
+    }
+
+    port->unroute_sink = NULL;
+
+    /* ...all lent buffers are back by now */
+    if (port->lent)
+    {
+        xf_mem_free(port->lent, n * sizeof(xf_message_t *), core, 0), port->lent = NULL;
+    }
+
     /* ...free all messages (we are running on "dst" core) */
     for (i = 1; i <= n; i++)
     {
@@ -499,17 +1034,86 @@ void xf_output_port_unroute(xf_output_port_t *port)
     /* ...reset all flags */
     port->flags = XF_OUTPUT_FLAG_CREATED | XF_OUTPUT_FLAG_IDLE;
 
-    /* ...reset message queue (it is empty again) */
+    /* ...reset message queues (they are empty again) */
     xf_msg_queue_init(&port->queue);
+    xf_msg_queue_init(&port->reserve);
+
+    port->depth = 0;
 
     TRACE(ROUTE, _b("output-port[%p] unrouted"), port);
 }
 
+/* ...internal helper - put one more buffer in circulation */
+static void xf_output_port_grow(xf_output_port_t *port)
+{
+    xf_message_t   *m = xf_msg_dequeue(&port->reserve);
+
+    xf_msg_enqueue(&port->queue, m);
+
+    port->depth++;
+
+    /* ...stall is accounted for; stop adapting once everything is in circulation */
+    port->stall_age = port->depth;
+
+    if (xf_msg_queue_empty(&port->reserve))
+    {
+        port->flags &= ~XF_OUTPUT_FLAG_ADAPTIVE;
+    }
+
+    TRACE(ROUTE, _b("output-port[%p] depth grown to %u"), port, port->depth);
+}
+
+/* ...internal helper - adaptive port tracks how recently it ran out of buffers */
+static inline void xf_output_port_account(xf_output_port_t *port, UWORD32 n)
+{
+    if ((port->flags & XF_OUTPUT_FLAG_ADAPTIVE) == 0)
+    {
+        return;
+    }
+
+    if (n == 0)
+    {
+        /* ...end of stream; sink draining afterwards is no starvation */
+        port->stall_age = port->depth;
+    }
+    else if (xf_msg_queue_empty(&port->queue))
+    {
+        /* ...producer side stalls until a buffer comes back */
+        port->flags |= XF_OUTPUT_FLAG_STALLED;
+        port->stall_age = 0;
+    }
+    else if (port->stall_age < port->depth)
+    {
+        port->stall_age++;
+    }
+}
+
 /* ...put next message to the port */
 int xf_output_port_put(xf_output_port_t *port, xf_message_t *m)
 {
     /* ...in case of port unrouting sequence the flag returned will always be 0 */
-    return xf_msg_enqueue(&port->queue, m);
+    int     empty = xf_msg_enqueue(&port->queue, m);
+    UWORD32     k = 0;
+
+    if ((port->flags & XF_OUTPUT_FLAG_ADAPTIVE) == 0 || !xf_output_port_routed(port)
+        || xf_output_port_flushing(port) || xf_output_port_unrouting(port))
+    {
+        return empty;
+    }
+
+    /* ...any buffer back ends producer side of the stall */
+    port->flags &= ~XF_OUTPUT_FLAG_STALLED;
+
+    /* ...sink holding no buffer has its input run empty (consumer side stall) */
+    for (m = xf_msg_queue_head(&port->queue); m != NULL; m = m->next)     k++;
+
+    /* ...sink starving within a round after producer ran out means depth is short */
+    if (k == port->depth && port->stall_age < port->depth)
+    {
+        xf_output_port_grow(port);
+    }
+
+    return empty;
 }
 
 /* ...retrieve next message from the port */
@@ -541,16 +1145,88 @@ int xf_output_port_produce(xf_output_port_t *port, UWORD32 n)
     /* ...it is not permitted to invoke this when port is being unrouted (or flushed - tbd) */
     BUG(xf_output_port_unrouting(port), _x("invalid transaction"));
 
+    /* ...pass same buffer to every fan-out sink; last one to return recycles it */
+    if (port->sinks)
+    {
+        UWORD32     i = (UWORD32)((__xf_message_t *)m - port->pool.p);
+        UWORD32     k, refs = 0;
+
+        /* ...first sink gets the buffer read-only just like the others */
+        m->id |= (__XF_PORT_READONLY << 16);
+
+        for (k = 1; k <= port->sinks; k++)
+        {
+            if (xf_output_port_sink_active(port, k))
+            {
+                xf_response_data(xf_msg_pool_item(&port->sink_pool[k - 1], i), n), refs++;
+            }
+        }
+
+        /* ...unrouted first sink leaves port message with the fan-out sinks */
+        if (!xf_output_port_sink_active(port, 0))
+        {
+            port->refcount[i - 1] = refs - 1;
+            m = NULL;
+        }
+        else
+        {
+            port->refcount[i - 1] = refs;
+        }
+    }
+
     /* ...complete message with specified amount of bytes produced */
-    xf_response_data(m, n);
+    if (m)
+    {
+        xf_response_data(m, n);
+    }
 
     /* ...clear port idle flag (technically, not needed for unrouted port) */
     port->flags &= ~XF_OUTPUT_FLAG_IDLE;
+
+    xf_output_port_account(port, n);
     
     /* ...return indication of pending message availability */
     return (xf_msg_queue_head(&port->queue) != NULL);
 }
 
+/* ...produce output in the buffer lent by input message "m"; the message is
+ * held until the sink returns its buffer, i.e. the upstream port gets it back
+ * only after the downstream latency instead of right after processing. Each
+ * lender takes a free output message, so no more upstream buffers are held
+ * than this port has; a slow sink stalls the source once those run out */
+int xf_output_port_produce_lent(xf_output_port_t *port, UWORD32 n, xf_message_t *m)
+{
+    xf_message_t   *o = xf_msg_dequeue(&port->queue);
+    void           *b;
+    UWORD32             i;
+
+    /* ...message cannot be NULL */
+    BUG(o == NULL, _x("Invalid transaction"));
+
+    /* ...port must have been checked with xf_output_port_lend_ready */
+    BUG(!port->lent || port->sinks || xf_output_port_unrouting(port), _x("invalid transaction"));
+
+    i = (UWORD32)((__xf_message_t *)o - port->pool.p);
+
+    BUG(port->lent[i - 1] != NULL, _x("buffer #%u lent twice"), i);
+
+    /* ...input message keeps own buffer of output message until it is returned */
+    port->lent[i - 1] = m;
+
+    b = o->buffer, o->buffer = m->buffer, m->buffer = b;
+
+    /* ...complete message with specified amount of bytes produced */
+    xf_response_data(o, n);
+
+    /* ...clear port idle flag */
+    port->flags &= ~XF_OUTPUT_FLAG_IDLE;
+
+    xf_output_port_account(port, n);
+
+    /* ...return indication of pending message availability */
+    return (xf_msg_queue_head(&port->queue) != NULL);
+}
+
 /* ...flush output port */
 int xf_output_port_flush(xf_output_port_t *port, UWORD32 opcode)
 {
@@ -576,11 +1252,39 @@ int xf_output_port_flush(xf_output_port_t *port, UWORD32 opcode)
             /* ...get control message from associated pool */
             m = xf_output_port_control_msg(port);
 
-            /* ...set flow-control operation */
-            m->opcode = opcode;
-        
+            /* ...fan-out sinks are flushed along; port waits for all of them */
+            if (port->sinks)
+            {
+                xf_message_t   *c;
+                UWORD32             k;
+
+                port->pending = 0;
+
+                for (k = 1; k <= port->sinks; k++)
+                {
+                    if (xf_output_port_sink_active(port, k))
+                    {
+                        c = xf_msg_pool_item(&port->sink_pool[k - 1], 0);
+                        c->opcode = opcode;
+                        xf_response(c);
+                        port->pending++;
+                    }
+                }
+            }
+
             /* ...message is a command, but source and destination are swapped */
-            xf_response(m);
+            if (xf_output_port_sink_active(port, 0))
+            {
+                /* ...set flow-control operation */
+                m->opcode = opcode;
+
+                xf_response(m);
+            }
+            else
+            {
+                /* ...first sink is gone or going; nothing to wait for there */
+                port->flags |= XF_OUTPUT_FLAG_PARKED;
+            }
         }
         
         /* ...zero-result indicates the flushing is in progress */
@@ -609,6 +1313,10 @@ void xf_output_port_flush_done(xf_output_port_t *port)
     /* ...clear flushing flag and set idle flag */
     port->flags ^= XF_OUTPUT_FLAG_IDLE | XF_OUTPUT_FLAG_FLUSHING;
 
+    /* ...stall seen before the flush says nothing about restarted stream */
+    port->flags &= ~XF_OUTPUT_FLAG_STALLED;
+    port->stall_age = port->depth;
+
     TRACE(OUTPUT, _b("port[%p] flush sequence completed"), port);
 }
 
@@ -0,0 +1,348 @@
+/*
+* Copyright (c) 2015-2021 Cadence Design Systems Inc.
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/*******************************************************************************
+ * xf-pcm.c
+ *
+ * PCM sample format conversion, interleaving and saturation kernels
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "xf-pcm.h"
+
+/*******************************************************************************
+ * Macros definitions
+ ******************************************************************************/
+
+/* ...source/destination container sizes (bytes) of a conversion */
+#define XF_PCM_SIZES(src, dst)          (((src) << 4) | (dst))
+
+/*******************************************************************************
+ * Conversion kernels
+ ******************************************************************************/
+
+/* ...widening; in place it runs backwards so that no sample is overwritten
+ * before it is read; scaling is a multiply, as left-shifting a negative
+ * sample is undefined */
+#define XF_PCM_WIDEN(name, dst_t, src_t, shift)                         \
+static void name(dst_t *d, const src_t *s, UWORD32 n)                   \
+{                                                                       \
+    UWORD32     i;                                                      \
+                                                                        \
+    if ((const void *)d != (const void *)s)                             \
+    {                                                                   \
+        XF_PCM_LOOP_CONCURRENT                                          \
+        for (i = 0; i < n; i++)                                         \
+            d[i] = (dst_t)(s[i] * ((WORD32)1 << (shift)));              \
+    }                                                                   \
+    else                                                                \
+    {                                                                   \
+        for (i = n; i > 0; i--)                                         \
+            d[i - 1] = (dst_t)(s[i - 1] * ((WORD32)1 << (shift)));      \
+    }                                                                   \
+}
+
+/* ...narrowing; a forward pass reads each sample before the narrower writes
+ * reach it, so one loop serves in place as well */
+#define XF_PCM_NARROW(name, dst_t, src_t, shift)                        \
+static void name(dst_t *d, const src_t *s, UWORD32 n)                   \
+{                                                                       \
+    UWORD32     i;                                                      \
+                                                                        \
+    for (i = 0; i < n; i++)                                             \
+        d[i] = (dst_t)(s[i] >> (shift));                                \
+}
+
+XF_PCM_WIDEN(xf_pcm_widen_8_16, WORD16, WORD8, 8)
+XF_PCM_WIDEN(xf_pcm_widen_8_32, WORD32, WORD8, 24)
+XF_PCM_WIDEN(xf_pcm_widen_16_32, WORD32, WORD16, 16)
+XF_PCM_NARROW(xf_pcm_narrow_16_8, WORD8, WORD16, 8)
+XF_PCM_NARROW(xf_pcm_narrow_32_8, WORD8, WORD32, 24)
+XF_PCM_NARROW(xf_pcm_narrow_32_16, WORD16, WORD32, 16)
+
+/* ...32-bit to 24-bit: clear bits below the sample */
+static void xf_pcm_narrow_32_24(WORD32 *d, const WORD32 *s, UWORD32 n)
+{
+    UWORD32     i;
+
+    XF_PCM_LOOP_CONCURRENT
+    for (i = 0; i < n; i++)
+        d[i] = s[i] & XF_PCM_MASK_S24;
+}
+
+/* ...convert samples between widths */
+WORD32 xf_pcm_convert(void *dst, UWORD32 dst_width, const void *src, UWORD32 src_width, UWORD32 n)
+{
+    UWORD32     size = xf_pcm_sample_size(src_width);
+
+    if (!xf_pcm_width_valid(dst_width) || !xf_pcm_width_valid(src_width))
+    {
+        return -1;
+    }
+
+    switch (XF_PCM_SIZES(size, xf_pcm_sample_size(dst_width)))
+    {
+    case XF_PCM_SIZES(1, 2):
+        xf_pcm_widen_8_16(dst, src, n);
+        break;
+    case XF_PCM_SIZES(1, 4):
+        xf_pcm_widen_8_32(dst, src, n);
+        break;
+    case XF_PCM_SIZES(2, 4):
+        xf_pcm_widen_16_32(dst, src, n);
+        break;
+    case XF_PCM_SIZES(2, 1):
+        xf_pcm_narrow_16_8(dst, src, n);
+        break;
+    case XF_PCM_SIZES(4, 1):
+        xf_pcm_narrow_32_8(dst, src, n);
+        break;
+    case XF_PCM_SIZES(4, 2):
+        xf_pcm_narrow_32_16(dst, src, n);
+        break;
+    default:
+        /* ...same container; only 32-bit to 24-bit changes the samples */
+        if (dst_width == 24 && src_width == 32)
+        {
+            xf_pcm_narrow_32_24(dst, src, n);
+        }
+        else if (dst != src)
+        {
+            memcpy(dst, src, n * size);
+        }
+        break;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Interleaving kernels
+ ******************************************************************************/
+
+/* ...stereo is the common case and gets a loop of its own */
+#define XF_PCM_INTERLEAVE(name, type)                                   \
+static void name(type *d, const void * const *src, UWORD32 channels, UWORD32 frames) \
+{                                                                       \
+    UWORD32     c, i;                                                   \
+                                                                        \
+    if (channels == 2)                                                  \
+    {                                                                   \
+        const type     *l = src[0], *r = src[1];                        \
+                                                                        \
+        XF_PCM_LOOP_CONCURRENT                                          \
+        for (i = 0; i < frames; i++)                                    \
+            d[2 * i] = l[i], d[2 * i + 1] = r[i];                       \
+                                                                        \
+        return;                                                         \
+    }                                                                   \
+                                                                        \
+    for (c = 0; c < channels; c++)                                      \
+    {                                                                   \
+        const type     *s = src[c];                                     \
+                                                                        \
+        XF_PCM_LOOP_CONCURRENT                                          \
+        for (i = 0; i < frames; i++)                                    \
+            d[i * channels + c] = s[i];                                 \
+    }                                                                   \
+}
+
+#define XF_PCM_DEINTERLEAVE(name, type)                                 \
+static void name(void * const *dst, const type *s, UWORD32 channels, UWORD32 frames) \
+{                                                                       \
+    UWORD32     c, i;                                                   \
+                                                                        \
+    if (channels == 2)                                                  \
+    {                                                                   \
+        type           *l = dst[0], *r = dst[1];                        \
+                                                                        \
+        XF_PCM_LOOP_CONCURRENT                                          \
+        for (i = 0; i < frames; i++)                                    \
+            l[i] = s[2 * i], r[i] = s[2 * i + 1];                       \
+                                                                        \
+        return;                                                         \
+    }                                                                   \
+                                                                        \
+    for (c = 0; c < channels; c++)                                      \
+    {                                                                   \
+        type           *d = dst[c];                                     \
+                                                                        \
+        XF_PCM_LOOP_CONCURRENT                                          \
+        for (i = 0; i < frames; i++)                                    \
+            d[i] = s[i * channels + c];                                 \
+    }                                                                   \
+}
+
+XF_PCM_INTERLEAVE(xf_pcm_interleave_8, WORD8)
+XF_PCM_INTERLEAVE(xf_pcm_interleave_16, WORD16)
+XF_PCM_INTERLEAVE(xf_pcm_interleave_32, WORD32)
+XF_PCM_DEINTERLEAVE(xf_pcm_deinterleave_8, WORD8)
+XF_PCM_DEINTERLEAVE(xf_pcm_deinterleave_16, WORD16)
+XF_PCM_DEINTERLEAVE(xf_pcm_deinterleave_32, WORD32)
+
+/* ...planar to interleaved */
+WORD32 xf_pcm_interleave(void *dst, const void * const src[], UWORD32 width, UWORD32 channels, UWORD32 frames)
+{
+    if (!xf_pcm_width_valid(width))
+    {
+        return -1;
+    }
+
+    switch (xf_pcm_sample_size(width))
+    {
+    case 1:
+        xf_pcm_interleave_8(dst, src, channels, frames);
+        break;
+    case 2:
+        xf_pcm_interleave_16(dst, src, channels, frames);
+        break;
+    default:
+        xf_pcm_interleave_32(dst, src, channels, frames);
+        break;
+    }
+
+    return 0;
+}
+
+/* ...interleaved to planar */
+WORD32 xf_pcm_deinterleave(void * const dst[], const void *src, UWORD32 width, UWORD32 channels, UWORD32 frames)
+{
+    if (!xf_pcm_width_valid(width))
+    {
+        return -1;
+    }
+
+    switch (xf_pcm_sample_size(width))
+    {
+    case 1:
+        xf_pcm_deinterleave_8(dst, src, channels, frames);
+        break;
+    case 2:
+        xf_pcm_deinterleave_16(dst, src, channels, frames);
+        break;
+    default:
+        xf_pcm_deinterleave_32(dst, src, channels, frames);
+        break;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Level kernels
+ ******************************************************************************/
+
+/* ...attenuate in place; a shift past the sample width gives silence or -1 LSB */
+WORD32 xf_pcm_attenuate(void *buf, UWORD32 width, UWORD32 n, UWORD32 shift)
+{
+    UWORD32     i;
+
+    if (!xf_pcm_width_valid(width))
+    {
+        return -1;
+    }
+
+    (shift > 31 ? shift = 31 : 0);
+
+    switch (width)
+    {
+    case 8:
+        {
+            WORD8      *p = buf;
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                p[i] = (WORD8)(p[i] >> shift);
+        }
+        break;
+    case 16:
+        {
+            WORD16     *p = buf;
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                p[i] = (WORD16)(p[i] >> shift);
+        }
+        break;
+    default:
+        {
+            WORD32     *p = buf;
+            WORD32      mask = (width == 24 ? XF_PCM_MASK_S24 : (WORD32)0xFFFFFFFF);
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                p[i] = (p[i] >> shift) & mask;
+        }
+        break;
+    }
+
+    return 0;
+}
+
+/* ...multiply by Q12 gain, truncate and saturate */
+WORD32 xf_pcm_scale(void *dst, const void *src, UWORD32 width, UWORD32 n, UWORD16 gain)
+{
+    UWORD32     i;
+
+    if (!xf_pcm_width_valid(width))
+    {
+        return -1;
+    }
+
+    switch (width)
+    {
+    case 8:
+        {
+            WORD8          *d = dst;
+            const WORD8    *s = src;
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                d[i] = xf_pcm_sat8((s[i] * (WORD32)gain) >> 12);
+        }
+        break;
+    case 16:
+        {
+            WORD16         *d = dst;
+            const WORD16   *s = src;
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                d[i] = xf_pcm_sat16((s[i] * (WORD32)gain) >> 12);
+        }
+        break;
+    default:
+        {
+            WORD32         *d = dst;
+            const WORD32   *s = src;
+            WORD32          mask = (width == 24 ? XF_PCM_MASK_S24 : (WORD32)0xFFFFFFFF);
+
+            XF_PCM_LOOP_CONCURRENT
+            for (i = 0; i < n; i++)
+                d[i] = xf_pcm_sat32(((WORD64)s[i] * gain) >> 12) & mask;
+        }
+        break;
+    }
+
+    return 0;
+}
@@ -57,6 +57,12 @@ typedef struct xf_proxy_ipc_data
         /* ...pipe for asynchronous response delivery */
         int                     pipe[2];
 
+        /* ...number of messages passed to DSP, for profiling */
+        unsigned long long      msg_sent;
+
+        /* ...emulated DSP state, see xf-fsl-loopback.c */
+        void                   *loopback;
+
 }   xf_proxy_ipc_data_t;
 
 /*******************************************************************************
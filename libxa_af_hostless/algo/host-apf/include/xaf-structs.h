@@ -26,6 +26,7 @@
 #include <string.h>
 #endif
 #include "xaf-api.h"
+#include "audio/xa-mixer-api.h"
 
 /* ...size of auxiliary pool for communication with HiFi */
 #define XAF_AUX_POOL_SIZE                   32
@@ -34,7 +35,8 @@
 #define XAF_AUX_POOL_MSG_LENGTH             256
 #define XAF_MAX_CONFIG_PARAMS               (XAF_AUX_POOL_MSG_LENGTH >> 3)
 
-#define MAX_IO_PORTS                        (XF_CFG_MAX_IN_PORTS + XF_CFG_MAX_OUT_PORTS)
+/* ...mixer may have more input ports than any other component */
+#define MAX_IO_PORTS                        ((XA_MIXER_MAX_TRACK_NUMBER > XF_CFG_MAX_IN_PORTS ? XA_MIXER_MAX_TRACK_NUMBER : XF_CFG_MAX_IN_PORTS) + XF_CFG_MAX_OUT_PORTS)
 #define PORT_NOT_CONNECTED                  (0xFFFFFFFF)
 
 #ifndef EBADFD
@@ -63,6 +65,9 @@ typedef struct xaf_comp_format_s {
 typedef struct xaf_connect_map_s {
     void               *ptr;
     UWORD32             port;
+
+    /* ...sinks sharing an output port besides the one in ptr/port */
+    UWORD32             fanout;
 } xaf_connect_map_t;
 
 #ifndef XA_DISABLE_EVENT
@@ -104,7 +109,7 @@ struct xaf_comp {
 
     xf_pool_t       *inpool;
     xf_pool_t       *outpool;
-    void                *pout_buf[1];
+    void                *pout_buf[XAF_MAX_OUTBUFS];
     void                *p_input[XAF_MAX_INBUFS];   //TENA-2196
     UWORD32                ninbuf;
     UWORD32             noutbuf;
@@ -42,12 +42,12 @@
 #define XF_MSG_AP_TO_USER(id)           \
     ((id) & ~(0xF << 18))
 
-/* ...port specification (12 bits) */
+/* ...port specification (14 bits; port id takes bits 8..13 of DSP ports) */
 #define __XF_PORT_SPEC(core, id, port)  ((core) | ((id) << 2) | ((port) << 8))
 #define __XF_PORT_SPEC2(id, port)       ((id) | ((port) << 8))
 #define XF_PORT_CORE(spec)              ((spec) & 0x3)
 #define XF_PORT_CLIENT(spec)            (((spec) >> 2) & 0x3F)
-#define XF_PORT_ID(spec)                (((spec) >> 8) & 0xF)
+#define XF_PORT_ID(spec)                (((spec) >> 8) & 0x3F)
 
 /* ...message id contains source and destination ports specification */
 #define __XF_MSG_ID(src, dst)           (((src) & 0xFFFF) | (((dst) & 0xFFFF) << 16))
@@ -55,13 +55,13 @@
 #define XF_MSG_SRC_CORE(id)             (((id) >> 0) & 0x3)
 #define XF_MSG_SRC_CLIENT(id)           (((id) >> 2) & 0x3F)
 #define XF_MSG_SRC_ID(id)               (((id) >> 0) & 0xFF)
-#define XF_MSG_SRC_PORT(id)             (((id) >> 8) & 0xF)
+#define XF_MSG_SRC_PORT(id)             (((id) >> 8) & 0x3F)
 #define XF_MSG_SRC_PROXY(id)            (((id) >> 15) & 0x1)
 #define XF_MSG_DST(id)                  (((id) >> 16) & 0xFFFF)
 #define XF_MSG_DST_CORE(id)             (((id) >> 16) & 0x3)
 #define XF_MSG_DST_CLIENT(id)           (((id) >> 18) & 0x3F)
 #define XF_MSG_DST_ID(id)               (((id) >> 16) & 0xFF)
-#define XF_MSG_DST_PORT(id)             (((id) >> 24) & 0xF)
+#define XF_MSG_DST_PORT(id)             (((id) >> 24) & 0x3F)
 #define XF_MSG_DST_PROXY(id)            (((id) >> 31) & 0x1)
 
 /* ...special treatment of AP-proxy destination field */
@@ -308,6 +308,9 @@ typedef struct xf_route_port_msg
 
 }	__attribute__((__packed__)) xf_route_port_msg_t;
 
+/* ...buffer number is a limit; route starts shallow and grows on stalls */
+#define XF_ROUTE_ADAPTIVE               (1U << 31)
+
 /*******************************************************************************
  * XF_UNROUTE definition
  ******************************************************************************/
@@ -68,6 +68,7 @@ extern void     xf_close(xf_handle_t *handle);
 extern int      xf_command(xf_handle_t *handle, UWORD32 dst, UWORD32 opcode, void *buf, UWORD32 length);
 extern int      xf_route(xf_handle_t *src, UWORD32 s_port, xf_handle_t *dst, UWORD32 d_port, UWORD32 num, UWORD32 size, UWORD32 align);
 extern int      xf_unroute(xf_handle_t *src, UWORD32 s_port);
+extern int      xf_unroute_sink(xf_handle_t *src, UWORD32 s_port, xf_handle_t *dst, UWORD32 d_port);
 extern int      xf_pause(xf_handle_t *comp, WORD32 port);
 extern int      xf_resume(xf_handle_t *comp, WORD32 port);
 extern int      xf_set_config(xf_handle_t *comp, void *buffer, UWORD32 length);
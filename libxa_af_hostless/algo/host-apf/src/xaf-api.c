@@ -1104,6 +1104,7 @@ XAF_ERR_CODE xaf_comp_create(pVOID adev_ptr, pVOID *pp_comp, xaf_comp_config_t *
     {
         p_comp->cmap[i].ptr  = NULL;
         p_comp->cmap[i].port = PORT_NOT_CONNECTED;
+        p_comp->cmap[i].fanout = 0;
     }
 
     switch (comp_type)
@@ -1115,7 +1116,7 @@ XAF_ERR_CODE xaf_comp_create(pVOID adev_ptr, pVOID *pp_comp, xaf_comp_config_t *
         p_comp->inp_ports = 1; p_comp->out_ports = 1;
         break;
     case XAF_MIXER:
-        p_comp->inp_ports = 4; p_comp->out_ports = 1;
+        p_comp->inp_ports = XA_MIXER_MAX_TRACK_NUMBER; p_comp->out_ports = 1;
         break;
     case XAF_MIMO_PROC_12 ... (XAF_MAX_COMPTYPE-1):
         p_comp->inp_ports  = xf_io_ports[comp_type][0];
@@ -1228,6 +1229,7 @@ XAF_ERR_CODE xaf_comp_create_deprecated(pVOID adev_ptr, pVOID *pp_comp, xf_id_t
     {
         p_comp->cmap[i].ptr  = NULL;
         p_comp->cmap[i].port = PORT_NOT_CONNECTED;
+        p_comp->cmap[i].fanout = 0;
     }
 
     switch (comp_type)
@@ -1239,7 +1241,7 @@ XAF_ERR_CODE xaf_comp_create_deprecated(pVOID adev_ptr, pVOID *pp_comp, xf_id_t
         p_comp->inp_ports = 1; p_comp->out_ports = 1;
         break;
     case XAF_MIXER:
-        p_comp->inp_ports = 4; p_comp->out_ports = 1;
+        p_comp->inp_ports = XA_MIXER_MAX_TRACK_NUMBER; p_comp->out_ports = 1;
         break;
     case XAF_MIMO_PROC_12 ... (XAF_MAX_COMPTYPE-1):
         p_comp->inp_ports  = xf_io_ports[comp_type][0];
@@ -1730,17 +1732,18 @@ XAF_ERR_CODE xaf_comp_process(pVOID adev_ptr, pVOID comp_ptr, pVOID p_buf, UWORD
     return XAF_NO_ERR;
 }
 
-XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 num_buf)
+/* ...route ports; "num_buf" may carry adaptive route flag */
+static XAF_ERR_CODE xaf_connect_route(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, UWORD32 num_buf)
 {
     xaf_comp_t *src_comp;
     xaf_comp_t *dest_comp;
+    UWORD32     fanout;
 
     src_comp  = (xaf_comp_t *) p_src;
     dest_comp = (xaf_comp_t *) p_dest;
     
     XAF_CHK_PTR(src_comp);
     XAF_CHK_PTR(dest_comp);
-    XAF_CHK_RANGE(num_buf, 1, 1024);    
 
     XAF_COMP_STATE_CHK(src_comp);
     XAF_COMP_STATE_CHK(dest_comp);
@@ -1756,9 +1759,8 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     if (dest_in_port < 0 || dest_in_port >= (WORD32)dest_comp->inp_ports)
         return XAF_ROUTING_ERR;
 
-    /* ...src component connection validity check */
-    if (src_comp->cmap[src_out_port].ptr != NULL || src_comp->cmap[src_out_port].port != PORT_NOT_CONNECTED)
-        return XAF_ROUTING_ERR;
+    /* ...connected src port fans out; its buffers are shared with the new sink (num_buf is ignored) */
+    fanout = (src_comp->cmap[src_out_port].ptr != NULL || src_comp->cmap[src_out_port].port != PORT_NOT_CONNECTED);
 
     /* ...dest component connection validity check */
     if (dest_comp->cmap[dest_in_port].ptr != NULL || dest_comp->cmap[dest_in_port].port != PORT_NOT_CONNECTED)
@@ -1768,8 +1770,15 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     XF_CHK_API(xf_route(&src_comp->handle, src_out_port, &dest_comp->handle, dest_in_port, num_buf, src_comp->out_format.output_length[src_out_port - src_comp->inp_ports], 8));
     
     /* ...update src component map */
-    src_comp->cmap[src_out_port].ptr  = dest_comp;
-    src_comp->cmap[src_out_port].port = dest_in_port;
+    if (fanout)
+    {
+        src_comp->cmap[src_out_port].fanout++;
+    }
+    else
+    {
+        src_comp->cmap[src_out_port].ptr  = dest_comp;
+        src_comp->cmap[src_out_port].port = dest_in_port;
+    }
 
     /* ...update dest component map */
     dest_comp->cmap[dest_in_port].ptr  = src_comp;
@@ -1778,6 +1787,21 @@ XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32
     return XAF_NO_ERR;
 }
 
+XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 num_buf)
+{
+    XAF_CHK_RANGE(num_buf, 1, 1024);    
+
+    return xaf_connect_route(p_src, src_out_port, p_dest, dest_in_port, num_buf);
+}
+
+/* ...route starts with few buffers and grows up to "max_buf" on stalls; see XAF_PORT_DEPTH */
+XAF_ERR_CODE xaf_connect_adaptive(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 max_buf)
+{
+    XAF_CHK_RANGE(max_buf, 1, 1024);    
+
+    return xaf_connect_route(p_src, src_out_port, p_dest, dest_in_port, (UWORD32)max_buf | XF_ROUTE_ADAPTIVE);
+}
+
 XAF_ERR_CODE xaf_disconnect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port)
 {
     xaf_comp_t *src_comp; 
@@ -1802,19 +1826,51 @@ XAF_ERR_CODE xaf_disconnect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD
     if (dest_in_port < 0 || dest_in_port >= (WORD32)dest_comp->inp_ports)
         return XAF_ROUTING_ERR;
 
-    /* ...src component connection validity check */
-    if (src_comp->cmap[src_out_port].ptr != dest_comp || (WORD32)src_comp->cmap[src_out_port].port != dest_in_port)
-        return XAF_ROUTING_ERR;
-
     /* ...dest component connection validity check */
     if (dest_comp->cmap[dest_in_port].ptr != src_comp || (WORD32)dest_comp->cmap[dest_in_port].port != src_out_port)
         return XAF_ROUTING_ERR;
 
-    XF_CHK_API(xf_unroute(&src_comp->handle, src_out_port));
+    /* ...src component connection validity check; any sink of fanned-out port may go */
+    if (!src_comp->cmap[src_out_port].fanout && (src_comp->cmap[src_out_port].ptr != dest_comp || (WORD32)src_comp->cmap[src_out_port].port != dest_in_port))
+        return XAF_ROUTING_ERR;
 
-    /* ...update src component map */
-    src_comp->cmap[src_out_port].ptr  = NULL;
-    src_comp->cmap[src_out_port].port = PORT_NOT_CONNECTED;
+    if (src_comp->cmap[src_out_port].fanout)
+    {
+        /* ...unroute this sink only; the others keep running */
+        XF_CHK_API(xf_unroute_sink(&src_comp->handle, src_out_port, &dest_comp->handle, dest_in_port));
+
+        src_comp->cmap[src_out_port].fanout--;
+
+        /* ...src component map names one of the remaining sinks */
+        if (src_comp->cmap[src_out_port].ptr == dest_comp && (WORD32)src_comp->cmap[src_out_port].port == dest_in_port)
+        {
+            xaf_adev_t *p_adev = (xaf_adev_t *) src_comp->p_adev;
+            xaf_comp_t *p_comp;
+            UWORD32     i;
+
+            __xf_lock(&p_adev->comp_chain.lock);
+            for (p_comp = (xaf_comp_t *) p_adev->comp_chain.head; p_comp != NULL; p_comp = p_comp->next)
+            {
+                for (i = 0; i < p_comp->inp_ports; i++)
+                {
+                    if (p_comp->cmap[i].ptr == src_comp && p_comp->cmap[i].port == (UWORD32)src_out_port && !(p_comp == dest_comp && i == (UWORD32)dest_in_port))
+                    {
+                        src_comp->cmap[src_out_port].ptr  = p_comp;
+                        src_comp->cmap[src_out_port].port = i;
+                    }
+                }
+            }
+            __xf_unlock(&p_adev->comp_chain.lock);
+        }
+    }
+    else
+    {
+        XF_CHK_API(xf_unroute(&src_comp->handle, src_out_port));
+
+        /* ...update src component map */
+        src_comp->cmap[src_out_port].ptr  = NULL;
+        src_comp->cmap[src_out_port].port = PORT_NOT_CONNECTED;
+    }
 
     /* ...update dest component map */
     dest_comp->cmap[dest_in_port].ptr  = NULL;
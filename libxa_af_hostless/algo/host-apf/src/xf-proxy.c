@@ -519,8 +519,8 @@ int xf_route(xf_handle_t *src, UWORD32 src_port, xf_handle_t *dst, UWORD32 dst_p
     return 0;
 }
 
-/* ...port unbinding function */
-int xf_unroute(xf_handle_t *src, UWORD32 src_port)
+/* ...port unbinding helper; "dst" names one sink of fanned-out port, 0 means all sinks */
+static int __xf_unroute(xf_handle_t *src, UWORD32 src_port, UWORD32 dst)
 {
     xf_proxy_t             *proxy = src->proxy;
     xf_buffer_t            *b;
@@ -536,6 +536,7 @@ int xf_unroute(xf_handle_t *src, UWORD32 src_port)
     
     /* ...fill-in message parameters */
     //m->src = __XF_PORT_SPEC2(src->id, src_port);
+    m->dst = dst;
 
     /* ...set command parameters */
     msg.id = __XF_MSG_ID(__XF_AP_PROXY(proxy->core), __XF_PORT_SPEC2(src->id, src_port));
@@ -561,6 +562,21 @@ int xf_unroute(xf_handle_t *src, UWORD32 src_port)
     return 0;
 }
 
+/* ...port unbinding function */
+int xf_unroute(xf_handle_t *src, UWORD32 src_port)
+{
+    return __xf_unroute(src, src_port, 0);
+}
+
+/* ...unbind one sink of a fanned-out port */
+int xf_unroute_sink(xf_handle_t *src, UWORD32 src_port, xf_handle_t *dst, UWORD32 dst_port)
+{
+    /* ...sanity checks - proxy pointers are same */
+    XF_CHK_ERR(src->proxy == dst->proxy, XAF_INVALIDVAL_ERR);
+
+    return __xf_unroute(src, src_port, __XF_PORT_SPEC2(dst->id, dst_port));
+}
+
 #ifndef XA_DISABLE_EVENT
 int xf_create_event_channel(xf_handle_t *src, UWORD32 src_config_param, xf_handle_t *dst, UWORD32 dst_config_param, UWORD32 num, UWORD32 size, UWORD32 align)
 {
@@ -49,6 +49,23 @@ enum xa_codec_ports {
     XA_CODEC_OUTPUT_PORT = 1
 };
 
+/* ...maximal number of input segments passed at once */
+#define XA_CODEC_INPUT_SEGMENTS_MAX         8
+
+/* ...scattered input data (XA_API_CMD_SET_INPUT_SEGMENTS)
+ *
+ * A codec accepting this command with a NULL pointer at memtab time gets its
+ * input as up to XA_CODEC_INPUT_SEGMENTS_MAX (pointer, length) pairs instead
+ * of a copy in a contiguous buffer. The segments are consecutive pieces of
+ * the stream; XA_API_CMD_SET_INPUT_BYTES still gives their total length and
+ * XA_API_CMD_GET_CURIDX_INPUT_BUF counts consumed bytes across segments.
+ */
+typedef struct xa_codec_input_segments {
+    UWORD32     num;
+    pVOID       ptr[XA_CODEC_INPUT_SEGMENTS_MAX];
+    UWORD32     length[XA_CODEC_INPUT_SEGMENTS_MAX];
+} xa_codec_input_segments_t;
+
 /* ...non-fatal execution errors */
 enum
 {
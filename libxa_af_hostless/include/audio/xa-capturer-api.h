@@ -48,7 +48,12 @@ enum xa_config_param_capturer {
     XA_CAPTURER_CONFIG_PARAM_BYTES_PRODUCED  = 6,
     XA_CAPTURER_CONFIG_PARAM_SAMPLE_END      = 7,
     XA_CAPTURER_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES = 8,    /* frame size per channel in samples */
-    XA_CAPTURER_CONFIG_PARAM_NUM            = 9
+    XA_CAPTURER_CONFIG_PARAM_ZERO_COPY      = 9,    /* DMA straight into output buffers (0/1) */
+    XA_CAPTURER_CONFIG_PARAM_DMA_BUFFER     = 10,   /* pointer to an empty output buffer for the DMA, set only */
+    XA_CAPTURER_CONFIG_PARAM_PERIOD_COUNT   = 11,   /* number of frame sized periods in the DMA ring */
+    XA_CAPTURER_CONFIG_PARAM_OVERRUN_POLICY = 12,   /* see enum xa_capturer_overrun_policy */
+    XA_CAPTURER_CONFIG_PARAM_OVERRUN_COUNT  = 13,   /* number of overruns since init, read only */
+    XA_CAPTURER_CONFIG_PARAM_NUM            = 14
 };
 
 /* ...XA_CAPTURER_CONFIG_PARAM_CB: compound parameters data structure */
@@ -59,6 +64,12 @@ typedef struct xa_capturer_cb_s {
 }   xa_capturer_cb_t;
 
 
+/* ...XA_CAPTURER_CONFIG_PARAM_OVERRUN_POLICY: what to keep when the ring fills up */
+enum xa_capturer_overrun_policy {
+    XA_CAPTURER_OVERRUN_RESTART = 0,    /* drop all queued periods, resume with the next one */
+    XA_CAPTURER_OVERRUN_NEWEST  = 1     /* drop the oldest period, keep delivering the newest */
+};
+
 /* ...capturer states  */
 enum xa_capturer_state {
     XA_CAPTURER_STATE_START = 0,
@@ -127,7 +138,8 @@ enum xa_error_nonfatal_execute_capturer {
     XA_CAPTURER_EXEC_NONFATAL_STATE     = XA_CAPTURER_EXEC_NONFATAL(0),
     XA_CAPTURER_EXEC_NONFATAL_INPUT     = XA_CAPTURER_EXEC_NONFATAL(1),
     XA_CAPTURER_EXEC_NONFATAL_MAX       = XA_CAPTURER_EXEC_NONFATAL(2),
-    XA_CAPTURER_EXEC_NONFATAL_NO_DATA   = XA_CAPTURER_EXEC_NONFATAL(3)
+    XA_CAPTURER_EXEC_NONFATAL_NO_DATA   = XA_CAPTURER_EXEC_NONFATAL(3),
+    XA_CAPTURER_EXEC_NONFATAL_OVERRUN   = XA_CAPTURER_EXEC_NONFATAL(4)
 };
 
 enum xa_error_fatal_execute_capturer {
@@ -58,14 +58,22 @@ enum xa_config_param_mixer {
     XA_MIXER_CONFIG_PARAM_BUFFER_SIZE       = 6,
     XA_MIXER_CONFIG_PARAM_VOLUME            = 7,
     XA_MIXER_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES = 8,    /* frame size per channel in samples */
-    XA_MIXER_CONFIG_PARAM_NUM               = 9
+    XA_MIXER_CONFIG_PARAM_TRACK_SAMPLE_RATE = 9,    /* handled by mixer class; value is XA_MIXER_TRACK_SAMPLE_RATE() */
+    XA_MIXER_CONFIG_PARAM_NUM               = 10
 };
 
 /* ...component identifier (informative) */
 #define XA_CODEC_MIXER                  2
 
-/* ...global limitation - maximal mixer track number */
-#define XA_MIXER_MAX_TRACK_NUMBER       4
+/* ...global limitation - maximal mixer track number (same value for host and DSP builds) */
+#ifndef XA_MIXER_MAX_TRACK_NUMBER
+#define XA_MIXER_MAX_TRACK_NUMBER       16
+#endif
+
+/* ...track index is a 4-bit field of volume command */
+#if XA_MIXER_MAX_TRACK_NUMBER > 16
+#error "XA_MIXER_MAX_TRACK_NUMBER must not exceed 16"
+#endif
 
 /* ...volume representation */
 #define __XA_MIXER_VOLUME(v)            \
@@ -75,6 +83,11 @@ enum xa_config_param_mixer {
 #define XA_MIXER_VOLUME(track, channel, volume) \
     (__XA_MIXER_VOLUME(volume) | ((track) << 16) | ((channel) << 20))
 
+/* ...track sample rate setting command encoding (zero rate - track runs at mixer
+ * rate); a track rate above the mixer rate is rejected, conversion is upsampling only */
+#define XA_MIXER_TRACK_SAMPLE_RATE(track, rate) \
+    (((rate) & 0xFFFFFF) | ((track) << 24))
+
 /*******************************************************************************
  * Class 0: API Errors
  ******************************************************************************/
@@ -48,7 +48,16 @@ enum xa_config_param_renderer {
 	XA_RENDERER_CONFIG_PARAM_BYTES_PRODUCED = 6,
     XA_RENDERER_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES = 7,    /* frame size per channel in samples */
     XA_RENDERER_CONFIG_PARAM_CODEC_TYPE     = 8,
-    XA_RENDERER_CONFIG_PARAM_NUM            = 9
+    XA_RENDERER_CONFIG_PARAM_PERIOD_COUNT   = 9,    /* number of frame sized periods in the DMA ring; the ring must fit in 8 KB */
+    XA_RENDERER_CONFIG_PARAM_START_THRESHOLD = 10,  /* periods queued before transmission starts */
+    XA_RENDERER_CONFIG_PARAM_UNDERRUN_POLICY = 11,  /* see enum xa_renderer_underrun_policy */
+    XA_RENDERER_CONFIG_PARAM_UNDERRUN_COUNT = 12,   /* number of underruns since init, read only */
+    XA_RENDERER_CONFIG_PARAM_POSITION       = 13,   /* frames played out, latches the other position values, read only */
+    XA_RENDERER_CONFIG_PARAM_POSITION_TIME  = 14,   /* monotonic time in us of the latched position, read only */
+    XA_RENDERER_CONFIG_PARAM_DELAY          = 15,   /* frames queued but not played at the latched position, read only */
+    XA_RENDERER_CONFIG_PARAM_POSITION_HI    = 16,   /* high 32 bits of the latched position, read only */
+    XA_RENDERER_CONFIG_PARAM_POSITION_TIME_HI = 17, /* high 32 bits of the latched position time, read only */
+    XA_RENDERER_CONFIG_PARAM_NUM            = 18
 };
 
 /* ...XA_RENDERER_CONFIG_PARAM_CB: compound parameters data structure */
@@ -68,6 +77,14 @@ enum xa_randerer_state {
     XA_RENDERER_STATE_SUSPEND        = 4,
     XA_RENDERER_STATE_SUSPEND_RESUME = 5
 };
+
+/* ...XA_RENDERER_CONFIG_PARAM_UNDERRUN_POLICY: what to play when the FIFO runs dry */
+enum xa_renderer_underrun_policy {
+    XA_RENDERER_UNDERRUN_STOP    = 0,   /* stop the hardware, restart on a refilled FIFO */
+    XA_RENDERER_UNDERRUN_SILENCE = 1,   /* keep running and play zeros */
+    XA_RENDERER_UNDERRUN_FADE    = 2,   /* keep running and repeat the last period fading out */
+    XA_RENDERER_UNDERRUN_REPEAT  = 3    /* keep running and repeat the last period */
+};
     
 /* ...component identifier (informative) */
 #define XA_CODEC_RENDERER               6
@@ -65,7 +65,13 @@ enum xa_api_cmd_generic {
   XA_API_CMD_SET_TABLE_PTR            = 0x001C,
   XA_API_CMD_GET_TABLE_PTR            = 0x001D,
 
-  XA_API_CMD_DEINIT                   = 0x001E
+  XA_API_CMD_DEINIT                   = 0x001E,
+
+  /* optional: input given as scattered segments, see xa_codec_input_segments_t */
+  XA_API_CMD_SET_INPUT_SEGMENTS       = 0x001F,
+
+  /* optional: non-zero if output may be written over the input buffer */
+  XA_API_CMD_GET_INPLACE              = 0x0020
 };
 
 /*****************************************************************************/
@@ -27,7 +27,8 @@
 #include "xaf-mem.h"
 
 /* Constants */
-#define XAF_MAX_INBUFS                      2
+#define XAF_MAX_INBUFS                      4
+#define XAF_MAX_OUTBUFS                     4
 #define XAF_INBUF_SIZE                      4096
 #define XAF_SHMEM_STRUCT_SIZE               12288
 
@@ -120,9 +121,34 @@ enum xaf_comp_config_param {
     XAF_COMP_CONFIG_PARAM_RELAX_SCHED  = 0x20000 + 0x1,
     XAF_COMP_CONFIG_PARAM_PRIORITY     = 0x20000 + 0x2,
     XAF_COMP_CONFIG_PARAM_SELF_SCHED   = 0x20000 + 0x3, 
+    XAF_COMP_CONFIG_PARAM_PORT_POLICY  = 0x20000 + 0x4, 
+    XAF_COMP_CONFIG_PARAM_PORT_DEPTH   = 0x20000 + 0x5, 
     XAF_COMP_CONFIG_PARAM_EVENT_CB     = 0x20000 + 0xE, 
 };
 
+/* ...mimo input port readiness policy (XAF_COMP_CONFIG_PARAM_PORT_POLICY) */
+enum xaf_port_policy {
+    XAF_PORT_POLICY_REQUIRED  = 0,      /* component waits for port data (default) */
+    XAF_PORT_POLICY_OPTIONAL  = 1,      /* component waits until a required input queues more than threshold bytes */
+    XAF_PORT_POLICY_ZERO_FILL = 2,      /* component never waits; missing data is replaced with silence */
+};
+
+/* ...port policy setting encoding (threshold in bytes queued on a required
+ * port, not a time); an optional port also stops waiting once a required
+ * port holds more than one frame */
+#define XAF_PORT_POLICY(port, policy, threshold)  \
+    (((threshold) & 0xFFFF) | (((policy) & 0xFF) << 16) | ((port) << 24))
+
+/* ...get-config id for number of buffers an output port circulates */
+#define XAF_PORT_DEPTH(port)                    \
+    (XAF_COMP_CONFIG_PARAM_PORT_DEPTH | (((port) & 0xFF) << 8))
+
+/* ...check get-config id is a port depth query; extract its port */
+#define XAF_PORT_DEPTH_ID(id)                   \
+    (((id) & ~0xFF00) == XAF_COMP_CONFIG_PARAM_PORT_DEPTH)
+#define XAF_PORT_DEPTH_PORT(id)                 \
+    (((id) >> 8) & 0xFF)
+
 /* Component string identifier */
 typedef const char *xf_id_t; 
 
@@ -179,6 +205,7 @@ XAF_ERR_CODE xaf_comp_set_config(pVOID p_comp, WORD32 num_param, pWORD32 p_param
 XAF_ERR_CODE xaf_comp_get_config(pVOID p_comp, WORD32 num_param, pWORD32 p_param);
 XAF_ERR_CODE xaf_comp_process(pVOID p_adev, pVOID p_comp, pVOID p_buf, UWORD32 length, xaf_comp_flag flag);
 XAF_ERR_CODE xaf_connect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 num_buf);
+XAF_ERR_CODE xaf_connect_adaptive(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port, WORD32 max_buf);
 XAF_ERR_CODE xaf_disconnect(pVOID p_src, WORD32 src_out_port, pVOID p_dest, WORD32 dest_in_port);
 XAF_ERR_CODE xaf_get_mem_stats(pVOID p_dev, WORD32 *pmem_info);
 
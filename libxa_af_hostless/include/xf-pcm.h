@@ -0,0 +1,110 @@
+/*
+* Copyright (c) 2015-2021 Cadence Design Systems Inc.
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+/*******************************************************************************
+ * xf-pcm.h
+ *
+ * PCM sample format conversion, interleaving and saturation kernels shared
+ * by the framework classes and the DSP plugins
+ *******************************************************************************/
+
+#ifndef __XF_PCM_H
+#define __XF_PCM_H
+
+#include "xa_type_def.h"
+
+/*******************************************************************************
+ * Sample formats
+ *
+ * Width is given in bits, as in the PCM_WIDTH parameter of the components.
+ * 8-, 16- and 32-bit samples are signed integers of their own size. 24-bit
+ * samples are left-justified in 32-bit containers, with the low byte clear.
+ * Every format is thus a Q31 value truncated to its container, and converting
+ * between formats is a shift.
+ ******************************************************************************/
+
+/* ...bits of a 24-bit sample in its container; the low pad byte is clear */
+#define XF_PCM_MASK_S24                 ((WORD32)0xFFFFFF00)
+
+/* ...check sample width is supported */
+static inline int xf_pcm_width_valid(UWORD32 width)
+{
+    return (width == 8 || width == 16 || width == 24 || width == 32);
+}
+
+/* ...sample container size in bytes */
+static inline UWORD32 xf_pcm_sample_size(UWORD32 width)
+{
+    return (width == 24 ? 4 : width >> 3);
+}
+
+/* ...loop iterations are independent, in-place processing included; lets
+ * the compiler vectorise */
+#if defined(__XCC__)
+#define XF_PCM_LOOP_CONCURRENT          _Pragma("concurrent")
+#else
+#define XF_PCM_LOOP_CONCURRENT
+#endif
+
+/*******************************************************************************
+ * Saturation
+ ******************************************************************************/
+
+static inline WORD8 xf_pcm_sat8(WORD32 v)
+{
+    return (WORD8)(v > 0x7F ? 0x7F : (v < -0x80 ? -0x80 : v));
+}
+
+static inline WORD16 xf_pcm_sat16(WORD32 v)
+{
+    return (WORD16)(v > 0x7FFF ? 0x7FFF : (v < -0x8000 ? -0x8000 : v));
+}
+
+static inline WORD32 xf_pcm_sat32(WORD64 v)
+{
+    return (WORD32)(v > 0x7FFFFFFFLL ? 0x7FFFFFFFLL : (v < -0x80000000LL ? -0x80000000LL : v));
+}
+
+/*******************************************************************************
+ * Buffer kernels
+ *
+ * Lengths are in samples (n) or in frames of interleaved samples. Kernels
+ * return 0 on success and -1 if a width is not supported.
+ ******************************************************************************/
+
+/* ...convert samples between widths; narrowing truncates, widening zero-fills;
+ * dst may be the same as src */
+extern WORD32 xf_pcm_convert(void *dst, UWORD32 dst_width, const void *src, UWORD32 src_width, UWORD32 n);
+
+/* ...planar src[channels] to interleaved dst; buffers must not overlap */
+extern WORD32 xf_pcm_interleave(void *dst, const void * const src[], UWORD32 width, UWORD32 channels, UWORD32 frames);
+
+/* ...interleaved src to planar dst[channels]; buffers must not overlap */
+extern WORD32 xf_pcm_deinterleave(void * const dst[], const void *src, UWORD32 width, UWORD32 channels, UWORD32 frames);
+
+/* ...attenuate samples in place by 6dB per shift step */
+extern WORD32 xf_pcm_attenuate(void *buf, UWORD32 width, UWORD32 n, UWORD32 shift);
+
+/* ...scale samples by a Q12 gain with saturation; dst may be the same as src */
+extern WORD32 xf_pcm_scale(void *dst, const void *src, UWORD32 width, UWORD32 n, UWORD16 gain);
+
+#endif  /* __XF_PCM_H */
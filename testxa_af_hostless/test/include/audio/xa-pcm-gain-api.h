@@ -61,11 +61,20 @@ enum xa_config_param_pcm_gain {
     XA_PCM_GAIN_BURN_ADDITIONAL_CYCLES         = 0x6,  /* Parameter to simulate desired MHz load in PCM-GAIN for experimental purpose */
     XA_PCM_GAIN_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES = 0x7,
 #ifndef XA_DISABLE_EVENT
-    XA_PCM_GAIN_CONFIG_PARAM_EVENT_GAIN_FACTOR = 0x8
+    XA_PCM_GAIN_CONFIG_PARAM_EVENT_GAIN_FACTOR = 0x8,
 #endif
+    XA_PCM_GAIN_CONFIG_PARAM_RAMP_LENGTH       = 0x9,  /* Gain change ramp length in samples per channel, 0 - change at once (default) */
+    XA_PCM_GAIN_CONFIG_PARAM_RAMP_SHAPE        = 0xA,  /* Gain change ramp shape, see xa_pcm_gain_ramp_shape */
+    XA_PCM_GAIN_CONFIG_PARAM_INPUT_SEGMENTS    = 0xB,  /* Take input as scattered segments (XA_API_CMD_SET_INPUT_SEGMENTS), 0 - contiguous buffer (default) */
 
 };
 
+/* ...shape of gain change ramp */
+enum xa_pcm_gain_ramp_shape {
+    XA_PCM_GAIN_RAMP_LINEAR                    = 0,
+    XA_PCM_GAIN_RAMP_EXPONENTIAL               = 1,
+};
+
 /* ...component identifier (informative) */
 #define XA_CODEC_PCM_GAIN                  4
 
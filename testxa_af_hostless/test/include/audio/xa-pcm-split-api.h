@@ -58,6 +58,7 @@ enum xa_config_param_pcm_split {
     XA_PCM_SPLIT_CONFIG_PARAM_PORT_RESUME       = 5,
     XA_PCM_SPLIT_CONFIG_PARAM_PORT_CONNECT      = 6,
     XA_PCM_SPLIT_CONFIG_PARAM_PORT_DISCONNECT   = 7,
+    XA_PCM_SPLIT_CONFIG_PARAM_OUT_PCM_WIDTH     = 8,
 };
 
 /* ...component identifier (informative) */
@@ -238,6 +238,7 @@ extern xf_thread_t *g_comp_thread;
 extern event_list_t *g_event_list;
 extern xa_app_event_handler_fxn_t *g_app_handler_fn;
 extern UWORD32 worker_thread_scratch_size[XAF_MAX_WORKER_THREADS];
+extern int g_read_chunk_size;
 
 #ifndef XA_DISABLE_EVENT
 extern UWORD32 g_enable_error_channel_flag;
@@ -253,6 +254,7 @@ int all_threads_exited(void **comp_threads, int num_threads);
 void set_wbna(int *argc, char **argv);
 int print_verinfo(pUWORD8 ver_info[],pUWORD8 app_name);
 int read_input(void *p_buf, int buf_length, int *read_length, void *p_input, xaf_comp_type comp_type);
+int consume_output(void *p_buf, int buf_length, void *p_output, xaf_comp_type comp_type);
 double compute_comp_mcps(unsigned int num_bytes, long long comp_cycles, xaf_format_t comp_format, double *strm_duration);
 int print_mem_mcps_info(mem_obj_t* mem_handle, int num_comp);
 void *comp_process_entry(void *arg);
@@ -38,6 +38,7 @@
 /* ...debugging facility */
 #include "xf-debug.h"
 #include "audio/xa-mixer-api.h"
+#include "xf-pcm.h"
 
 
 #ifdef XAF_PROFILE
@@ -49,6 +50,9 @@ extern clk_t mix_cycles;
  * Internal functions definitions
  ******************************************************************************/
 
+/* ...maximal number of interleaved channels */
+#define XA_MIXER_MAX_CHANNELS           8
+
 /* ...API structure */
 typedef struct XAPcmMixer
 {
@@ -91,6 +95,18 @@ typedef struct XAPcmMixer
     /* ...input over flag */
     UWORD32             input_over[XA_MIXER_MAX_TRACK_NUMBER];
 
+    /* ...mixing kernel for configured format; returns output end pointer */
+    void *            (*kernel)(struct XAPcmMixer *d, UWORD32 n);
+
+    /* ...buffers of tracks having input in current frame */
+    void               *b[XA_MIXER_MAX_TRACK_NUMBER];
+
+    /* ...per-channel volumes of those tracks (Q12) */
+    UWORD16             v[XA_MIXER_MAX_TRACK_NUMBER][XA_MIXER_MAX_CHANNELS];
+
+    /* ...per-channel master volume (Q12) */
+    UWORD16             w[XA_MIXER_MAX_CHANNELS];
+
 }   XAPcmMixer;
 
 /*******************************************************************************
@@ -110,13 +126,6 @@ typedef struct XAPcmMixer
 #define MIXER_FRAME_SIZE_MAX    4096
 #define MIXER_FRAME_SIZE_MIN      32
 
-/*******************************************************************************
- * DSP functions
- ******************************************************************************/
-
-#define DSP_SATURATE_S16(WORD32)   \
-    (WORD16)((WORD32) > 0x7fff ? 0x7fff : ((WORD32) < -0x8000 ? -0x8000 : (WORD32)))
-
 /* ...mixer preinitialization (default parameters) */
 static inline void xa_mixer_preinit(XAPcmMixer *d)
 {
@@ -135,58 +144,218 @@ static inline void xa_mixer_preinit(XAPcmMixer *d)
     }
 }
 
-/* ...do mixing of stereo PCM-16 streams */
-static XA_ERRORCODE xa_mixer_do_execute_stereo_16bit(XAPcmMixer *d)
+/* ...normalize (truncate towards -inf), multiply by master volume, saturate and store */
+static inline WORD16 * xa_mixer_put_stereo_16bit(WORD16 *output, WORD64 l64, WORD64 r64, UWORD16 w_l, UWORD16 w_r)
 {
-    WORD16    *output = d->output;
-    WORD16    *b[XA_MIXER_MAX_TRACK_NUMBER]; 
-    UWORD16     v_l[XA_MIXER_MAX_TRACK_NUMBER];
-    UWORD16     v_r[XA_MIXER_MAX_TRACK_NUMBER];
-    UWORD16     w_l, w_r;    
-    UWORD32     t32;
+    l64 = ((l64 >> 12) * w_l) >> 12;
+    r64 = ((r64 >> 12) * w_r) >> 12;
+
+    *output++ = xf_pcm_sat16(xf_pcm_sat32(l64));
+    *output++ = xf_pcm_sat16(xf_pcm_sat32(r64));
+
+    return output;
+}
+
+/* ...mix stereo PCM-16 tracks; one and two tracks are the common cases */
+static void * xa_mixer_stereo_16bit(XAPcmMixer *d, UWORD32 n)
+{
+    WORD16     *output = d->output;
+    WORD16    **b = (WORD16 **)d->b;
+    UWORD16     w_l = d->w[0], w_r = d->w[1];
     UWORD32     i, j;
+
+    if (n == 1)
+    {
+        WORD16     *b0 = b[0];
+        UWORD16     v_l0 = d->v[0][0], v_r0 = d->v[0][1];
+
+        for (i = 0; i < d->frame_size; i++, b0 += 2)
+        {
+            output = xa_mixer_put_stereo_16bit(output, b0[0] * v_l0, b0[1] * v_r0, w_l, w_r);
+        }
+    }
+    else if (n == 2)
+    {
+        WORD16     *b0 = b[0], *b1 = b[1];
+        UWORD16     v_l0 = d->v[0][0], v_r0 = d->v[0][1];
+        UWORD16     v_l1 = d->v[1][0], v_r1 = d->v[1][1];
+
+        for (i = 0; i < d->frame_size; i++, b0 += 2, b1 += 2)
+        {
+            /* ...one weighted sample may take all of 32 bits, sum in 64 */
+            output = xa_mixer_put_stereo_16bit(output,
+                                               (WORD64)(b0[0] * v_l0) + b1[0] * v_l1,
+                                               (WORD64)(b0[1] * v_r0) + b1[1] * v_r1,
+                                               w_l, w_r);
+        }
+    }
+    else
+    {
+        for (i = 0; i < 2 * d->frame_size; i += 2)
+        {
+            WORD64     l64 = (WORD64)(b[0][i] * d->v[0][0]) + b[1][i] * d->v[1][0];
+            WORD64     r64 = (WORD64)(b[0][i + 1] * d->v[0][1]) + b[1][i + 1] * d->v[1][1];
+
+            /* ...two tracks per step; 64-bit sum, no saturation needed */
+            for (j = 2; j + 1 < n; j += 2)
+            {
+                l64 += (WORD64)(b[j][i] * d->v[j][0]) + b[j + 1][i] * d->v[j + 1][0];
+                r64 += (WORD64)(b[j][i + 1] * d->v[j][1]) + b[j + 1][i + 1] * d->v[j + 1][1];
+            }
+
+            /* ...odd track left over */
+            if (j < n)
+            {
+                l64 += b[j][i] * d->v[j][0];
+                r64 += b[j][i + 1] * d->v[j][1];
+            }
+
+            output = xa_mixer_put_stereo_16bit(output, l64, r64, w_l, w_r);
+        }
+    }
+
+    return output;
+}
+
+/* ...mix PCM-16 tracks with any channel number */
+static void * xa_mixer_multichannel_16bit(XAPcmMixer *d, UWORD32 n)
+{
+    WORD16     *output = d->output;
+    WORD16    **b = (WORD16 **)d->b;
+    UWORD32     channels = d->channels;
+    UWORD32     i, c, j, k;
+
+    for (i = k = 0; i < d->frame_size; i++)
+    {
+        for (c = 0; c < channels; c++, k++)
+        {
+            WORD64     a64 = 0;
+
+            /* ...one weighted sample may take all of 32 bits, sum in 64 */
+            for (j = 0; j < n; j++)
+            {
+                a64 += b[j][k] * d->v[j][c];
+            }
+
+            a64 = ((a64 >> 12) * d->w[c]) >> 12;
+
+            *output++ = xf_pcm_sat16(xf_pcm_sat32(a64));
+        }
+    }
+
+    return output;
+}
+
+/* ...mix 32-bit tracks (Q31 or left-justified 24-bit) in 64-bit accumulator */
+static inline void * __xa_mixer_32bit(XAPcmMixer *d, UWORD32 n, WORD32 mask)
+{
+    WORD32     *output = d->output;
+    WORD32    **b = (WORD32 **)d->b;
+    UWORD32     channels = d->channels;
+    UWORD32     i, c, j, k;
+
+    for (i = k = 0; i < d->frame_size; i++)
+    {
+        for (c = 0; c < channels; c++, k++)
+        {
+            WORD64     a64 = 0;
+
+            for (j = 0; j < n; j++)
+            {
+                a64 += (WORD64)b[j][k] * d->v[j][c];
+            }
+
+            a64 = ((a64 >> 12) * d->w[c]) >> 12;
+
+            *output++ = xf_pcm_sat32(a64) & mask;
+        }
+    }
+
+    return output;
+}
+
+static void * xa_mixer_multichannel_24bit(XAPcmMixer *d, UWORD32 n)
+{
+    return __xa_mixer_32bit(d, n, XF_PCM_MASK_S24);
+}
+
+static void * xa_mixer_multichannel_32bit(XAPcmMixer *d, UWORD32 n)
+{
+    return __xa_mixer_32bit(d, n, (WORD32)0xFFFFFFFF);
+}
+
+/* ...select mixing kernel for configured format */
+static inline void xa_mixer_select_kernel(XAPcmMixer *d)
+{
+    switch (d->pcm_width)
+    {
+    case 16:
+        d->kernel = (d->channels == 2 ? xa_mixer_stereo_16bit : xa_mixer_multichannel_16bit);
+        break;
+    case 24:
+        d->kernel = xa_mixer_multichannel_24bit;
+        break;
+    default:
+        d->kernel = xa_mixer_multichannel_32bit;
+        break;
+    }
+}
+
+/* ...do mixing of PCM streams */
+static XA_ERRORCODE xa_mixer_do_execute(XAPcmMixer *d)
+{
+    void       *output = d->output;
+    UWORD32     t32;
+    UWORD32     c, j;
+    UWORD32     n = 0;
     UWORD32 ports_inactive = 0;
     UWORD32 ports_completed = 0;
     
-    /* ...retrieve master volume - assume up to 24dB amplifying (4 bits) */
+    /* ...retrieve master volume - assume up to 24dB amplifying (4 bits); odd channels take right volume */
     t32 = d->volume[XA_MIXER_MAX_TRACK_NUMBER];
-    w_l = (UWORD16)(t32 & 0xFFFF), w_r = (UWORD16)(t32 >> 16);
+
+    for (c = 0; c < d->channels; c++)
+    {
+        d->w[c] = (UWORD16)(c & 1 ? t32 >> 16 : t32 & 0xFFFF);
+    }
 
     /* ...reset produced bytes */
     d->produced = 0;
     
-    /* ...prepare individual tracks */
+    /* ...collect tracks having input; idle tracks cost nothing in the processing loop */
     for (j = 0; j < XA_MIXER_MAX_TRACK_NUMBER; j++)
     {
-        UWORD32     n = d->input_length[j];
+        UWORD32     length = d->input_length[j];
         
         /* ...check if we have input buffer available */
-        if (n == 0)
+        if (length == 0)
         {
-            /* ...output silence (multiply garbage in the scratch buffer by 0) */
-            b[j] = d->scratch;
-            v_l[j] = v_r[j] = 0;
-
             ports_inactive += (d->input_over[j]);
         }
         else
         {
-            WORD32     k = (WORD32)(d->buffer_size - n);
+            WORD32     k = (WORD32)(d->buffer_size - length);
             
             /* ...put input buffer */
-            XF_CHK_ERR(b[j] = d->input[j], XA_MIXER_EXEC_FATAL_INPUT);
+            XF_CHK_ERR(d->b[n] = d->input[j], XA_MIXER_EXEC_FATAL_INPUT);
             
             /* ...if length is not sufficient, pad buffer remainder */
-            (k > 0 ? memset((void *)b[j] + n, 0x00, k) : 0);
+            (k > 0 ? memset(d->b[n] + length, 0x00, k) : 0);
             
             /* ...set individual track volume/balance */
             t32 = d->volume[j];
-            v_l[j] = (UWORD16)(t32 & 0xFFFF), v_r[j] = (UWORD16)(t32 >> 16);
+
+            for (c = 0; c < d->channels; c++)
+            {
+                d->v[n][c] = (UWORD16)(c & 1 ? t32 >> 16 : t32 & 0xFFFF);
+            }
+
+            n++;
         }
 
         ports_completed += (d->input_over[j]);
 
-        TRACE(PROCESS, _b("b[%u] = %p%s"), j, b[j], (n == 0 ? " - scratch" : ""));
+        TRACE(PROCESS, _b("track[%u]: %u bytes"), j, length);
     }
 
     /* ...set complete flag saying we have no active input port */
@@ -200,46 +369,26 @@ static XA_ERRORCODE xa_mixer_do_execute_stereo_16bit(XAPcmMixer *d)
         return XA_NO_ERROR;
     }
 
-#if 1
-    /* ...process all tracks */
-    for (i = 0; i < d->frame_size; i++)
+    if (n == 0)
     {
-        WORD32     l32 = 0, r32 = 0;
-
-        /* ...fill-in every channel in our map (unrolls loop here) */
-        for (j = 0; j < XA_MIXER_MAX_TRACK_NUMBER; j++)
-        {
-            /* ...left channel processing (no saturation here yet) */
-            l32 += *b[j]++ * v_l[j];
-
-            /* ...right channel processing */
-            r32 += *b[j]++ * v_r[j];
-        }
-
-        /* ...normalize (truncate towards -inf) and multiply by master volume */
-        l32 = ((l32 >> 12) * w_l) >> 12;
-        r32 = ((r32 >> 12) * w_r) >> 12;
+        /* ...no track has data; output silence */
+        memset(output, 0x00, d->buffer_size);
 
-        /* ...saturate and store in buffer */
-        *output++ = DSP_SATURATE_S16(l32);
-        *output++ = DSP_SATURATE_S16(r32);
+        output += d->buffer_size;
     }
-#else
-    // Bypass processing
-    output += d->frame_size;
-    output += d->frame_size;  
-#endif
+    else
+    {
+        output = d->kernel(d, n);
+    }
+
     /* ...save total number of produced bytes */
-    d->produced = (UWORD32)((void *)output - d->output);
+    d->produced = (UWORD32)(output - d->output);
 
     /* ...put flag saying we have output buffer */
     d->state |= XA_MIXER_FLAG_OUTPUT;
  
-    TRACE(PROCESS, _b("produced: %u bytes (%u samples)"), d->produced, d->frame_size);
+    TRACE(PROCESS, _b("produced: %u bytes (%u samples, %u tracks)"), d->produced, d->frame_size, n);
     
-    /* ...reset input buffer length? */
-    //memset(d->input_length, 0, sizeof(d->input_length));
-
     /* ...set complete flag saying we have consumed all available input and input is over */
     if(ports_completed == XA_MIXER_MAX_TRACK_NUMBER)
     {
@@ -303,7 +452,10 @@ static XA_ERRORCODE xa_mixer_init(XAPcmMixer *d, WORD32 i_idx, pVOID pv_value)
         XF_CHK_ERR(d->state & XA_MIXER_FLAG_PREINIT_DONE, XA_API_FATAL_INVALID_CMD_TYPE);
     
         /* ...calculate input/output buffer size in bytes */
-        d->buffer_size = d->channels * d->frame_size * (d->pcm_width == 16 ? sizeof(WORD16) : sizeof(WORD32));
+        d->buffer_size = d->channels * d->frame_size * xf_pcm_sample_size(d->pcm_width);
+
+        /* ...format is fixed from now on; pick mixing kernel once */
+        xa_mixer_select_kernel(d);
         
         /* ...mark post-initialization is complete */
         d->state |= XA_MIXER_FLAG_POSTINIT_DONE;
@@ -358,14 +510,14 @@ static XA_ERRORCODE xa_mixer_set_config_param(XAPcmMixer *d, WORD32 i_idx, pVOID
     switch (i_idx)
     {
     case XA_MIXER_CONFIG_PARAM_PCM_WIDTH:
-        /* ...check value is permitted (16 bits only) */
-        XF_CHK_ERR(i_value == 16, XA_MIXER_CONFIG_NONFATAL_RANGE);
+        /* ...check value is permitted (16, 24 or 32 bits; 24-bit samples take 32-bit containers) */
+        XF_CHK_ERR(i_value == 16 || i_value == 24 || i_value == 32, XA_MIXER_CONFIG_NONFATAL_RANGE);
         d->pcm_width = (UWORD32)i_value;
         return XA_NO_ERROR;
 
     case XA_MIXER_CONFIG_PARAM_CHANNELS:
-        /* ...allow stereo only */
-        XF_CHK_ERR(i_value == 2, XA_MIXER_CONFIG_NONFATAL_RANGE);
+        /* ...allow up to 8 interleaved channels */
+        XF_CHK_ERR(i_value >= 1 && i_value <= XA_MIXER_MAX_CHANNELS, XA_MIXER_CONFIG_NONFATAL_RANGE);
         d->channels = (UWORD32)i_value;
         return XA_NO_ERROR;
 
@@ -482,7 +634,7 @@ static XA_ERRORCODE xa_mixer_execute(XAPcmMixer *d, WORD32 i_idx, pVOID pv_value
 #ifdef XAF_PROFILE
         mix_start = clk_read_start(CLK_SELN_THREAD);
 #endif
-        ret = xa_mixer_do_execute_stereo_16bit(d);
+        ret = xa_mixer_do_execute(d);
 #ifdef XAF_PROFILE
         mix_stop = clk_read_stop(CLK_SELN_THREAD);
         mix_cycles += clk_diff(mix_stop, mix_start);
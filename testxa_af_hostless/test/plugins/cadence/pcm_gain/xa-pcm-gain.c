@@ -39,6 +39,7 @@
 #include "osal-timer.h"
 #include "xf-debug.h"
 #include "audio/xa-pcm-gain-api.h"
+#include "xf-pcm.h"
 
 #ifndef XA_DISABLE_EVENT
 #include "xa-gain-factor-event.h"
@@ -98,6 +99,30 @@ typedef struct XAPcmGain
     /* ...framesize in samples per channel */
     UWORD32                 frame_size;    
 
+    /* ...gain currently applied, Q12 with 16 extra fractional bits */
+    WORD32                  gain;
+
+    /* ...per-sample increment of linear gain ramp */
+    WORD32                  gain_step;
+
+    /* ...samples per channel left in ongoing gain ramp */
+    UWORD32                 ramp_left;
+
+    /* ...gain ramp length in samples per channel; zero - no ramp */
+    UWORD32                 ramp_length;
+
+    /* ...gain ramp shape */
+    UWORD32                 ramp_shape;
+
+    /* ...exponential ramp smoothing factor (power of two) */
+    UWORD32                 ramp_shift;
+
+    /* ...input is taken as scattered segments */
+    UWORD32                 input_segments;
+
+    /* ...current input segments; NULL until framework passes them */
+    xa_codec_input_segments_t  *segments;
+
 }   XAPcmGain;
 
 
@@ -120,17 +145,8 @@ typedef struct XAPcmGain
 WORD16 pcm_gains_dB[7] = {   0,   -6,  -12, -18,    6,    12,    18};    // in dB
 WORD16 pcm_gains[7]    = {4096, 2053, 1029, 516, 8173, 16306, 32536};    // Q12 format
 
-#define MAX_8BIT ((WORD8)0x7F)
-#define MIN_8BIT ((WORD8)0x80)
-
-#define MAX_16BIT ((WORD16)0x7FFF)
-#define MIN_16BIT ((WORD16)0x8000)
-
-#define MAX_24BIT ((WORD32)0x7FFFFF00)
-#define MIN_24BIT  ((WORD32)0x800000FF)
-
-#define MAX_32BIT ((WORD32)0x7FFFFFFF)
-#define MIN_32BIT  ((WORD32)0x80000000)
+/* ...0dB gain in Q12 */
+#define XA_PCM_GAIN_UNITY           4096
 
 /*******************************************************************************
  * Pcm gain state flags
@@ -160,49 +176,133 @@ static inline void xa_pcm_gain_preinit(XAPcmGain *d)
     d->sample_rate = 48000;
     d->burn_cycles = 0;
     d->frame_size = 480; /* ...10ms frame size at 48 kHz */
+    d->gain = pcm_gains[0] << 16;
+}
+
+/* ...set new gain index; gain ramps towards it if component is running */
+static void xa_pcm_gain_set_gain(XAPcmGain *d, UWORD32 idx)
+{
+    WORD32      target = pcm_gains[idx] << 16;
+
+    d->gain_idx = idx;
+
+    /* ...gain set before processing starts, or with ramp disabled, applies at once */
+    if (!(d->state & XA_PCM_GAIN_FLAG_RUNNING) || d->ramp_length == 0)
+    {
+        d->gain = target, d->ramp_left = 0;
+        return;
+    }
+
+    /* ...new ramp starts from the gain reached so far */
+    d->gain_step = (target - d->gain) / (WORD32)d->ramp_length;
+    d->ramp_left = d->ramp_length;
+}
+
+/* ...advance gain ramp by one sample per channel; return gain in Q12 */
+static inline WORD32 xa_pcm_gain_ramp(XAPcmGain *d)
+{
+    WORD32      target = pcm_gains[d->gain_idx] << 16;
+
+    if (--d->ramp_left == 0)
+    {
+        /* ...land exactly on target gain */
+        d->gain = target;
+    }
+    else if (d->ramp_shape == XA_PCM_GAIN_RAMP_LINEAR)
+    {
+        d->gain += d->gain_step;
+    }
+    else
+    {
+        /* ...one-pole approach; remaining error is under 1% at ramp end */
+        d->gain += (target - d->gain) >> d->ramp_shift;
+    }
+
+    return d->gain >> 16;
+}
+
+/* ...apply constant gain to 8-bit samples */
+static void xa_pcm_gain_apply_8bit(WORD8 *pIn, WORD8 *pOut, WORD32 n, WORD32 gain)
+{
+    WORD32     i, product;
+
+    XF_PCM_LOOP_CONCURRENT
+    for (i = 0; i < n; i++)
+    {
+        product = ((WORD32)pIn[i] * gain) >> 12;
+        pOut[i] = xf_pcm_sat8(product);
+    }
+}
+
+/* ...apply constant gain to 16-bit samples */
+static void xa_pcm_gain_apply_16bit(WORD16 *pIn, WORD16 *pOut, WORD32 n, WORD32 gain)
+{
+    WORD32     i, product;
+
+    XF_PCM_LOOP_CONCURRENT
+    for (i = 0; i < n; i++)
+    {
+        product = ((WORD32)pIn[i] * gain) >> 12;
+        pOut[i] = xf_pcm_sat16(product);
+    }
+}
+
+/* ...apply constant gain to 32-bit samples; "mask" clears bits below 24-bit sample */
+static void xa_pcm_gain_apply_32bit(WORD32 *pIn, WORD32 *pOut, WORD32 n, WORD32 gain, WORD32 mask)
+{
+    WORD32     i;
+    WORD64     product;
+
+    XF_PCM_LOOP_CONCURRENT
+    for (i = 0; i < n; i++)
+    {
+        product = ((WORD64)pIn[i] * gain) >> 12;
+        pOut[i] = xf_pcm_sat32(product) & mask;
+    }
 }
 
 /* ...apply gain to 8-bit PCM stream */
 static XA_ERRORCODE xa_pcm_gain_do_execute_8bit(XAPcmGain *d)
 {
-    WORD32     i, k, nSize;
+    WORD32     i, c, nSize;
     WORD8    *pIn = (WORD8 *) d->input;
     WORD8    *pOut = (WORD8 *) d->output;
-    UWORD32     filled = d->input_avail;   
-    WORD8     input;
-    WORD16     gain = pcm_gains[d->gain_idx];
-    WORD32     product;
-
+    WORD32     ch = (WORD32)d->channels;
+    WORD32     gain, product;
 
-    nSize = filled;    //size of each sample is 1 byte    
-    k = (WORD32)(d->buffer_size - filled);
+    nSize = d->input_avail;    //size of each sample is 1 byte    
     
     /* ...check I/O buffer */
     XF_CHK_ERR(d->input, XA_PCM_GAIN_EXEC_FATAL_INPUT);    
     XF_CHK_ERR(d->output, XA_PCM_GAIN_EXEC_FATAL_INPUT);
     
-    (k > 0 ? memset((void *)pIn + filled, 0x00, k) : 0);
-    
-    /* ...Processing loop */
-    for (i = 0; i < nSize; i++)
-    {    
-        input = *pIn++;
-        product = (WORD32)input*gain;
-        product = product >> 12;
-        
-        if(product > MAX_8BIT)
-            product = MAX_8BIT;
-        else if(product < MIN_8BIT)
-            product = MIN_8BIT;
-        
-        *pOut++ = (WORD8)product;
+    /* ...ramping part goes sample per channel at a time */
+    for (i = 0; d->ramp_left && i + ch <= nSize; i += ch)
+    {
+        gain = xa_pcm_gain_ramp(d);
+
+        for (c = i; c < i + ch; c++)
+        {
+            product = ((WORD32)pIn[c] * gain) >> 12;
+            pOut[c] = xf_pcm_sat8(product);
+        }
+    }
+
+    /* ...the rest has constant gain; 0dB is a plain copy */
+    if ((gain = d->gain >> 16) != XA_PCM_GAIN_UNITY)
+    {
+        xa_pcm_gain_apply_8bit(pIn + i, pOut + i, nSize - i, gain);
+    }
+    else if (pOut != pIn)
+    {
+        memcpy(pOut + i, pIn + i, (nSize - i) * sizeof(*pIn));
     }
 
     /* ...save total number of consumed bytes */
-    d->consumed = (UWORD32)((void *)pIn - d->input);
+    d->consumed = nSize * sizeof(*pIn);
 
     /* ...save total number of produced bytes */
-    d->produced = (UWORD32)((void *)pOut - d->output);
+    d->produced = nSize * sizeof(*pOut);
 
     /* ...put flag saying we have output buffer */
     d->state |= XA_PCM_GAIN_FLAG_OUTPUT;
@@ -216,44 +316,45 @@ static XA_ERRORCODE xa_pcm_gain_do_execute_8bit(XAPcmGain *d)
 /* ...apply gain to 16-bit PCM stream */
 static XA_ERRORCODE xa_pcm_gain_do_execute_16bit(XAPcmGain *d)
 {
-    WORD32     i, k, nSize;
+    WORD32     i, c, nSize;
     WORD16    *pIn = (WORD16 *) d->input;
     WORD16    *pOut = (WORD16 *) d->output;
-    UWORD32     filled = d->input_avail;   
-    WORD16     input;
-    WORD16     gain = pcm_gains[d->gain_idx];
-    WORD32     product;
-
+    WORD32     ch = (WORD32)d->channels;
+    WORD32     gain, product;
 
-    nSize = filled >> 1;    //size of each sample is 2 bytes    
-    k = (WORD32)(d->buffer_size - filled);
+    nSize = d->input_avail >> 1;    //size of each sample is 2 bytes    
     
     /* ...check I/O buffer */
     XF_CHK_ERR(d->input, XA_PCM_GAIN_EXEC_FATAL_INPUT);    
     XF_CHK_ERR(d->output, XA_PCM_GAIN_EXEC_FATAL_INPUT);
     
-    (k > 0 ? memset((void *)pIn + filled, 0x00, k) : 0);
-    
-    /* ...Processing loop */
-    for (i = 0; i < nSize; i++)
-    {    
-        input = *pIn++;
-        product = (WORD32)input*gain;
-        product = product >> 12;
-        
-        if(product > MAX_16BIT)
-            product = MAX_16BIT;
-        else if(product < MIN_16BIT)
-            product = MIN_16BIT;
-        
-        *pOut++ = (WORD16)product;
+    /* ...ramping part goes sample per channel at a time */
+    for (i = 0; d->ramp_left && i + ch <= nSize; i += ch)
+    {
+        gain = xa_pcm_gain_ramp(d);
+
+        for (c = i; c < i + ch; c++)
+        {
+            product = ((WORD32)pIn[c] * gain) >> 12;
+            pOut[c] = xf_pcm_sat16(product);
+        }
+    }
+
+    /* ...the rest has constant gain; 0dB is a plain copy */
+    if ((gain = d->gain >> 16) != XA_PCM_GAIN_UNITY)
+    {
+        xa_pcm_gain_apply_16bit(pIn + i, pOut + i, nSize - i, gain);
+    }
+    else if (pOut != pIn)
+    {
+        memcpy(pOut + i, pIn + i, (nSize - i) * sizeof(*pIn));
     }
 
     /* ...save total number of consumed bytes */
-    d->consumed = (UWORD32)((void *)pIn - d->input);
+    d->consumed = nSize * sizeof(*pIn);
 
     /* ...save total number of produced bytes */
-    d->produced = (UWORD32)((void *)pOut - d->output);
+    d->produced = nSize * sizeof(*pOut);
 
     /* ...put flag saying we have output buffer */
     d->state |= XA_PCM_GAIN_FLAG_OUTPUT;
@@ -264,48 +365,42 @@ static XA_ERRORCODE xa_pcm_gain_do_execute_16bit(XAPcmGain *d)
     return XA_NO_ERROR;
 }    
 
-/* ...apply gain to 24-bit PCM stream */
+/* ...apply gain to 24-bit PCM stream (in 32-bit container, MSB aligned) */
 static XA_ERRORCODE xa_pcm_gain_do_execute_24bit(XAPcmGain *d)
 {
-    WORD32     i, k, nSize;
+    WORD32     i, c, nSize;
     WORD24    *pIn = (WORD24 *) d->input;
     WORD24    *pOut = (WORD24 *) d->output;
-    UWORD32     filled = d->input_avail;   
-    WORD24     input;
-    WORD16     gain = pcm_gains[d->gain_idx];
+    WORD32     ch = (WORD32)d->channels;
+    WORD32     gain;
     WORD64     product;
 
-
-    nSize = filled >> 2;    //size of each sample is 4 bytes    
-    k = (WORD32)(d->buffer_size - filled);
+    nSize = d->input_avail >> 2;    //size of each sample is 4 bytes    
     
     /* ...check I/O buffer */
     XF_CHK_ERR(d->input, XA_PCM_GAIN_EXEC_FATAL_INPUT);    
     XF_CHK_ERR(d->output, XA_PCM_GAIN_EXEC_FATAL_INPUT);
     
-    (k > 0 ? memset((void *)pIn + filled, 0x00, k) : 0);
-    
-    /* ...Processing loop */
-    for (i = 0; i < nSize; i++)
-    {    
-        input = *pIn++;
-        product = (WORD64)input*gain;
-        product = product >> 12;
-        
-        if(product > MAX_24BIT)
-            product = MAX_24BIT;
-        else if(product < MIN_24BIT)
-            product = MIN_24BIT;
-        
-        product &= 0xffffff00;
-        *pOut++ = (WORD24)product;
+    /* ...ramping part goes sample per channel at a time */
+    for (i = 0; d->ramp_left && i + ch <= nSize; i += ch)
+    {
+        gain = xa_pcm_gain_ramp(d);
+
+        for (c = i; c < i + ch; c++)
+        {
+            product = ((WORD64)pIn[c] * gain) >> 12;
+            pOut[c] = xf_pcm_sat32(product) & XF_PCM_MASK_S24;
+        }
     }
 
+    /* ...the rest has constant gain; saturating to 32 bits and masking equals 24-bit saturation */
+    xa_pcm_gain_apply_32bit(pIn + i, pOut + i, nSize - i, d->gain >> 16, XF_PCM_MASK_S24);
+
     /* ...save total number of consumed bytes */
-    d->consumed = (UWORD32)((void *)pIn - d->input);
+    d->consumed = nSize * sizeof(*pIn);
 
     /* ...save total number of produced bytes */
-    d->produced = (UWORD32)((void *)pOut - d->output);
+    d->produced = nSize * sizeof(*pOut);
 
     /* ...put flag saying we have output buffer */
     d->state |= XA_PCM_GAIN_FLAG_OUTPUT;
@@ -319,44 +414,46 @@ static XA_ERRORCODE xa_pcm_gain_do_execute_24bit(XAPcmGain *d)
 /* ...apply gain to 32-bit PCM stream */
 static XA_ERRORCODE xa_pcm_gain_do_execute_32bit(XAPcmGain *d)
 {
-    WORD32     i, k, nSize;
+    WORD32     i, c, nSize;
     WORD32    *pIn = (WORD32 *) d->input;
     WORD32    *pOut = (WORD32 *) d->output;
-    UWORD32     filled = d->input_avail;   
-    WORD32     input;
-    WORD16     gain = pcm_gains[d->gain_idx];
+    WORD32     ch = (WORD32)d->channels;
+    WORD32     gain;
     WORD64     product;
 
-
-    nSize = filled >> 2;    //size of each sample is 4 bytes    
-    k = (WORD32)(d->buffer_size - filled);
+    nSize = d->input_avail >> 2;    //size of each sample is 4 bytes    
     
     /* ...check I/O buffer */
     XF_CHK_ERR(d->input, XA_PCM_GAIN_EXEC_FATAL_INPUT);    
     XF_CHK_ERR(d->output, XA_PCM_GAIN_EXEC_FATAL_INPUT);
     
-    (k > 0 ? memset((void *)pIn + filled, 0x00, k) : 0);
-    
-    /* ...Processing loop */
-    for (i = 0; i < nSize; i++)
-    {    
-        input = *pIn++;
-        product = (WORD64)input*gain;
-        product = product >> 12;
-        
-        if(product > MAX_32BIT)
-            product = MAX_32BIT;
-        else if(product < MIN_32BIT)
-            product = MIN_32BIT;
-        
-        *pOut++ = (WORD32)product;
+    /* ...ramping part goes sample per channel at a time */
+    for (i = 0; d->ramp_left && i + ch <= nSize; i += ch)
+    {
+        gain = xa_pcm_gain_ramp(d);
+
+        for (c = i; c < i + ch; c++)
+        {
+            product = ((WORD64)pIn[c] * gain) >> 12;
+            pOut[c] = xf_pcm_sat32(product);
+        }
+    }
+
+    /* ...the rest has constant gain; 0dB is a plain copy */
+    if ((gain = d->gain >> 16) != XA_PCM_GAIN_UNITY)
+    {
+        xa_pcm_gain_apply_32bit(pIn + i, pOut + i, nSize - i, gain, (WORD32)0xffffffff);
+    }
+    else if (pOut != pIn)
+    {
+        memcpy(pOut + i, pIn + i, (nSize - i) * sizeof(*pIn));
     }
 
     /* ...save total number of consumed bytes */
-    d->consumed = (UWORD32)((void *)pIn - d->input);
+    d->consumed = nSize * sizeof(*pIn);
 
     /* ...save total number of produced bytes */
-    d->produced = (UWORD32)((void *)pOut - d->output);
+    d->produced = nSize * sizeof(*pOut);
 
     /* ...put flag saying we have output buffer */
     d->state |= XA_PCM_GAIN_FLAG_OUTPUT;
@@ -367,6 +464,24 @@ static XA_ERRORCODE xa_pcm_gain_do_execute_32bit(XAPcmGain *d)
     return XA_NO_ERROR;
 }    
 
+/* ...assemble up to one frame of input segments; return number of bytes */
+static UWORD32 xa_pcm_gain_gather(XAPcmGain *d, void *buffer)
+{
+    xa_codec_input_segments_t  *seg = d->segments;
+    UWORD32     i, k, n = 0;
+
+    for (i = 0; i < seg->num && n < d->buffer_size; i++)
+    {
+        k = (seg->length[i] < d->buffer_size - n ? seg->length[i] : d->buffer_size - n);
+
+        memcpy((UWORD8 *)buffer + n, seg->ptr[i], k);
+
+        n += k;
+    }
+
+    return n;
+}
+
 /* ...runtime reset */
 static XA_ERRORCODE xa_pcm_gain_do_runtime_init(XAPcmGain *d)
 {
@@ -531,7 +646,7 @@ static XA_ERRORCODE xa_pcm_gain_set_config_param(XAPcmGain *d, WORD32 i_idx, pVO
     case XA_PCM_GAIN_CONFIG_PARAM_GAIN_FACTOR:
         /* ...set pcm gain component gain index */
         XF_CHK_ERR(((i_value >= 0)&&(i_value <= 6)), XA_PCM_GAIN_CONFIG_NONFATAL_RANGE);
-        d->gain_idx = (UWORD32)i_value;
+        xa_pcm_gain_set_gain(d, (UWORD32)i_value);
         return XA_NO_ERROR;
         
     case XA_PCM_GAIN_CONFIG_PARAM_FRAME_SIZE: /* ...deprecated */
@@ -549,10 +664,32 @@ static XA_ERRORCODE xa_pcm_gain_set_config_param(XAPcmGain *d, WORD32 i_idx, pVO
     case XA_PCM_GAIN_CONFIG_PARAM_EVENT_GAIN_FACTOR:
         memcpy(&gain_data, pv_value, sizeof(xa_gain_factor_event_t));
         /* ... setting gain index decteted by mimo_mix */
-        d->gain_idx = gain_data.gain_index; 
+        XF_CHK_ERR(gain_data.gain_index <= 6, XA_PCM_GAIN_CONFIG_NONFATAL_RANGE);
+        xa_pcm_gain_set_gain(d, gain_data.gain_index); 
         return XA_NO_ERROR;        
 #endif
 
+    case XA_PCM_GAIN_CONFIG_PARAM_RAMP_LENGTH:
+        /* ...set gain ramp length; ongoing ramp keeps its pace */
+        XF_CHK_ERR((WORD32)i_value >= 0, XA_PCM_GAIN_CONFIG_NONFATAL_RANGE);
+        d->ramp_length = (UWORD32)i_value;
+
+        /* ...exponential ramp time constant is about a fifth of ramp length */
+        for (d->ramp_shift = 0; (5U << (d->ramp_shift + 1)) <= d->ramp_length; d->ramp_shift++);
+        return XA_NO_ERROR;
+
+    case XA_PCM_GAIN_CONFIG_PARAM_RAMP_SHAPE:
+        /* ...set gain ramp shape */
+        XF_CHK_ERR((i_value == XA_PCM_GAIN_RAMP_LINEAR) || (i_value == XA_PCM_GAIN_RAMP_EXPONENTIAL), XA_PCM_GAIN_CONFIG_NONFATAL_RANGE);
+        d->ramp_shape = (UWORD32)i_value;
+        return XA_NO_ERROR;
+
+    case XA_PCM_GAIN_CONFIG_PARAM_INPUT_SEGMENTS:
+        /* ...input mode is fixed once memory is set up */
+        XF_CHK_ERR(!(d->state & XA_PCM_GAIN_FLAG_POSTINIT_DONE), XA_API_FATAL_INVALID_CMD_TYPE);
+        d->input_segments = (i_value != 0);
+        return XA_NO_ERROR;
+
     case XA_PCM_GAIN_CONFIG_PARAM_FRAME_SIZE_IN_SAMPLES:
         /* ...set pcm gain component frame_size */
         d->frame_size = (UWORD32)i_value;
@@ -618,7 +755,22 @@ static XA_ERRORCODE xa_pcm_gain_get_config_param(XAPcmGain *d, WORD32 i_idx, pVO
         /* ...return pcm gain component frame size */
         *(WORD32 *)pv_value = d->frame_size;
         return XA_NO_ERROR;        
-    
+
+    case XA_PCM_GAIN_CONFIG_PARAM_RAMP_LENGTH:
+        /* ...return gain ramp length */
+        *(WORD32 *)pv_value = d->ramp_length;
+        return XA_NO_ERROR;
+
+    case XA_PCM_GAIN_CONFIG_PARAM_RAMP_SHAPE:
+        /* ...return gain ramp shape */
+        *(WORD32 *)pv_value = d->ramp_shape;
+        return XA_NO_ERROR;
+
+    case XA_PCM_GAIN_CONFIG_PARAM_INPUT_SEGMENTS:
+        /* ...return input mode */
+        *(WORD32 *)pv_value = d->input_segments;
+        return XA_NO_ERROR;
+
     default:
         TRACE(ERROR, _x("Invalid parameter: %X"), i_idx);
         return XA_API_FATAL_INVALID_CMD_TYPE;
@@ -642,6 +794,8 @@ static XA_ERRORCODE xa_burn_cycles_module(XAPcmGain *d)
 static XA_ERRORCODE xa_pcm_gain_execute(XAPcmGain *d, WORD32 i_idx, pVOID pv_value)
 {
     XA_ERRORCODE ret = XA_NO_ERROR;
+    void        *input = NULL;
+    UWORD32     avail = 0;
 #ifdef XAF_PROFILE
     clk_t comp_start, comp_stop;
 #endif
@@ -667,6 +821,12 @@ static XA_ERRORCODE xa_pcm_gain_execute(XAPcmGain *d, WORD32 i_idx, pVOID pv_val
         {
            xa_burn_cycles_module(d);
         }
+        if (d->segments)
+        {
+            /* ...gain works in place; segments are assembled in output buffer */
+            input = d->input, avail = d->input_avail;
+            d->input = d->output, d->input_avail = xa_pcm_gain_gather(d, d->output);
+        }
         switch(d->pcm_width)
         {
             case 8:
@@ -684,6 +844,11 @@ static XA_ERRORCODE xa_pcm_gain_execute(XAPcmGain *d, WORD32 i_idx, pVOID pv_val
             default:
                 XF_CHK_ERR(0, XA_PCM_GAIN_CONFIG_NONFATAL_RANGE);
         }
+        if (d->segments)
+        {
+            /* ...consumed bytes count across all segments */
+            d->input = input, d->input_avail = avail;
+        }
 
         if ((d->input_avail == d->consumed) && (d->state & XA_PCM_GAIN_FLAG_EOS_RECEIVED)) /* Signal done */
         {
@@ -802,6 +967,37 @@ static XA_ERRORCODE xa_pcm_gain_input_over(XAPcmGain *d, WORD32 i_idx, pVOID pv_
     return XA_NO_ERROR;
 }
 
+/* ...set input segments; NULL pointer queries if segments are accepted */
+static XA_ERRORCODE xa_pcm_gain_set_input_segments(XAPcmGain *d, WORD32 i_idx, pVOID pv_value)
+{
+    /* ...sanity check */
+    XF_CHK_ERR(d, XA_API_FATAL_INVALID_CMD_TYPE);
+
+    /* ...track index must be valid */
+    XF_CHK_ERR(i_idx == 0, XA_API_FATAL_INVALID_CMD_TYPE);
+
+    /* ...segments are taken only if configured so */
+    XF_CHK_ERR(d->input_segments, XA_API_FATAL_INVALID_CMD);
+
+    if (pv_value)
+    {
+        d->segments = (xa_codec_input_segments_t *)pv_value;
+    }
+
+    return XA_NO_ERROR;
+}
+
+/* ...gain is applied sample by sample; output may overwrite input */
+static XA_ERRORCODE xa_pcm_gain_get_inplace(XAPcmGain *d, WORD32 i_idx, pVOID pv_value)
+{
+    /* ...sanity check */
+    XF_CHK_ERR(d && pv_value, XA_API_FATAL_INVALID_CMD_TYPE);
+
+    *(WORD32 *)pv_value = 1;
+
+    return XA_NO_ERROR;
+}
+
 /*******************************************************************************
  * Memory information API
  ******************************************************************************/
@@ -966,6 +1162,9 @@ static XA_ERRORCODE (* const xa_pcm_gain_api[])(XAPcmGain *, WORD32, pVOID) =
     [XA_API_CMD_GET_MEM_INFO_ALIGNMENT] = xa_pcm_gain_get_mem_info_alignment,
     [XA_API_CMD_GET_MEM_INFO_TYPE]      = xa_pcm_gain_get_mem_info_type,
     [XA_API_CMD_SET_MEM_PTR]            = xa_pcm_gain_set_mem_ptr,
+
+    [XA_API_CMD_GET_INPLACE]            = xa_pcm_gain_get_inplace,
+    [XA_API_CMD_SET_INPUT_SEGMENTS]     = xa_pcm_gain_set_input_segments,
 };
 
 /* ...total number of commands supported */
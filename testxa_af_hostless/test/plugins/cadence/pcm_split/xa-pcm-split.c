@@ -36,6 +36,7 @@
 #include <string.h>
 
 #include "audio/xa-pcm-split-api.h"
+#include "xf-pcm.h"
 
 /* ...debugging facility */
 #include "xf-debug.h"
@@ -111,6 +112,9 @@ typedef struct XAPcmAec
     UWORD32                 pcm_width;
     UWORD32                 channels;
 
+    /* ...sample width of output port 1 */
+    UWORD32                 out_pcm_width;
+
     WORD16		    port_state[XA_MIMO_IN_PORTS + XA_MIMO_OUT_PORTS];
 
 }   XAPcmAec;
@@ -145,6 +149,7 @@ static inline void xa_aec_preinit(XAPcmAec *d)
 
     d->pcm_width = XA_MIMO_CFG_DEFAULT_PCM_WIDTH;
     d->channels = XA_MIMO_CFG_DEFAULT_CHANNELS;
+    d->out_pcm_width = XA_MIMO_CFG_DEFAULT_PCM_WIDTH;
 
     d->in_buffer_size = XA_MIMO_CFG_IN_BUFFER_SIZE;
     d->out_buffer_size = XA_MIMO_CFG_OUT_BUFFER_SIZE;
@@ -196,6 +201,10 @@ static XA_ERRORCODE xa_aec_do_execute_stereo_16bit(XAPcmAec *d)
 
         nSize = filled >> 1;    //size of each sample is 2 bytes    
 
+        /* ...wider samples on output port 1 may not fit all the input */
+        if (nSize * xf_pcm_sample_size(d->out_pcm_width) > d->out_buffer_size)
+            nSize = d->out_buffer_size / xf_pcm_sample_size(d->out_pcm_width);
+
         /* ...Processing loop */
         for (i = 0; i < nSize; i++)
         {    
@@ -203,12 +212,14 @@ static XA_ERRORCODE xa_aec_do_execute_stereo_16bit(XAPcmAec *d)
             input0 = *pIn0++;
             
             *pOut0++ = (WORD16)input0;
-            *pOut1++ = (WORD16)input0;
         }
+
+        /* ...output port 1 gets the same samples in its own width */
+        xf_pcm_convert(pOut1, d->out_pcm_width, d->input[0], d->pcm_width, nSize);
         
         /* ...save total number of produced bytes */
         d->produced[0] = (UWORD32)((void *)pOut0 - d->output[0]);
-        d->produced[1] = (UWORD32)((void *)pOut1 - d->output[1]);
+        d->produced[1] = nSize * xf_pcm_sample_size(d->out_pcm_width);
        
         /* ...put flag saying we have output buffer */
         if(d->produced[0])
@@ -379,6 +390,12 @@ static XA_ERRORCODE xa_aec_set_config_param(XAPcmAec *d, WORD32 i_idx, pVOID pv_
         d->pcm_width = (UWORD32)i_value;
 	break;
 
+    case XA_PCM_SPLIT_CONFIG_PARAM_OUT_PCM_WIDTH:
+        /* ...output port 1 may widen or narrow the samples */
+        XF_CHK_ERR(xf_pcm_width_valid(i_value), XA_PCM_SPLIT_CONFIG_FATAL_RANGE);
+        d->out_pcm_width = (UWORD32)i_value;
+	break;
+
     case XA_PCM_SPLIT_CONFIG_PARAM_CHANNELS:
         /* ...allow stereo only */
         XF_CHK_ERR((i_value <= 2) && (i_value > 0), XA_PCM_SPLIT_CONFIG_FATAL_RANGE);
@@ -452,6 +469,11 @@ static XA_ERRORCODE xa_aec_get_config_param(XAPcmAec *d, WORD32 i_idx, pVOID pv_
         *(WORD32 *)pv_value = d->channels;
         return XA_NO_ERROR;
 
+    case XA_PCM_SPLIT_CONFIG_PARAM_OUT_PCM_WIDTH:
+        /* ...return sample width of output port 1 */
+        *(WORD32 *)pv_value = d->out_pcm_width;
+        return XA_NO_ERROR;
+
     default:
         TRACE(ERROR, _x("Invalid parameter: %X"), i_idx);
         return XA_API_FATAL_INVALID_CMD_TYPE;
@@ -0,0 +1,298 @@
+/*
+* Copyright (c) 2015-2021 Cadence Design Systems Inc.
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xaf-utils-test.h"
+#include "xaf-fio-test.h"
+#include "xf-pcm.h"
+
+#define PRINT_USAGE FIO_PRINTF(stdout, "\nUsage: %s [-iterations:N (default 100)]\n Checks the shared PCM kernels against a reference and reports their cost per 1000 samples\n\n", argv[0]);
+
+/* benchmark buffers hold up to 8 channels of 32-bit samples */
+#define PCM_BENCH_FRAMES        1024
+#define PCM_BENCH_MAX_CHANNELS  8
+#define PCM_BENCH_SAMPLES       (PCM_BENCH_FRAMES * PCM_BENCH_MAX_CHANNELS)
+#define PCM_BENCH_ITERATIONS    100
+
+unsigned int num_bytes_read, num_bytes_write;
+double strm_duration;
+
+/* Dummy unused functions */
+XA_ERRORCODE xa_mp3_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_aac_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_mixer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_pcm_gain(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_mp3_encoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_src_pp_fx(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_renderer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_capturer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_amr_wb_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_hotword_decoder(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value){return 0;}
+XA_ERRORCODE xa_vorbis_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_aec22(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_dummy_aec23(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_pcm_split(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_mimo_mix(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_dummy_wwd(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_hbuf(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_opus_encoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_wwd_msg(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_hbuf_msg(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+
+static WORD32 bench_src[PCM_BENCH_SAMPLES];
+static WORD32 bench_dst[PCM_BENCH_SAMPLES];
+static WORD32 bench_ref[PCM_BENCH_SAMPLES];
+static WORD32 bench_plane[PCM_BENCH_MAX_CHANNELS][PCM_BENCH_FRAMES];
+
+static int bench_iterations = PCM_BENCH_ITERATIONS;
+static int bench_failures;
+
+/* reference: sample i of a buffer as Q31 */
+static WORD32 ref_load(const void *p, UWORD32 width, UWORD32 i)
+{
+    switch (width)
+    {
+    case 8:
+        return ((const WORD8 *)p)[i] * (1 << 24);
+    case 16:
+        return ((const WORD16 *)p)[i] * (1 << 16);
+    case 24:
+        return ((const WORD32 *)p)[i] & XF_PCM_MASK_S24;
+    default:
+        return ((const WORD32 *)p)[i];
+    }
+}
+
+/* reference: store Q31 value as sample i of a buffer, truncating */
+static void ref_store(void *p, UWORD32 width, UWORD32 i, WORD32 v)
+{
+    switch (width)
+    {
+    case 8:
+        ((WORD8 *)p)[i] = (WORD8)(v >> 24);
+        break;
+    case 16:
+        ((WORD16 *)p)[i] = (WORD16)(v >> 16);
+        break;
+    case 24:
+        ((WORD32 *)p)[i] = v & XF_PCM_MASK_S24;
+        break;
+    default:
+        ((WORD32 *)p)[i] = v;
+        break;
+    }
+}
+
+/* fill source with full-scale noise, extremes included */
+static void bench_fill(void *p, UWORD32 width, UWORD32 n)
+{
+    UWORD32 seed = 0x12345678;
+    UWORD32 i;
+
+    for (i = 0; i < n; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        ref_store(p, width, i, (i & 63) == 0 ? (WORD32)0x7FFFFFFF : (i & 63) == 1 ? (WORD32)0x80000000 : (WORD32)seed);
+    }
+}
+
+static void bench_check(const char *name, const void *out, const void *ref, UWORD32 bytes)
+{
+    if (memcmp(out, ref, bytes))
+    {
+        FIO_PRINTF(stderr, "%-28s MISMATCH\n", name);
+        bench_failures++;
+    }
+}
+
+#ifdef XAF_PROFILE
+static clk_t bench_start;
+
+#define BENCH_START()   (bench_start = clk_read_start(CLK_SELN_THREAD))
+#define BENCH_STOP(name, n)                                                                 \
+    FIO_PRINTF(stdout, "%-28s %10lld\n", name,                                              \
+               clk_diff(clk_read_stop(CLK_SELN_THREAD), bench_start) * 1000 / ((clk_t)bench_iterations * (n)))
+#else
+#define BENCH_START()
+#define BENCH_STOP(name, n)
+#endif
+
+static void bench_convert(UWORD32 src_width, UWORD32 dst_width, UWORD32 n)
+{
+    char name[32];
+    UWORD32 i;
+    int k;
+
+    sprintf(name, "convert %u -> %u", src_width, dst_width);
+
+    bench_fill(bench_src, src_width, n);
+
+    for (i = 0; i < n; i++)
+        ref_store(bench_ref, dst_width, i, ref_load(bench_src, src_width, i));
+
+    BENCH_START();
+    for (k = 0; k < bench_iterations; k++)
+        xf_pcm_convert(bench_dst, dst_width, bench_src, src_width, n);
+    BENCH_STOP(name, n);
+
+    bench_check(name, bench_dst, bench_ref, n * xf_pcm_sample_size(dst_width));
+
+    /* ...in-place conversion gives the same result */
+    sprintf(name, "convert %u -> %u in place", src_width, dst_width);
+    memcpy(bench_dst, bench_src, n * xf_pcm_sample_size(src_width));
+    xf_pcm_convert(bench_dst, dst_width, bench_dst, src_width, n);
+    bench_check(name, bench_dst, bench_ref, n * xf_pcm_sample_size(dst_width));
+}
+
+static void bench_interleave(UWORD32 width, UWORD32 channels, UWORD32 frames)
+{
+    void *plane[PCM_BENCH_MAX_CHANNELS];
+    char name[32];
+    UWORD32 c;
+    int k;
+
+    for (c = 0; c < channels; c++)
+        plane[c] = bench_plane[c];
+
+    bench_fill(bench_src, width, channels * frames);
+
+    sprintf(name, "deinterleave %u x%u", width, channels);
+    BENCH_START();
+    for (k = 0; k < bench_iterations; k++)
+        xf_pcm_deinterleave(plane, bench_src, width, channels, frames);
+    BENCH_STOP(name, channels * frames);
+
+    sprintf(name, "interleave %u x%u", width, channels);
+    BENCH_START();
+    for (k = 0; k < bench_iterations; k++)
+        xf_pcm_interleave(bench_dst, (const void * const *)plane, width, channels, frames);
+    BENCH_STOP(name, channels * frames);
+
+    /* ...round trip gives the source back */
+    bench_check(name, bench_dst, bench_src, channels * frames * xf_pcm_sample_size(width));
+}
+
+static void bench_scale(UWORD32 width, UWORD16 gain, UWORD32 n)
+{
+    char name[32];
+    WORD64 v;
+    UWORD32 i;
+    int k;
+
+    sprintf(name, "scale %u x%u/4096", width, gain);
+
+    bench_fill(bench_src, width, n);
+
+    /* ...on Q31 values saturating at full scale matches saturating at the sample range */
+    for (i = 0; i < n; i++)
+    {
+        v = ((WORD64)ref_load(bench_src, width, i) * gain) >> 12;
+        ref_store(bench_ref, width, i, xf_pcm_sat32(v));
+    }
+
+    BENCH_START();
+    for (k = 0; k < bench_iterations; k++)
+        xf_pcm_scale(bench_dst, bench_src, width, n, gain);
+    BENCH_STOP(name, n);
+
+    bench_check(name, bench_dst, bench_ref, n * xf_pcm_sample_size(width));
+}
+
+static void bench_attenuate(UWORD32 width, UWORD32 shift, UWORD32 n)
+{
+    char name[32];
+    UWORD32 i;
+    int k;
+
+    sprintf(name, "attenuate %u >> %u", width, shift);
+
+    bench_fill(bench_src, width, n);
+
+    for (i = 0; i < n; i++)
+        ref_store(bench_ref, width, i, ref_load(bench_src, width, i) >> shift);
+
+    /* ...kernel works in place; time it on a scratch copy, check a single pass */
+    memcpy(bench_dst, bench_src, n * xf_pcm_sample_size(width));
+    BENCH_START();
+    for (k = 0; k < bench_iterations; k++)
+        xf_pcm_attenuate(bench_dst, width, n, shift);
+    BENCH_STOP(name, n);
+
+    memcpy(bench_dst, bench_src, n * xf_pcm_sample_size(width));
+    xf_pcm_attenuate(bench_dst, width, n, shift);
+    bench_check(name, bench_dst, bench_ref, n * xf_pcm_sample_size(width));
+}
+
+int main_task(int argc, char **argv)
+{
+    static const UWORD32 widths[] = { 8, 16, 24, 32 };
+    UWORD32 n = PCM_BENCH_FRAMES * 2;
+    int i, j;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strncmp(argv[i], "-iterations:", 12))
+        {
+            bench_iterations = atoi(argv[i] + 12);
+        }
+        else
+        {
+            PRINT_USAGE;
+            return -1;
+        }
+    }
+
+    if (bench_iterations <= 0)
+    {
+        PRINT_USAGE;
+        return -1;
+    }
+
+#ifdef XAF_PROFILE
+    clk_start();
+    FIO_PRINTF(stdout, "%-28s %10s\n", "kernel", "clk/1000");
+#endif
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < 4; j++)
+            if (i != j)
+                bench_convert(widths[i], widths[j], n);
+
+    for (i = 0; i < 4; i++)
+    {
+        bench_interleave(widths[i], 2, PCM_BENCH_FRAMES);
+        bench_interleave(widths[i], 6, PCM_BENCH_FRAMES);
+        bench_scale(widths[i], 0x2000, n);
+        bench_attenuate(widths[i], 1, n);
+    }
+
+#ifdef XAF_PROFILE
+    clk_stop();
+#endif
+
+    FIO_PRINTF(stdout, "%s: %d kernel mismatches\n", bench_failures ? "FAILED" : "PASSED", bench_failures);
+
+    return bench_failures ? -1 : 0;
+}
@@ -29,7 +29,7 @@
 #include "xaf-utils-test.h"
 #include "xaf-fio-test.h"
 
-#define PRINT_USAGE FIO_PRINTF(stdout, "\nUsage: %s -infile:in_filename.pcm -outfile:out_filename.pcm [optional -pcm_width:16 (default) or 8 or 24 or 32 ]\n For pcm_width:24, input and output samples are in the form of MSB aligned 32 bits\n\n", argv[0]);
+#define PRINT_USAGE FIO_PRINTF(stdout, "\nUsage: %s -infile:in_filename.pcm -outfile:out_filename.pcm [optional -pcm_width:16 (default) or 8 or 24 or 32 ] [optional -frag:bytes ] [optional -ramp:samples [-ramp_shape:0 (linear, default) or 1 (exponential)] ]\n For pcm_width:24, input and output samples are in the form of MSB aligned 32 bits\n -frag feeds input in fragments of given size and has component take it as scattered segments\n -ramp changes gain periodically while running, with ramps of given length (0 - step change)\n\n", argv[0]);
 
 #define AUDIO_FRMWK_BUF_SIZE   (256 << 8)
 #define AUDIO_COMP_BUF_SIZE    (1024 << 7)
@@ -50,6 +50,19 @@
 //following parameter is provided to simulate desired MHz load in PCM-GAIN for experiments
 #define PCM_GAIN_BURN_CYCLES    0
 
+//ramp mode changes gain every so many samples per channel (50ms at 44.1kHz);
+//ramps longer than that get retargeted before they end
+#define PCM_GAIN_RAMP_INTERVAL  2205
+
+//ramp mode cycles through these gain indices -> {+6db, -18db, +18db, -6db}
+static const int pcm_gain_ramp_idx[] = {4, 3, 6, 1};
+
+//gain of each index in Q12, as applied by the component
+static const int pcm_gain_q12[] = {4096, 2053, 1029, 516, 8173, 16306, 32536};
+
+//ramp check keeps this many input samples fed but not yet seen on output
+#define PCM_GAIN_CHECK_HIST     (1 << 15)
+
 unsigned int num_bytes_read, num_bytes_write;
 extern int audio_frmwk_buf_size;
 extern int audio_comp_buf_size;
@@ -57,6 +70,139 @@ double strm_duration;
 
 int g_pcm_width=0;
 
+/* ...gain ramp length in samples per channel, negative if ramp mode is off */
+int g_ramp_length = -1;
+int g_ramp_shape = XA_PCM_GAIN_RAMP_LINEAR;
+
+/* ...number of output samples the ramp check found wrong */
+int g_ramp_errors = 0;
+
+/* ...ramp mode output check, 16-bit samples only:
+ * - once a ramp is over, output is exactly the input at the target gain;
+ * - while ramping, gain moves by no more than a ramp step per frame, also
+ *   when a new gain retargets a ramp midway */
+typedef struct
+{
+    /* ...input samples fed, in a ring indexed by sample number */
+    short   hist[PCM_GAIN_CHECK_HIST];
+    int     fed;
+    int     checked;
+
+    /* ...samples per frame */
+    int     channels;
+
+    /* ...gain last set, and first sample at which it applies exactly */
+    int     target;
+    int     settled;
+
+    /* ...largest gain change per frame while ramping, Q12 */
+    int     max_step;
+
+    /* ...last gain estimate and the frame it comes from; frame < 0 - none */
+    int     last_gain;
+    int     last_frame;
+}   ramp_check_t;
+
+static ramp_check_t ramp_check;
+
+/* ...new gain is set before any input fed from now on, so it is fully
+ * applied within a ramp length from there */
+static void ramp_check_set(ramp_check_t *c, int idx)
+{
+    c->target = pcm_gain_q12[idx];
+    c->settled = c->fed + g_ramp_length * c->channels;
+}
+
+static void ramp_check_input(ramp_check_t *c, const short *p, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        c->hist[(c->fed + i) % PCM_GAIN_CHECK_HIST] = p[i];
+
+    c->fed += n;
+}
+
+static void ramp_check_output(ramp_check_t *c, const short *p, int n)
+{
+    int i, in, out, expected, gain, frame;
+
+    for (i = 0; i < n; i++, c->checked++)
+    {
+        if (c->fed - c->checked > PCM_GAIN_CHECK_HIST || c->checked >= c->fed)
+        {
+            if (g_ramp_errors++ < 8)
+            {
+                FIO_PRINTF(stderr, "Gain ramp check: output sample %d is out of input history\n", c->checked);
+            }
+            continue;
+        }
+
+        in = c->hist[c->checked % PCM_GAIN_CHECK_HIST];
+        out = p[i];
+
+        if (c->checked >= c->settled)
+        {
+            /* ...ramp is over; gain must be exactly the target */
+            expected = (in * c->target) >> 12;
+            expected = (expected > 32767 ? 32767 : (expected < -32768 ? -32768 : expected));
+
+            if (out != expected && g_ramp_errors++ < 8)
+            {
+                FIO_PRINTF(stderr, "Gain ramp check: sample %d is %d, expected %d at settled gain %d\n", c->checked, out, expected, c->target);
+            }
+        }
+
+        /* ...estimate gain where the sample is large and not saturated; the
+         * estimate is then off by less than two */
+        if (g_ramp_length == 0 || (in < 4096 && in > -4096) || out == 32767 || out == -32768)
+            continue;
+
+        gain = out * 4096 / in;
+        frame = c->checked / c->channels;
+
+        if (c->last_frame >= 0 && abs(gain - c->last_gain) > (frame - c->last_frame) * c->max_step + 4)
+        {
+            if (g_ramp_errors++ < 8)
+            {
+                FIO_PRINTF(stderr, "Gain ramp check: gain jumps from %d to %d between frames %d and %d\n", c->last_gain, gain, c->last_frame, frame);
+            }
+        }
+
+        c->last_gain = gain;
+        c->last_frame = frame;
+    }
+}
+
+static void ramp_check_init(ramp_check_t *c, xaf_format_t *format)
+{
+    int range = pcm_gain_q12[6] - pcm_gain_q12[3];
+    int shift;
+
+    memset(c, 0, sizeof(*c));
+    c->channels = format->channels;
+    c->target = pcm_gain_q12[PCM_GAIN_IDX_FOR_GAIN];
+    c->last_frame = -1;
+
+    if (g_ramp_length == 0)
+    {
+        c->max_step = range;
+    }
+    else if (g_ramp_shape == XA_PCM_GAIN_RAMP_LINEAR)
+    {
+        c->max_step = range / g_ramp_length + 1;
+    }
+    else
+    {
+        /* ...one-pole step as in the component, and the snap to target at
+         * ramp end, which is at most 1% of the gain change */
+        for (shift = 0; (5 << (shift + 1)) <= g_ramp_length; shift++);
+
+        c->max_step = (range >> shift) + 1;
+        c->max_step = (c->max_step > range / 100 + 1 ? c->max_step : range / 100 + 1);
+    }
+}
+
 #ifdef XAF_PROFILE
     extern long long tot_cycles, frmwk_cycles, fread_cycles, fwrite_cycles;
     extern long long dsp_comps_cycles, pcm_gain_cycles;
@@ -86,7 +232,7 @@ XA_ERRORCODE xa_dummy_hbuf_msg(xa_codec_handle_t var1, WORD32 var2, WORD32 var3,
 
 static int pcm_gain_setup(void *p_comp)
 {
-    int param[12];
+    int param[18];
     int pcm_width;
     int num_ch = PCM_GAIN_NUM_CH;                 // supports upto 16 channels
     int sample_rate = PCM_GAIN_SAMPLE_RATE;
@@ -110,8 +256,14 @@ static int pcm_gain_setup(void *p_comp)
     param[9] = gain_idx;
     param[10]= XA_PCM_GAIN_BURN_ADDITIONAL_CYCLES;
     param[11]= PCM_GAIN_BURN_CYCLES; 
-
-    return(xaf_comp_set_config(p_comp, 6, &param[0]));
+    param[12]= XA_PCM_GAIN_CONFIG_PARAM_INPUT_SEGMENTS;
+    param[13]= (g_read_chunk_size > 0);
+    param[14]= XA_PCM_GAIN_CONFIG_PARAM_RAMP_LENGTH;
+    param[15]= (g_ramp_length > 0 ? g_ramp_length : 0);
+    param[16]= XA_PCM_GAIN_CONFIG_PARAM_RAMP_SHAPE;
+    param[17]= g_ramp_shape;
+
+    return(xaf_comp_set_config(p_comp, 9, &param[0]));
 }
 
 static int get_comp_config(void *p_comp, xaf_format_t *comp_format)
@@ -144,6 +296,109 @@ void fio_quit()
     return;
 }
 
+/* ...ramp mode processing; changes gain while the component runs, so that
+ * ramps start from a steady gain as well as from the middle of another ramp */
+static long _ramp_process_entry(void *arg)
+{
+    void *p_adev, *p_comp;
+    void *p_input, *p_output;
+    xaf_comp_status comp_status;
+    long comp_info[4];
+    int input_over = 0, read_length;
+    int frame_bytes, fed = 0, next = 0, changes = 0;
+    int param[2];
+    xaf_format_t *format;
+    void * (*arg_arr)[10];
+
+    TST_CHK_PTR(arg, "ramp_process_entry");
+
+    arg_arr = arg;
+    p_adev = (*arg_arr)[0];
+    p_comp = (*arg_arr)[1];
+    p_input = (*arg_arr)[2];
+    p_output = (*arg_arr)[3];
+    format = (xaf_format_t *)(*arg_arr)[7];
+
+    /* ...bytes per sample of all channels; 24-bit samples take 32 bits */
+    frame_bytes = format->channels * (format->pcm_width == 24 ? 4 : format->pcm_width >> 3);
+
+    ramp_check_init(&ramp_check, format);
+
+    TST_CHK_API(xaf_comp_process(NULL, p_comp, NULL, 0, XAF_EXEC_FLAG), "xaf_comp_process");
+
+    while (1)
+    {
+        TST_CHK_API(xaf_comp_get_status(NULL, p_comp, &comp_status, &comp_info[0]), "xaf_comp_get_status");
+
+        if (comp_status == XAF_EXEC_DONE) break;
+
+        if (comp_status == XAF_NEED_INPUT && !input_over)
+        {
+            /* ...new gain applies from input fed next */
+            if (fed >= next)
+            {
+                param[0] = XA_PCM_GAIN_CONFIG_PARAM_GAIN_FACTOR;
+                param[1] = pcm_gain_ramp_idx[changes++ % (sizeof(pcm_gain_ramp_idx) / sizeof(pcm_gain_ramp_idx[0]))];
+                TST_CHK_API(xaf_comp_set_config(p_comp, 1, &param[0]), "xaf_comp_set_config");
+                ramp_check_set(&ramp_check, param[1]);
+
+                next += PCM_GAIN_RAMP_INTERVAL * frame_bytes;
+            }
+
+            TST_CHK_API(read_input((void *)comp_info[0], comp_info[1], &read_length, p_input, XAF_POST_PROC), "read_input");
+
+            if (read_length)
+            {
+                if (format->pcm_width == 16)
+                    ramp_check_input(&ramp_check, (short *)comp_info[0], read_length >> 1);
+
+                TST_CHK_API(xaf_comp_process(NULL, p_comp, (void *)comp_info[0], read_length, XAF_INPUT_READY_FLAG), "xaf_comp_process");
+                fed += read_length;
+            }
+            else
+            {
+                TST_CHK_API(xaf_comp_process(NULL, p_comp, NULL, 0, XAF_INPUT_OVER_FLAG), "xaf_comp_process");
+                input_over = 1;
+            }
+        }
+
+        if (comp_status == XAF_OUTPUT_READY)
+        {
+            if (format->pcm_width == 16)
+                ramp_check_output(&ramp_check, (short *)comp_info[0], comp_info[1] >> 1);
+
+            TST_CHK_API(consume_output((void *)comp_info[0], comp_info[1], p_output, XAF_POST_PROC), "consume_output");
+            TST_CHK_API(xaf_comp_process(NULL, p_comp, (void *)comp_info[0], comp_info[1], XAF_NEED_OUTPUT_FLAG), "xaf_comp_process");
+        }
+    }
+
+    FIO_PRINTF(stdout, "Gain ramp: %s, %d samples, %d gain changes\n",
+               (g_ramp_shape == XA_PCM_GAIN_RAMP_EXPONENTIAL ? "exponential" : "linear"), g_ramp_length, changes);
+
+    if (format->pcm_width != 16)
+    {
+        FIO_PRINTF(stdout, "Gain ramp check: skipped, 16-bit samples only\n");
+    }
+    else if (g_ramp_errors || ramp_check.checked != ramp_check.fed)
+    {
+        FIO_PRINTF(stdout, "Gain ramp check: FAILED, %d errors, %d of %d samples checked\n", g_ramp_errors, ramp_check.checked, ramp_check.fed);
+    }
+    else
+    {
+        FIO_PRINTF(stdout, "Gain ramp check: PASSED, %d samples\n", ramp_check.checked);
+    }
+
+    if (ramp_check.checked != ramp_check.fed)
+        g_ramp_errors++;
+
+    return 0;
+}
+
+static void *ramp_process_entry(void *arg)
+{
+    return (void *)_ramp_process_entry(arg);
+}
+
 int main_task(int argc, char **argv)
 {
 
@@ -155,7 +410,7 @@ int main_task(int argc, char **argv)
     xaf_comp_status pcm_gain_status;
     int pcm_gain_info[4];
     char *filename_ptr;
-    void *pcm_gain_thread_args[NUM_THREAD_ARGS];
+    void *pcm_gain_thread_args[NUM_THREAD_ARGS + 1];
     FILE *fp, *ofp;
     void *pcm_gain_inbuf[2];
     int buf_length = XAF_INBUF_SIZE;
@@ -205,7 +460,7 @@ int main_task(int argc, char **argv)
     TRACE_INIT("Xtensa Audio Framework - \'PCM Gain\' Sample App");
 
     /* ...check input arguments */
-    if (argc < 3 || argc > 4)
+    if (argc < 3 || argc > 7)
     {
         PRINT_USAGE;
         return 0;
@@ -263,11 +518,11 @@ int main_task(int argc, char **argv)
         PRINT_USAGE;
         return 0;
     }
-    if(argc == 4)
+    for (i = 3; i < argc; i++)
     {
-        if(NULL != strstr(argv[3], "-pcm_width:" ))
+        if(NULL != strstr(argv[i], "-pcm_width:" ))
         {
-            char *pcm_width_ptr = (char *)&(argv[3][11]);
+            char *pcm_width_ptr = (char *)&(argv[i][11]);
         
             if((*pcm_width_ptr) == '\0')
             {
@@ -276,6 +531,38 @@ int main_task(int argc, char **argv)
             }
             g_pcm_width = atoi(pcm_width_ptr);
         }
+        else if(NULL != strstr(argv[i], "-ramp_shape:" ))
+        {
+            g_ramp_shape = atoi(&(argv[i][12]));
+
+            if((g_ramp_shape != XA_PCM_GAIN_RAMP_LINEAR) && (g_ramp_shape != XA_PCM_GAIN_RAMP_EXPONENTIAL))
+            {
+                FIO_PRINTF(stderr, "Unknown ramp shape %d\n", g_ramp_shape);
+                exit(-1);
+            }
+        }
+        else if(NULL != strstr(argv[i], "-ramp:" ))
+        {
+            /* ...zero length keeps gain changes, but makes them at once */
+            g_ramp_length = atoi(&(argv[i][6]));
+
+            if(g_ramp_length < 0)
+            {
+                FIO_PRINTF(stderr, "Ramp length is not valid\n");
+                exit(-1);
+            }
+        }
+        else if(NULL != strstr(argv[i], "-frag:" ))
+        {
+            /* ...fragments smaller than a frame make framework gather them */
+            g_read_chunk_size = atoi(&(argv[i][6]));
+
+            if(g_read_chunk_size <= 0)
+            {
+                FIO_PRINTF(stderr, "Fragment size is not provided\n");
+                exit(-1);
+            }
+        }
         else
         {
             PRINT_USAGE;
@@ -364,9 +651,10 @@ int main_task(int argc, char **argv)
     pcm_gain_thread_args[4] = &comp_type;
     pcm_gain_thread_args[5] = (void *)comp_id;
     pcm_gain_thread_args[6] = (void *)&i;   //dummy
+    pcm_gain_thread_args[7] = &pcm_gain_format;
 
     /* ...init done, begin execution thread */
-    __xf_thread_create(&pcm_gain_thread, comp_process_entry, &pcm_gain_thread_args[0], "Pcm Gain Thread", pcm_gain_stack, STACK_SIZE, XAF_APP_THREADS_PRIORITY);
+    __xf_thread_create(&pcm_gain_thread, (g_ramp_length < 0 ? comp_process_entry : ramp_process_entry), &pcm_gain_thread_args[0], "Pcm Gain Thread", pcm_gain_stack, STACK_SIZE, XAF_APP_THREADS_PRIORITY);
 
     __xf_thread_join(&pcm_gain_thread, NULL);
 
@@ -416,6 +704,6 @@ int main_task(int argc, char **argv)
     /* ...deinitialize tracing facility */
     TRACE_DEINIT();
 
-    return 0;
+    return (g_ramp_errors ? -1 : 0);
 }
 
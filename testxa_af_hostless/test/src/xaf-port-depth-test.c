@@ -0,0 +1,367 @@
+/*
+* Copyright (c) 2015-2021 Cadence Design Systems Inc.
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "audio/xa-pcm-gain-api.h"
+#include "xaf-utils-test.h"
+#include "xaf-fio-test.h"
+
+#define PRINT_USAGE FIO_PRINTF(stdout, "\nUsage: %s -infile:in_filename.pcm -outfile:out_filename.pcm\n Feeds PCM GAIN0 -> PCM GAIN1 over an adaptive route in bursts and checks the route depth grows\n\n", argv[0]);
+
+#define AUDIO_FRMWK_BUF_SIZE   (256 << 8)
+#define AUDIO_COMP_BUF_SIZE    (1024 << 7)
+
+enum {
+    XA_GAIN0 = 0,
+    XA_GAIN1 = 1,
+    NUM_COMP_IN_GRAPH,
+};
+
+//component parameters
+#define PCM_GAIN_SAMPLE_WIDTH   16
+#define PCM_GAIN_NUM_CH         1
+#define PCM_GAIN_SAMPLE_RATE    44100
+
+//first gain matches xaf-pcm-gain-test (-6dB), second one passes data through (0dB)
+#define PCM_GAIN0_IDX_FOR_GAIN  1
+#define PCM_GAIN1_IDX_FOR_GAIN  0
+
+//second gain is made slower, so the first one runs out of route buffers within a burst
+#define PCM_GAIN1_BURN_CYCLES   200000
+
+//route starts with 2 buffers and may grow up to the limit
+#define PORT_DEPTH_MIN          2
+#define PORT_DEPTH_MAX          6
+
+//input comes in bursts of frames; the pause lets second gain drain the route
+#define BURST_FRAMES            8
+#define BURST_PAUSE_MSEC        50
+
+unsigned int num_bytes_read, num_bytes_write;
+extern int audio_frmwk_buf_size;
+extern int audio_comp_buf_size;
+double strm_duration;
+
+#ifdef XAF_PROFILE
+    extern long long tot_cycles, frmwk_cycles, fread_cycles, fwrite_cycles;
+    extern long long dsp_comps_cycles, pcm_gain_cycles;
+    extern double dsp_mcps;
+#endif
+
+/* Dummy unused functions */
+XA_ERRORCODE xa_mp3_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_aac_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_mixer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_mp3_encoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_src_pp_fx(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_renderer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_capturer(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_amr_wb_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_hotword_decoder(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value){return 0;}
+XA_ERRORCODE xa_vorbis_decoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_aec22(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_dummy_aec23(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_pcm_split(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_mimo_mix(xa_codec_handle_t p_xa_module_obj, WORD32 i_cmd, WORD32 i_idx, pVOID pv_value) {return 0;}
+XA_ERRORCODE xa_dummy_wwd(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_hbuf(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_opus_encoder(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_wwd_msg(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+XA_ERRORCODE xa_dummy_hbuf_msg(xa_codec_handle_t var1, WORD32 var2, WORD32 var3, pVOID var4){return 0;}
+
+static int pcm_gain_setup(void *p_comp, int gain_idx, int burn_cycles)
+{
+    int param[12];
+    int num_param = 5;
+
+    param[0] = XA_PCM_GAIN_CONFIG_PARAM_CHANNELS;
+    param[1] = PCM_GAIN_NUM_CH;
+    param[2] = XA_PCM_GAIN_CONFIG_PARAM_SAMPLE_RATE;
+    param[3] = PCM_GAIN_SAMPLE_RATE;
+    param[4] = XA_PCM_GAIN_CONFIG_PARAM_PCM_WIDTH;
+    param[5] = PCM_GAIN_SAMPLE_WIDTH;
+    param[6] = XA_PCM_GAIN_CONFIG_PARAM_FRAME_SIZE;
+    param[7] = XAF_INBUF_SIZE;
+    param[8] = XA_PCM_GAIN_CONFIG_PARAM_GAIN_FACTOR;
+    param[9] = gain_idx;
+
+    /* ...burn cycles parameter takes non-zero values only */
+    if (burn_cycles)
+    {
+        param[10] = XA_PCM_GAIN_BURN_ADDITIONAL_CYCLES;
+        param[11] = burn_cycles;
+        num_param++;
+    }
+
+    return(xaf_comp_set_config(p_comp, num_param, &param[0]));
+}
+
+static int get_port_depth(void *p_comp, int port, int *depth)
+{
+    int param[2];
+    int ret;
+
+    param[0] = XAF_PORT_DEPTH(port);
+
+    ret = xaf_comp_get_config(p_comp, 1, &param[0]);
+    if(ret < 0)
+        return ret;
+
+    *depth = param[1];
+
+    return 0;
+}
+
+void fio_quit()
+{
+    return;
+}
+
+/* ...feed source component in bursts; it idles between them, so its sink drains the route */
+static long _burst_feed_entry(void *arg)
+{
+    void *p_adev, *p_comp;
+    void *p_input;
+    xaf_comp_status comp_status;
+    long comp_info[4];
+    int read_length, frames = 0;
+    void * (*arg_arr)[10];
+
+    TST_CHK_PTR(arg, "burst_feed_entry");
+
+    arg_arr = arg;
+    p_adev = (*arg_arr)[0];
+    p_comp = (*arg_arr)[1];
+    p_input = (*arg_arr)[2];
+
+    TST_CHK_API(xaf_comp_process(NULL, p_comp, NULL, 0, XAF_EXEC_FLAG), "xaf_comp_process");
+
+    while (1)
+    {
+        TST_CHK_API(xaf_comp_get_status(NULL, p_comp, &comp_status, &comp_info[0]), "xaf_comp_get_status");
+
+        if (comp_status == XAF_EXEC_DONE) break;
+
+        if (comp_status == XAF_NEED_INPUT)
+        {
+            TST_CHK_API(read_input((void *)comp_info[0], comp_info[1], &read_length, p_input, XAF_POST_PROC), "read_input");
+
+            if (read_length)
+            {
+                TST_CHK_API(xaf_comp_process(NULL, p_comp, (void *)comp_info[0], read_length, XAF_INPUT_READY_FLAG), "xaf_comp_process");
+
+                if (++frames % BURST_FRAMES == 0)
+                {
+                    __xf_thread_sleep_msec(BURST_PAUSE_MSEC);
+                }
+            }
+            else
+            {
+                TST_CHK_API(xaf_comp_process(NULL, p_comp, NULL, 0, XAF_INPUT_OVER_FLAG), "xaf_comp_process");
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void *burst_feed_entry(void *arg)
+{
+    return (void *)_burst_feed_entry(arg);
+}
+
+int main_task(int argc, char **argv)
+{
+    void *p_adev = NULL;
+    void *p_input = NULL, *p_output = NULL;
+    void *p_comp[NUM_COMP_IN_GRAPH];
+    xf_thread_t comp_thread[NUM_COMP_IN_GRAPH];
+    unsigned char comp_stack[NUM_COMP_IN_GRAPH][STACK_SIZE];
+    void *comp_thread_args[NUM_COMP_IN_GRAPH][NUM_THREAD_ARGS];
+    int comp_cid[NUM_COMP_IN_GRAPH] = {XA_GAIN0, XA_GAIN1};
+    xaf_comp_type comp_type = XAF_POST_PROC;
+    xaf_comp_status comp_status;
+    int comp_info[4];
+    void *pcm_gain_inbuf[2];
+    int read_length;
+    int depth_start, depth_end;
+    int i, failed = 0;
+    pUWORD8 ver_info[3] = {0,0,0};    //{ver,lib_rev,api_rev}
+    unsigned short board_id = 0;
+    mem_obj_t* mem_handle;
+
+    audio_frmwk_buf_size = AUDIO_FRMWK_BUF_SIZE;
+    audio_comp_buf_size = AUDIO_COMP_BUF_SIZE;
+
+    // NOTE: set_wbna() should be called before any other dynamic
+    // adjustment of the region attributes for cache.
+    set_wbna(&argc, argv);
+
+    /* ...start xos */
+    board_id = start_rtos();
+
+   /* ...get xaf version info*/
+    TST_CHK_API(xaf_get_verinfo(ver_info), "xaf_get_verinfo");
+
+    /* ...show xaf version info*/
+    TST_CHK_API(print_verinfo(ver_info,(pUWORD8)"\'Port Depth\'"), "print_verinfo");
+
+    /* ...initialize tracing facility */
+    TRACE_INIT("Xtensa Audio Framework - \'Port Depth\' Sample App");
+
+    /* ...check input arguments */
+    if (argc != 3 || strncmp(argv[1], "-infile:", 8) || strncmp(argv[2], "-outfile:", 9))
+    {
+        PRINT_USAGE;
+        return 0;
+    }
+
+    if ((p_input = fio_fopen(&argv[1][8], "rb")) == NULL)
+    {
+       FIO_PRINTF(stderr, "Failed to open '%s': %d\n", &argv[1][8], errno);
+       exit(-1);
+    }
+
+    if ((p_output = fio_fopen(&argv[2][9], "wb")) == NULL)
+    {
+       FIO_PRINTF(stderr, "Failed to open '%s': %d\n", &argv[2][9], errno);
+       exit(-1);
+    }
+
+    mem_handle = mem_init();
+
+    xaf_adev_config_t adev_config;
+    TST_CHK_API(xaf_adev_config_default_init(&adev_config), "xaf_adev_config_default_init");
+
+    adev_config.pmem_malloc =  mem_malloc;
+    adev_config.pmem_free =  mem_free;
+    adev_config.audio_framework_buffer_size =  audio_frmwk_buf_size;
+    adev_config.audio_component_buffer_size =  audio_comp_buf_size;
+    TST_CHK_API(xaf_adev_open(&p_adev, &adev_config),  "xaf_adev_open");
+
+    FIO_PRINTF(stdout,"Audio Device Ready\n");
+
+    /* ...first gain takes input from application, second one gives output to it */
+    TST_CHK_API_COMP_CREATE(p_adev, &p_comp[XA_GAIN0], "post-proc/pcm_gain", 2, 0, &pcm_gain_inbuf[0], comp_type, "xaf_comp_create");
+    TST_CHK_API(pcm_gain_setup(p_comp[XA_GAIN0], PCM_GAIN0_IDX_FOR_GAIN, 0), "pcm_gain_setup");
+
+    TST_CHK_API_COMP_CREATE(p_adev, &p_comp[XA_GAIN1], "post-proc/pcm_gain", 0, 1, NULL, comp_type, "xaf_comp_create");
+    TST_CHK_API(pcm_gain_setup(p_comp[XA_GAIN1], PCM_GAIN1_IDX_FOR_GAIN, PCM_GAIN1_BURN_CYCLES), "pcm_gain_setup");
+
+    /* ...non XAF_DECODER type components do not need initial input data to initialize */
+    for (i = 0; i < NUM_COMP_IN_GRAPH; i++)
+    {
+        TST_CHK_API(xaf_comp_process(p_adev, p_comp[i], NULL, 0, XAF_START_FLAG), "xaf_comp_process");
+        TST_CHK_API(xaf_comp_get_status(p_adev, p_comp[i], &comp_status, &comp_info[0]), "xaf_comp_get_status");
+
+        if (comp_status != XAF_INIT_DONE)
+        {
+            FIO_PRINTF(stderr, "Failed to init\n");
+            exit(-1);
+        }
+    }
+
+    TST_CHK_API(xaf_connect_adaptive(p_comp[XA_GAIN0], 1, p_comp[XA_GAIN1], 0, PORT_DEPTH_MAX), "xaf_connect_adaptive");
+
+    /* ...adaptive route starts with minimal depth */
+    TST_CHK_API(get_port_depth(p_comp[XA_GAIN0], 1, &depth_start), "get_port_depth");
+
+    /* ...start feeding input data after the pipeline is setup */
+    for (i=0; i<2; i++)
+    {
+        TST_CHK_API(read_input(pcm_gain_inbuf[i], XAF_INBUF_SIZE, &read_length, p_input, comp_type), "read_input");
+
+        if (read_length)
+            TST_CHK_API(xaf_comp_process(p_adev, p_comp[XA_GAIN0], pcm_gain_inbuf[i], read_length, XAF_INPUT_READY_FLAG), "xaf_comp_process");
+        else
+        {
+            TST_CHK_API(xaf_comp_process(p_adev, p_comp[XA_GAIN0], NULL, 0, XAF_INPUT_OVER_FLAG), "xaf_comp_process");
+            break;
+        }
+    }
+
+    for (i = 0; i < NUM_COMP_IN_GRAPH; i++)
+    {
+        comp_thread_args[i][0] = p_adev;
+        comp_thread_args[i][1] = p_comp[i];
+        comp_thread_args[i][2] = (i == XA_GAIN0 ? p_input : NULL);
+        comp_thread_args[i][3] = (i == XA_GAIN1 ? p_output : NULL);
+        comp_thread_args[i][4] = &comp_type;
+        comp_thread_args[i][5] = (void *)"post-proc/pcm_gain";
+        comp_thread_args[i][6] = (void *)&comp_cid[i];
+    }
+
+    __xf_thread_create(&comp_thread[XA_GAIN0], burst_feed_entry, comp_thread_args[XA_GAIN0], "Gain0 Burst Thread", comp_stack[XA_GAIN0], STACK_SIZE, XAF_APP_THREADS_PRIORITY);
+    __xf_thread_create(&comp_thread[XA_GAIN1], comp_process_entry, comp_thread_args[XA_GAIN1], "Gain1 Thread", comp_stack[XA_GAIN1], STACK_SIZE, XAF_APP_THREADS_PRIORITY);
+
+    for (i = 0; i < NUM_COMP_IN_GRAPH; i++)
+    {
+        __xf_thread_join(&comp_thread[i], NULL);
+    }
+
+    /* ...depth reached is kept after stream is over */
+    TST_CHK_API(get_port_depth(p_comp[XA_GAIN0], 1, &depth_end), "get_port_depth");
+
+    FIO_PRINTF(stdout, "route depth: %d at start, %d at end, %d max\n", depth_start, depth_end, PORT_DEPTH_MAX);
+
+    if (depth_start != PORT_DEPTH_MIN)
+    {
+        FIO_PRINTF(stderr, "route does not start with %d buffers\n", PORT_DEPTH_MIN);
+        failed = 1;
+    }
+
+    if (depth_end <= depth_start || depth_end > PORT_DEPTH_MAX)
+    {
+        FIO_PRINTF(stderr, "route did not grow within limit\n");
+        failed = 1;
+    }
+
+    for (i = 0; i < NUM_COMP_IN_GRAPH; i++)
+    {
+        __xf_thread_destroy(&comp_thread[i]);
+    }
+
+    TST_CHK_API(xaf_comp_delete(p_comp[XA_GAIN0]), "xaf_comp_delete");
+    TST_CHK_API(xaf_comp_delete(p_comp[XA_GAIN1]), "xaf_comp_delete");
+    TST_CHK_API(xaf_adev_close(p_adev, XAF_ADEV_NORMAL_CLOSE), "xaf_adev_close");
+    FIO_PRINTF(stdout,"Audio device closed\n\n");
+
+    mem_exit();
+
+    TST_CHK_API(print_mem_mcps_info(mem_handle, NUM_COMP_IN_GRAPH), "print_mem_mcps_info");
+
+    if (p_input)  fio_fclose(p_input);
+    if (p_output) fio_fclose(p_output);
+
+    fio_quit();
+
+    /* ...deinitialize tracing facility */
+    TRACE_DEINIT();
+
+    FIO_PRINTF(stdout, "%s\n", failed ? "FAILED" : "PASSED");
+
+    return failed ? -1 : 0;
+}
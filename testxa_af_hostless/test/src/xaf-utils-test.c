@@ -41,6 +41,7 @@ xf_thread_t g_disconnect_thread;
 int g_disc_thread_args[5];
 
 int g_execution_abort_flag = 0;
+int g_read_chunk_size = 0;
 event_list_t *g_event_list = NULL;
 xa_app_event_handler_fxn_t *g_app_handler_fn;
 UWORD32 worker_thread_scratch_size[XAF_MAX_WORKER_THREADS];
@@ -209,6 +210,11 @@ int read_input(void *p_buf, int buf_length, int *read_length, void *p_input, xaf
     TST_CHK_PTR(read_length, "read_input");
     TST_CHK_PTR(p_input, "read_input");
     FILE *fp = p_input;
+
+    /* ...optionally feed input in chunks smaller than the buffer */
+    if ((g_read_chunk_size > 0) && (buf_length > g_read_chunk_size))
+        buf_length = g_read_chunk_size;
+
     *read_length = fio_fread(p_buf, 1, buf_length, fp);
 
     if((comp_type == XAF_ENCODER) || (mcps_p_input == fp))
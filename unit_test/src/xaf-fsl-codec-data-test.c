@@ -0,0 +1,214 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Codec data test: opens a raw AAC decoder through the DSP wrapper library
+ * with an AudioSpecificConfig as codec data, then decodes framed access
+ * units. Checks the codec data goes to DSP on its own ahead of the stream,
+ * without consuming any stream input, and that DSP consumes exactly the
+ * codec data plus the stream.
+ *
+ * Against a wrapper built with LOOPBACK=1 the access units are synthetic
+ * ("make codec-data-loopback").
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <dlfcn.h>
+
+#include "xa_type_def.h"
+#include "fsl_unia.h"
+
+#ifdef TGT_OS_ANDROID
+#define WRAP_LIB_PATH   "/vendor/lib/lib_dsp_wrap_arm_android.so"
+#else
+#define WRAP_LIB_PATH   "/usr/lib/imx-mm/audio-codec/wrap/lib_dsp_wrap_arm_elinux.so"
+#endif
+
+#define NUM_FRAMES      16
+#define FRAME_BYTES     371
+/* ...give up on a frame after this many calls without progress */
+#define MAX_STALLS      1000
+
+/* ...AAC LC, 44.1 kHz, stereo */
+static UWORD8 asc[] = { 0x12, 0x10 };
+
+struct unia_api {
+	UniACodecCreatePlus create;
+	UniACodecDelete delete;
+	UniACodecSetParameter set_para;
+	UniACodecGetParameter get_para;
+	UniACodec_decode_frame decode;
+};
+
+static void help_info(void)
+{
+	printf("\n\n**************************************************\n");
+	printf("* Codec data test for DSP wrapper\n");
+	printf("* Usage: dsp_codec_data_test.out [options]\n");
+	printf("* Options :\n\n");
+	printf("          -l Library    Wrapper library (default %s)\n", WRAP_LIB_PATH);
+	printf("**************************************************\n\n");
+}
+
+static void *test_calloc(UWORD32 num, UWORD32 size)
+{
+	return calloc(num, size);
+}
+
+static void *test_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void test_free(void *ptr)
+{
+	free(ptr);
+}
+
+static void *test_realloc(void *ptr, UWORD32 size)
+{
+	return realloc(ptr, size);
+}
+
+static UniACodecMemoryOps mem_ops = {
+	.Calloc = test_calloc,
+	.Malloc = test_malloc,
+	.Free = test_free,
+	.ReAlloc = test_realloc,
+};
+
+static int load_api(const char *path, struct unia_api *api)
+{
+	tUniACodecQueryInterface query;
+	void *lib;
+
+	lib = dlopen(path, RTLD_NOW);
+	if (!lib) {
+		fprintf(stderr, "dlopen %s: %s\n", path, dlerror());
+		return -ENOENT;
+	}
+
+	query = (tUniACodecQueryInterface)dlsym(lib, "UniACodecQueryInterface");
+	if (!query) {
+		fprintf(stderr, "no UniACodecQueryInterface in %s\n", path);
+		return -ENOENT;
+	}
+
+	query(ACODEC_API_CREATE_CODEC_PLUS, (void **)&api->create);
+	query(ACODEC_API_DELETE_CODEC, (void **)&api->delete);
+	query(ACODEC_API_SET_PARAMETER, (void **)&api->set_para);
+	query(ACODEC_API_GET_PARAMETER, (void **)&api->get_para);
+	query(ACODEC_API_DEC_FRAME, (void **)&api->decode);
+
+	if (!api->create || !api->delete || !api->set_para ||
+	    !api->get_para || !api->decode)
+		return -ENOSYS;
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *lib_path = WRAP_LIB_PATH;
+	UniACodec_Handle handle;
+	UniACodecParameter para;
+	struct unia_api api;
+	UWORD8 frame[FRAME_BYTES];
+	UWORD8 *out, *pout;
+	UWORD32 offset, out_size, expected;
+	int i, stalls, frames = 0, calls = 0;
+	int ret, failed = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] == '-' && argv[i][1] == 'l') {
+			lib_path = argv[i] + 2;
+		} else {
+			help_info();
+			return 0;
+		}
+	}
+
+	memset(&api, 0, sizeof(api));
+	ret = load_api(lib_path, &api);
+	if (ret)
+		return ret;
+
+	handle = api.create(&mem_ops, AAC);
+	if (!handle) {
+		fprintf(stderr, "create failed\n");
+		return -ENODEV;
+	}
+
+	para.stream_type = STREAM_RAW;
+	api.set_para(handle, UNIA_STREAM_TYPE, &para);
+	para.framed = true;
+	api.set_para(handle, UNIA_FRAMED, &para);
+	para.codecData.buf = (char *)asc;
+	para.codecData.size = sizeof(asc);
+	api.set_para(handle, UNIA_CODEC_DATA, &para);
+
+	api.get_para(handle, UNIA_OUTBUF_ALLOC_SIZE, &para);
+	out = malloc(para.outbuf_alloc_size);
+	if (!out) {
+		api.delete(handle);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < NUM_FRAMES; i++) {
+		memset(frame, i, sizeof(frame));
+		offset = 0;
+
+		for (stalls = 0; offset < FRAME_BYTES && stalls < MAX_STALLS; stalls++) {
+			UWORD32 last = offset;
+
+			pout = out;
+			out_size = 0;
+			ret = api.decode(handle, frame, FRAME_BYTES, &offset, &pout, &out_size);
+			if (out_size)
+				frames++;
+
+			/* ...first call only carries codec data */
+			if (calls++ == 0 && offset != 0) {
+				fprintf(stderr, "codec data sent along with %u stream bytes\n", offset);
+				failed++;
+			}
+			if ((ret & 0xff) && (ret & 0xff) != ACODEC_NO_OUTPUT) {
+				fprintf(stderr, "frame %d: decode error 0x%x\n", i, ret);
+				failed++;
+				break;
+			}
+			if (offset != last)
+				stalls = 0;
+		}
+		if (offset < FRAME_BYTES) {
+			fprintf(stderr, "frame %d: stuck at %u bytes\n", i, offset);
+			failed++;
+			break;
+		}
+	}
+
+	/* ...DSP takes codec data once and every stream byte once */
+	expected = sizeof(asc) + NUM_FRAMES * FRAME_BYTES;
+	api.get_para(handle, UNIA_CONSUMED_LENGTH, &para);
+	if (!failed && para.consumed_length != expected) {
+		fprintf(stderr, "DSP consumed %u bytes, expected %u\n",
+			para.consumed_length, expected);
+		failed++;
+	}
+	if (!failed && !frames) {
+		fprintf(stderr, "no output\n");
+		failed++;
+	}
+
+	api.delete(handle);
+	free(out);
+
+	printf("%d frames in, %d out, %d calls, %s\n", NUM_FRAMES, frames, calls,
+	       failed ? "FAILED" : "PASSED");
+
+	return failed ? -EIO : 0;
+}
@@ -0,0 +1,416 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Decoder throughput benchmark: decodes a corpus of files through the DSP
+ * wrapper library (the UniACodec API used by the multimedia framework) and
+ * reports per file:
+ *   - frames per second and x real-time
+ *   - AP CPU time of the whole process, proxy thread included
+ *   - IPC messages sent to DSP per decoded frame
+ *   - wall clock latency percentiles of the decode call
+ * With -j every result is also written as one JSON object per line for
+ * regression tracking.
+ *
+ * Against a wrapper built with LOOPBACK=1 the DSP is emulated and every
+ * input buffer decodes to a silent frame, so CI without a DSP still tracks
+ * the AP side and IPC cost ("make bench-loopback").
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <dlfcn.h>
+
+#include "xa_type_def.h"
+#include "fsl_unia.h"
+
+#ifdef TGT_OS_ANDROID
+#define WRAP_LIB_PATH   "/vendor/lib/lib_dsp_wrap_arm_android.so"
+#else
+#define WRAP_LIB_PATH   "/usr/lib/imx-mm/audio-codec/wrap/lib_dsp_wrap_arm_elinux.so"
+#endif
+
+#define BENCH_RUNS      1
+/* ...give up on a file after this many calls without progress */
+#define MAX_STALLS      1000
+
+struct bench_codec {
+	const char *name;
+	AUDIOFORMAT format;
+	STREAM_TYPE stream_type;
+};
+
+static const struct bench_codec codec_list[] = {
+	{ "mp3",     MP3,      STREAM_UNKNOW },
+	{ "mp2",     MP2,      STREAM_UNKNOW },
+	{ "aac",     AAC,      STREAM_ADTS },
+	{ "aacplus", AAC_PLUS, STREAM_ADTS },
+	{ "ac3",     AC3,      STREAM_UNKNOW },
+	{ "ddp",     DD_PLUS,  STREAM_UNKNOW },
+	{ "ogg",     OGG,      STREAM_UNKNOW },
+	{ "nbamr",   NBAMR,    STREAM_NBAMR_MMSIO },
+	{ "wbamr",   WBAMR,    STREAM_WBAMR_MIME },
+	{ "bsac",    BSAC,     STREAM_UNKNOW },
+	{ "dabplus", DAB_PLUS, STREAM_UNKNOW },
+	{ "sbc",     SBCDEC,   STREAM_UNKNOW },
+};
+
+#define NUM_CODECS (sizeof(codec_list) / sizeof(codec_list[0]))
+
+struct unia_api {
+	UniACodecCreatePlus create;
+	UniACodecDelete delete;
+	UniACodecSetParameter set_para;
+	UniACodecGetParameter get_para;
+	UniACodec_decode_frame decode;
+};
+
+struct bench_result {
+	UWORD32 frames;
+	UWORD32 calls;
+	UWORD32 errors;
+	double audio_s;
+	double wall_s;
+	double cpu_s;
+	unsigned long long ipc_msgs;
+	double lat_us[4];           /* p50, p90, p99, max */
+};
+
+static void help_info(void)
+{
+	printf("\n\n**************************************************\n");
+	printf("* Decoder throughput benchmark for DSP wrapper\n");
+	printf("* Usage: dsp_dec_bench.out [options] codec:file ...\n");
+	printf("* Options :\n\n");
+	printf("          -l Library    Wrapper library (default %s)\n", WRAP_LIB_PATH);
+	printf("          -n Runs       Decodes per file (default %d)\n", BENCH_RUNS);
+	printf("          -j File       Write JSON lines results, - for stdout\n");
+	printf("* Codecs :\n\n          ");
+	for (size_t i = 0; i < NUM_CODECS; i++)
+		printf("%s ", codec_list[i].name);
+	printf("\n**************************************************\n\n");
+}
+
+static void *bench_calloc(UWORD32 num, UWORD32 size)
+{
+	return calloc(num, size);
+}
+
+static void *bench_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void bench_free(void *ptr)
+{
+	free(ptr);
+}
+
+static void *bench_realloc(void *ptr, UWORD32 size)
+{
+	return realloc(ptr, size);
+}
+
+static UniACodecMemoryOps mem_ops = {
+	.Calloc = bench_calloc,
+	.Malloc = bench_malloc,
+	.Free = bench_free,
+	.ReAlloc = bench_realloc,
+};
+
+static double now_s(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static int load_api(const char *path, struct unia_api *api)
+{
+	tUniACodecQueryInterface query;
+	void *lib;
+
+	lib = dlopen(path, RTLD_NOW);
+	if (!lib) {
+		fprintf(stderr, "dlopen %s: %s\n", path, dlerror());
+		return -ENOENT;
+	}
+
+	query = (tUniACodecQueryInterface)dlsym(lib, "UniACodecQueryInterface");
+	if (!query) {
+		fprintf(stderr, "no UniACodecQueryInterface in %s\n", path);
+		return -ENOENT;
+	}
+
+	query(ACODEC_API_CREATE_CODEC_PLUS, (void **)&api->create);
+	query(ACODEC_API_DELETE_CODEC, (void **)&api->delete);
+	query(ACODEC_API_SET_PARAMETER, (void **)&api->set_para);
+	query(ACODEC_API_GET_PARAMETER, (void **)&api->get_para);
+	query(ACODEC_API_DEC_FRAME, (void **)&api->decode);
+
+	if (!api->create || !api->delete || !api->set_para ||
+	    !api->get_para || !api->decode)
+		return -ENOSYS;
+
+	return 0;
+}
+
+static UWORD8 *read_file(const char *path, UWORD32 *size)
+{
+	UWORD8 *data;
+	FILE *fp;
+	long len;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return NULL;
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len > 0 ? len : 1);
+	if (data && fread(data, 1, len, fp) != (size_t)len) {
+		free(data);
+		data = NULL;
+	}
+	fclose(fp);
+
+	*size = len;
+	return data;
+}
+
+/* decode one file from memory, so file I/O is not measured */
+static int bench_file(struct unia_api *api, const struct bench_codec *codec,
+		      UWORD8 *data, UWORD32 size, struct bench_result *res)
+{
+	UniACodec_Handle handle;
+	UniACodecParameter para;
+	UWORD32 offset = 0, last_offset = 0, out_size;
+	unsigned long long ipc_start = 0;
+	UWORD32 channels = 0, bytes = 0, rate = 0, stalls = 0;
+	UWORD32 lat_num = 0, lat_size = 4096;
+	UWORD8 *out;
+	double *lat, wall, cpu, t;
+	int ret;
+
+	memset(res, 0, sizeof(*res));
+
+	handle = api->create(&mem_ops, codec->format);
+	if (!handle)
+		return -ENODEV;
+
+	if (codec->stream_type != STREAM_UNKNOW) {
+		para.stream_type = codec->stream_type;
+		api->set_para(handle, UNIA_STREAM_TYPE, &para);
+	}
+
+	api->get_para(handle, UNIA_OUTBUF_ALLOC_SIZE, &para);
+	out = malloc(para.outbuf_alloc_size);
+	lat = malloc(lat_size * sizeof(*lat));
+	if (!out || !lat) {
+		free(out);
+		free(lat);
+		api->delete(handle);
+		return -ENOMEM;
+	}
+
+	if (!api->get_para(handle, UNIA_IPC_MSG_COUNT, &para))
+		ipc_start = para.ipc_msg_count;
+
+	wall = now_s(CLOCK_MONOTONIC);
+	cpu = now_s(CLOCK_PROCESS_CPUTIME_ID);
+
+	while (stalls < MAX_STALLS) {
+		/* ...NULL input drains the wrapper and signals end of stream */
+		UWORD8 *in = (offset < size) ? data : NULL;
+		UWORD8 *pout = out;
+
+		out_size = 0;
+		t = now_s(CLOCK_MONOTONIC);
+		ret = api->decode(handle, in, size, &offset, &pout, &out_size);
+		t = now_s(CLOCK_MONOTONIC) - t;
+
+		if (lat_num == lat_size) {
+			double *p = realloc(lat, lat_size * 2 * sizeof(*lat));
+
+			if (!p)
+				break;
+			lat = p;
+			lat_size *= 2;
+		}
+		lat[lat_num++] = t * 1e6;
+		res->calls++;
+
+		if (ret == ACODEC_END_OF_STREAM)
+			break;
+		if ((ret & 0xff) && (ret & 0xff) != ACODEC_NO_OUTPUT)
+			res->errors++;
+
+		if (out_size) {
+			if (!channels || (ret & ACODEC_CAPIBILITY_CHANGE)) {
+				api->get_para(handle, UNIA_OUTPUT_PCM_FORMAT, &para);
+				channels = para.outputFormat.channels;
+				bytes = para.outputFormat.depth / 8;
+				rate = para.outputFormat.samplerate;
+			}
+			if (channels && bytes && rate)
+				res->audio_s += (double)out_size / (channels * bytes) / rate;
+			res->frames++;
+		}
+
+		stalls = (out_size || offset != last_offset) ? 0 : stalls + 1;
+		last_offset = offset;
+	}
+
+	res->wall_s = now_s(CLOCK_MONOTONIC) - wall;
+	res->cpu_s = now_s(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+
+	if (!api->get_para(handle, UNIA_IPC_MSG_COUNT, &para))
+		res->ipc_msgs = para.ipc_msg_count - ipc_start;
+
+	if (lat_num) {
+		qsort(lat, lat_num, sizeof(*lat), cmp_double);
+		res->lat_us[0] = lat[lat_num * 50 / 100];
+		res->lat_us[1] = lat[lat_num * 90 / 100];
+		res->lat_us[2] = lat[lat_num * 99 / 100];
+		res->lat_us[3] = lat[lat_num - 1];
+	}
+
+	free(lat);
+	free(out);
+	api->delete(handle);
+
+	return (stalls < MAX_STALLS) ? 0 : -ETIMEDOUT;
+}
+
+static void print_result(FILE *json, const char *codec, const char *path,
+			 int run, int ret, const struct bench_result *res)
+{
+	double fps = res->wall_s > 0 ? res->frames / res->wall_s : 0;
+	double xrt = res->wall_s > 0 ? res->audio_s / res->wall_s : 0;
+	double ipc = res->frames ? (double)res->ipc_msgs / res->frames : 0;
+
+	printf("%-8s %8u %10.1f %8.2f %8.3f %7.2f %9.1f %9.1f %9.1f %9.1f %s%s\n",
+	       codec, res->frames, fps, xrt, res->cpu_s, ipc,
+	       res->lat_us[0], res->lat_us[1], res->lat_us[2], res->lat_us[3],
+	       path, ret ? " (failed)" : "");
+
+	if (!json)
+		return;
+
+	fprintf(json, "{\"codec\":\"%s\",\"file\":\"%s\",\"run\":%d,\"status\":%d,"
+		"\"frames\":%u,\"calls\":%u,\"errors\":%u,\"audio_s\":%.6f,"
+		"\"wall_s\":%.6f,\"cpu_s\":%.6f,\"frames_per_s\":%.2f,"
+		"\"x_realtime\":%.3f,\"ipc_msgs\":%llu,\"ipc_per_frame\":%.3f,"
+		"\"lat_p50_us\":%.1f,\"lat_p90_us\":%.1f,\"lat_p99_us\":%.1f,"
+		"\"lat_max_us\":%.1f}\n",
+		codec, path, run, ret, res->frames, res->calls, res->errors,
+		res->audio_s, res->wall_s, res->cpu_s, fps, xrt, res->ipc_msgs,
+		ipc, res->lat_us[0], res->lat_us[1], res->lat_us[2],
+		res->lat_us[3]);
+	fflush(json);
+}
+
+int main(int argc, char **argv)
+{
+	const char *lib_path = WRAP_LIB_PATH;
+	const char *json_path = NULL;
+	struct unia_api api;
+	struct bench_result res;
+	FILE *json = NULL;
+	int runs = BENCH_RUNS;
+	int i, run, ret, failed = 0;
+	size_t c;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		switch (argv[i][1]) {
+		case 'l':
+			lib_path = argv[i] + 2;
+			break;
+		case 'n':
+			runs = atoi(argv[i] + 2);
+			break;
+		case 'j':
+			json_path = argv[i] + 2;
+			break;
+		default:
+			help_info();
+			return 0;
+		}
+	}
+	if (i == argc) {
+		help_info();
+		return 0;
+	}
+	if (runs <= 0)
+		runs = BENCH_RUNS;
+
+	memset(&api, 0, sizeof(api));
+	ret = load_api(lib_path, &api);
+	if (ret)
+		return ret;
+
+	if (json_path) {
+		json = strcmp(json_path, "-") ? fopen(json_path, "w") : stdout;
+		if (!json) {
+			fprintf(stderr, "can not open %s\n", json_path);
+			return -ENOENT;
+		}
+	}
+
+	printf("%-8s %8s %10s %8s %8s %7s %9s %9s %9s %9s %s\n",
+	       "codec", "frames", "frames/s", "xRT", "cpu(s)", "ipc/fr",
+	       "p50(us)", "p90(us)", "p99(us)", "max(us)", "file");
+
+	for (; i < argc; i++) {
+		char *sep = strchr(argv[i], ':');
+		const char *path;
+		UWORD8 *data;
+		UWORD32 size;
+
+		for (c = 0; sep && c < NUM_CODECS; c++) {
+			if (strlen(codec_list[c].name) == (size_t)(sep - argv[i]) &&
+			    !strncmp(codec_list[c].name, argv[i], sep - argv[i]))
+				break;
+		}
+		if (!sep || c == NUM_CODECS) {
+			fprintf(stderr, "%s: expect codec:file\n", argv[i]);
+			failed++;
+			continue;
+		}
+		path = sep + 1;
+
+		data = read_file(path, &size);
+		if (!data) {
+			fprintf(stderr, "%s: can not read\n", path);
+			failed++;
+			continue;
+		}
+
+		for (run = 0; run < runs; run++) {
+			ret = bench_file(&api, &codec_list[c], data, size, &res);
+			print_result(json, codec_list[c].name, path, run, ret, &res);
+			if (ret)
+				failed++;
+		}
+		free(data);
+	}
+
+	if (json && json != stdout)
+		fclose(json);
+
+	return failed ? -EIO : 0;
+}
@@ -0,0 +1,347 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Library load benchmark: measures the time xaf_load_library() takes per
+ * codec, cold (image cache disabled, library parsed and relocated from the
+ * ELF file) against warm (pre-relocated image mapped from the cache).
+ *
+ * Images are keyed by the identity of the library file (device, inode,
+ * size and modification time), so a warm load never reads the library. They
+ * are not relocated again on reuse, though: an image is only used when
+ * the sections of the new instance are allocated at the same DSP addresses
+ * the image was relocated for. Components are created and deleted one at a
+ * time here so that holds; a warm load whose sections land elsewhere falls
+ * back to the ELF path and shows up as a speedup near 1x.
+ *
+ * Before timing, every codec is loaded into two live components. The
+ * second has to reuse the code section of the first when that was shared,
+ * load its own code when it was not, and always get its own data section,
+ * or the test fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <time.h>
+#include <ctype.h>
+#include <limits.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "xaf-utils-test.h"
+#include "xaf-fio-test.h"
+
+#include "dsp_codec_interface.h"
+#include "library_load.h"
+
+#define AUDIO_FRMWK_BUF_SIZE   (256 << 8)
+#define AUDIO_COMP_BUF_SIZE    (1024 << 7)
+
+#define LIB_LOAD_RUNS           10
+#define LIB_CACHE_DIR           "/tmp/xaf_lib_cache"
+
+extern int audio_frmwk_buf_size;
+extern int audio_comp_buf_size;
+
+struct lib_load_codec {
+	int format;
+	const char *comp_id;
+};
+
+static const struct lib_load_codec codec_list[] = {
+	{ CODEC_MP3_DEC,          "audio-decoder/mp3" },
+	{ CODEC_AAC_DEC,          "audio-decoder/aac" },
+	{ CODEC_DAB_DEC,          "audio-decoder/dabplus" },
+	{ CODEC_MP2_DEC,          "audio-decoder/mp2" },
+	{ CODEC_BSAC_DEC,         "audio-decoder/bsac" },
+	{ CODEC_DRM_DEC,          "audio-decoder/drm" },
+	{ CODEC_SBC_DEC,          "audio-decoder/sbc" },
+	{ CODEC_SBC_ENC,          "audio-encoder/sbc" },
+	{ CODEC_FSL_OGG_DEC,      "audio-decoder/fsl-ogg" },
+	{ CODEC_FSL_MP3_DEC,      "audio-decoder/fsl-mp3" },
+	{ CODEC_FSL_AAC_DEC,      "audio-decoder/fsl-aac" },
+	{ CODEC_FSL_AAC_PLUS_DEC, "audio-decoder/fsl-aacplus" },
+	{ CODEC_FSL_AC3_DEC,      "audio-decoder/fsl-ac3" },
+	{ CODEC_FSL_DDP_DEC,      "audio-decoder/fsl-ddp" },
+	{ CODEC_FSL_NBAMR_DEC,    "audio-decoder/fsl-nbamr" },
+	{ CODEC_FSL_WBAMR_DEC,    "audio-decoder/fsl-wbamr" },
+	{ CODEC_FSL_WMA_DEC,      "audio-decoder/fsl-wma" },
+	{ CODEC_OPUS_DEC,         "audio-decoder/opus" },
+};
+
+#define NUM_CODECS (sizeof(codec_list) / sizeof(codec_list[0]))
+
+void help_info()
+{
+	FIO_PRINTF(stdout, "\n\n**************************************************\n");
+	FIO_PRINTF(stdout, "* Library load benchmark for DSP\n");
+	FIO_PRINTF(stdout, "* Options :\n\n");
+	FIO_PRINTF(stdout, "          -f AudFormat  Audio Format, see dsp_test.out,\n");
+	FIO_PRINTF(stdout, "                        all codecs if not set\n");
+	FIO_PRINTF(stdout, "          -n Runs       Loads per codec and mode (default %d)\n", LIB_LOAD_RUNS);
+	FIO_PRINTF(stdout, "          -d CacheDir   Image cache directory (default %s)\n", LIB_CACHE_DIR);
+	FIO_PRINTF(stdout, "**************************************************\n\n");
+}
+
+void fio_quit()
+{
+	return;
+}
+
+/* cached images are named by their 64-bit key, "<16 hex digits>.img" */
+static bool is_lib_image(const char *name)
+{
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		if (!isxdigit((unsigned char)name[i]))
+			return false;
+	}
+
+	return !strcmp(name + 16, ".img");
+}
+
+/* create the cache directory if needed and drop the images stored in it */
+static int cache_clean(const char *cache_dir)
+{
+	struct dirent *entry;
+	char path[PATH_MAX];
+	DIR *dir;
+
+	if (mkdir(cache_dir, 0755) && errno != EEXIST)
+		return -errno;
+
+	dir = opendir(cache_dir);
+	if (!dir)
+		return -errno;
+
+	while ((entry = readdir(dir)) != NULL) {
+		if (!is_lib_image(entry->d_name))
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+		unlink(path);
+	}
+	closedir(dir);
+
+	return 0;
+}
+
+static double time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+/* create a component, time loading its library, delete it again */
+static int load_once(void *p_adev, const char *comp_id, double *elapsed)
+{
+	void *p_comp = NULL;
+	void *comp_inbuf[2];
+	double start;
+	int ret;
+
+	TST_CHK_API_COMP_CREATE(p_adev, &p_comp, comp_id, 2, 1, &comp_inbuf[0], XAF_DECODER, "xaf_comp_create");
+
+	start = time_us();
+	ret = xaf_load_library(p_adev, p_comp, (xf_id_t)comp_id);
+	*elapsed = time_us() - start;
+
+	TST_CHK_API(xaf_comp_delete(p_comp), "xaf_comp_delete");
+
+	return ret;
+}
+
+#define LIB_CODE_PRIVATE        0
+#define LIB_CODE_SHARED         1
+#define LIB_CODE_WRONG          2
+
+/*
+ * code of a second instance must be the relocated code of the first when
+ * the first published it, data is per instance in any case
+ */
+static int lib_share_mode(struct lib_info *first, struct lib_info *second)
+{
+	bool shared;
+
+	if (!first || !second)
+		return (!first && !second) ? LIB_CODE_PRIVATE : LIB_CODE_WRONG;
+
+	shared = (second->lib_type & CODEC_LIB_SHARED_CODE) &&
+		second->pil_info.dst_addr == first->pil_info.dst_addr;
+	if (second->pil_info.dst_data_addr == first->pil_info.dst_data_addr ||
+	    shared != (first->code_cache != NULL))
+		return LIB_CODE_WRONG;
+
+	return shared ? LIB_CODE_SHARED : LIB_CODE_PRIVATE;
+}
+
+/*
+ * load the library of a codec into two components alive at the same time,
+ * returns the worst LIB_CODE_* of codec and wrapper library, -1 when the
+ * library can not be loaded
+ */
+static int share_check(void *p_adev, const char *comp_id)
+{
+	xaf_comp_t *comp[2];
+	void *p_comp[2] = { NULL, NULL };
+	void *comp_inbuf[2];
+	int i, ret = -1;
+
+	for (i = 0; i < 2; i++) {
+		TST_CHK_API_COMP_CREATE(p_adev, &p_comp[i], comp_id, 2, 1, &comp_inbuf[0], XAF_DECODER, "xaf_comp_create");
+		if (xaf_load_library(p_adev, p_comp[i], (xf_id_t)comp_id) != XAF_NO_ERR)
+			goto out;
+		comp[i] = p_comp[i];
+	}
+
+	ret = lib_share_mode(comp[0]->codec_lib, comp[1]->codec_lib);
+	i = lib_share_mode(comp[0]->codec_wrap_lib, comp[1]->codec_wrap_lib);
+	if (i > ret)
+		ret = i;
+
+out:
+	for (i = 0; i < 2; i++) {
+		if (p_comp[i])
+			TST_CHK_API(xaf_comp_delete(p_comp[i]), "xaf_comp_delete");
+	}
+
+	return ret;
+}
+
+/* average load time over runs, -1 when the library can not be loaded */
+static double load_avg(void *p_adev, const char *comp_id, int runs)
+{
+	double elapsed, total = 0;
+	int i;
+
+	for (i = 0; i < runs; i++) {
+		if (load_once(p_adev, comp_id, &elapsed) != XAF_NO_ERR)
+			return -1;
+		total += elapsed;
+	}
+
+	return total / runs;
+}
+
+/* returns -1 when the second instance did not get the code it should */
+static int bench_codec(void *p_adev, const struct lib_load_codec *codec,
+		       const char *cache_dir, int runs)
+{
+	double cold, warm, elapsed;
+	int shared;
+
+	/* ...cold: image cache disabled */
+	unsetenv("XAF_LIB_CACHE_DIR");
+	shared = share_check(p_adev, codec->comp_id);
+	if (shared < 0) {
+		FIO_PRINTF(stdout, "%-28s not available\n", codec->comp_id);
+		return 0;
+	}
+
+	cold = load_avg(p_adev, codec->comp_id, runs);
+	if (cold < 0)
+		return 0;
+
+	/* ...first load with the cache enabled stores the image */
+	setenv("XAF_LIB_CACHE_DIR", cache_dir, 1);
+	if (load_once(p_adev, codec->comp_id, &elapsed) != XAF_NO_ERR)
+		return 0;
+
+	warm = load_avg(p_adev, codec->comp_id, runs);
+	if (warm < 0)
+		return 0;
+
+	FIO_PRINTF(stdout, "%-28s %10.1f %10.1f %10.1f %8.2fx %8s\n",
+		   codec->comp_id, cold, elapsed, warm, cold / warm,
+		   shared == LIB_CODE_SHARED ? "yes" :
+		   shared == LIB_CODE_PRIVATE ? "private" : "WRONG");
+
+	return shared == LIB_CODE_WRONG ? -1 : 0;
+}
+
+int main_task(int argc, char **argv)
+{
+	void *p_adev = NULL;
+	const char *cache_dir = LIB_CACHE_DIR;
+	int runs = LIB_LOAD_RUNS;
+	int format = 0;
+	int failed = 0;
+	mem_obj_t *mem_handle;
+	xaf_adev_config_t adev_config;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') {
+			help_info();
+			return 0;
+		}
+		switch (argv[i][1]) {
+		case 'f':
+			format = atoi(argv[i] + 2);
+			break;
+		case 'n':
+			runs = atoi(argv[i] + 2);
+			break;
+		case 'd':
+			cache_dir = argv[i] + 2;
+			break;
+		default:
+			help_info();
+			return 0;
+		}
+	}
+	if (runs <= 0)
+		runs = LIB_LOAD_RUNS;
+
+	/* ...start from an empty cache */
+	if (cache_clean(cache_dir)) {
+		FIO_PRINTF(stderr, "cache dir: %s create failed!\n", cache_dir);
+		return -ENOENT;
+	}
+
+	audio_frmwk_buf_size = AUDIO_FRMWK_BUF_SIZE;
+	audio_comp_buf_size = AUDIO_COMP_BUF_SIZE;
+
+	/* ...start xos */
+	start_rtos();
+
+	TST_CHK_API(xaf_adev_config_default_init(&adev_config), "xaf_adev_config_default_init");
+
+	mem_handle = mem_init(&adev_config);
+
+	adev_config.pmem_malloc =  mem_malloc;
+	adev_config.pmem_free =  mem_free;
+	adev_config.audio_framework_buffer_size =  audio_frmwk_buf_size;
+	adev_config.audio_component_buffer_size =  audio_comp_buf_size;
+	TST_CHK_API(xaf_adev_open(&p_adev, &adev_config),  "xaf_adev_open");
+
+	FIO_PRINTF(stdout, "%-28s %10s %10s %10s %9s %8s\n",
+		   "component", "cold(us)", "store(us)", "warm(us)", "speedup",
+		   "shared");
+
+	for (i = 0; i < (int)NUM_CODECS; i++) {
+		if (format && codec_list[i].format != format)
+			continue;
+		if (bench_codec(p_adev, &codec_list[i], cache_dir, runs))
+			failed++;
+	}
+
+	TST_CHK_API(xaf_adev_close(p_adev, XAF_ADEV_NORMAL_CLOSE), "xaf_adev_close");
+
+	mem_exit(mem_handle);
+
+	cache_clean(cache_dir);
+
+	if (failed) {
+		FIO_PRINTF(stderr, "%d codecs shared their sections wrongly\n", failed);
+		return -EIO;
+	}
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+// Copyright 2023 NXP
+// SPDX-License-Identifier: BSD-3-Clause
+
+/*
+ * Multi-stream creation test: opens several decoders at once through the
+ * DSP wrapper library and checks every creation succeeds, also when the
+ * streams outnumber what one shared audio device can hold. With an input
+ * file all decoders then decode it round-robin, so their components are
+ * live on the DSP at the same time.
+ *
+ * Set DSP_WRAP_SHARED_STREAMS to change how many decoders share one audio
+ * device, 0 gives every decoder a private device.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <dlfcn.h>
+
+#include "xa_type_def.h"
+#include "fsl_unia.h"
+
+#ifdef TGT_OS_ANDROID
+#define WRAP_LIB_PATH   "/vendor/lib/lib_dsp_wrap_arm_android.so"
+#else
+#define WRAP_LIB_PATH   "/usr/lib/imx-mm/audio-codec/wrap/lib_dsp_wrap_arm_elinux.so"
+#endif
+
+#define NUM_STREAMS     8
+#define MAX_STREAMS     32
+/* ...decode calls per stream once a file is given */
+#define NUM_CALLS       16
+
+struct unia_api {
+	UniACodecCreatePlus create;
+	UniACodecDelete delete;
+	UniACodecSetParameter set_para;
+	UniACodecGetParameter get_para;
+	UniACodec_decode_frame decode;
+};
+
+struct stream {
+	UniACodec_Handle handle;
+	UWORD8 *out;
+	UWORD32 offset;
+	UWORD32 frames;
+};
+
+static void help_info(void)
+{
+	printf("\n\n**************************************************\n");
+	printf("* Multi-stream decoder creation test for DSP wrapper\n");
+	printf("* Usage: dsp_multi_dec_test.out [options] [AAC file]\n");
+	printf("* Options :\n\n");
+	printf("          -l Library    Wrapper library (default %s)\n", WRAP_LIB_PATH);
+	printf("          -n Streams    Decoders open at once (default %d, max %d)\n",
+	       NUM_STREAMS, MAX_STREAMS);
+	printf("**************************************************\n\n");
+}
+
+static void *test_calloc(UWORD32 num, UWORD32 size)
+{
+	return calloc(num, size);
+}
+
+static void *test_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void test_free(void *ptr)
+{
+	free(ptr);
+}
+
+static void *test_realloc(void *ptr, UWORD32 size)
+{
+	return realloc(ptr, size);
+}
+
+static UniACodecMemoryOps mem_ops = {
+	.Calloc = test_calloc,
+	.Malloc = test_malloc,
+	.Free = test_free,
+	.ReAlloc = test_realloc,
+};
+
+static int load_api(const char *path, struct unia_api *api)
+{
+	tUniACodecQueryInterface query;
+	void *lib;
+
+	lib = dlopen(path, RTLD_NOW);
+	if (!lib) {
+		fprintf(stderr, "dlopen %s: %s\n", path, dlerror());
+		return -ENOENT;
+	}
+
+	query = (tUniACodecQueryInterface)dlsym(lib, "UniACodecQueryInterface");
+	if (!query) {
+		fprintf(stderr, "no UniACodecQueryInterface in %s\n", path);
+		return -ENOENT;
+	}
+
+	query(ACODEC_API_CREATE_CODEC_PLUS, (void **)&api->create);
+	query(ACODEC_API_DELETE_CODEC, (void **)&api->delete);
+	query(ACODEC_API_SET_PARAMETER, (void **)&api->set_para);
+	query(ACODEC_API_GET_PARAMETER, (void **)&api->get_para);
+	query(ACODEC_API_DEC_FRAME, (void **)&api->decode);
+
+	if (!api->create || !api->delete || !api->set_para ||
+	    !api->get_para || !api->decode)
+		return -ENOSYS;
+
+	return 0;
+}
+
+static UWORD8 *read_file(const char *path, UWORD32 *size)
+{
+	UWORD8 *data;
+	FILE *fp;
+	long len;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return NULL;
+
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	data = malloc(len > 0 ? len : 1);
+	if (data && fread(data, 1, len, fp) != (size_t)len) {
+		free(data);
+		data = NULL;
+	}
+	fclose(fp);
+
+	*size = len;
+	return data;
+}
+
+static int open_stream(struct unia_api *api, struct stream *s)
+{
+	UniACodecParameter para;
+
+	s->handle = api->create(&mem_ops, AAC);
+	if (!s->handle)
+		return -ENODEV;
+
+	para.stream_type = STREAM_ADTS;
+	api->set_para(s->handle, UNIA_STREAM_TYPE, &para);
+
+	api->get_para(s->handle, UNIA_OUTBUF_ALLOC_SIZE, &para);
+	s->out = malloc(para.outbuf_alloc_size);
+	if (!s->out)
+		return -ENOMEM;
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *lib_path = WRAP_LIB_PATH;
+	struct stream streams[MAX_STREAMS];
+	struct unia_api api;
+	UWORD8 *data = NULL;
+	UWORD32 size = 0, out_size;
+	int num = NUM_STREAMS;
+	int i, k, ret, failed = 0;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		switch (argv[i][1]) {
+		case 'l':
+			lib_path = argv[i] + 2;
+			break;
+		case 'n':
+			num = atoi(argv[i] + 2);
+			break;
+		default:
+			help_info();
+			return 0;
+		}
+	}
+	if (num <= 0 || num > MAX_STREAMS) {
+		help_info();
+		return -EINVAL;
+	}
+
+	if (i < argc) {
+		data = read_file(argv[i], &size);
+		if (!data) {
+			fprintf(stderr, "%s: can not read\n", argv[i]);
+			return -ENOENT;
+		}
+	}
+
+	memset(&api, 0, sizeof(api));
+	ret = load_api(lib_path, &api);
+	if (ret)
+		return ret;
+
+	memset(streams, 0, sizeof(streams));
+
+	/* ...all decoders exist at once, the later ones must not fail */
+	for (i = 0; i < num; i++) {
+		ret = open_stream(&api, &streams[i]);
+		if (ret) {
+			fprintf(stderr, "stream %d: create failed (%d)\n", i, ret);
+			failed++;
+		}
+	}
+
+	for (k = 0; data && k < NUM_CALLS; k++) {
+		for (i = 0; i < num; i++) {
+			struct stream *s = &streams[i];
+			UWORD8 *pout = s->out;
+
+			if (!s->handle || !s->out || s->offset >= size)
+				continue;
+
+			out_size = 0;
+			api.decode(s->handle, data, size, &s->offset, &pout, &out_size);
+			if (out_size)
+				s->frames++;
+		}
+	}
+
+	for (i = 0; i < num; i++) {
+		if (data && streams[i].handle && !streams[i].frames) {
+			fprintf(stderr, "stream %d: no output\n", i);
+			failed++;
+		}
+		if (streams[i].handle)
+			api.delete(streams[i].handle);
+		free(streams[i].out);
+	}
+	free(data);
+
+	printf("%d streams, %d failed\n", num, failed);
+
+	return failed ? -EIO : 0;
+}